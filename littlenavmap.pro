@@ -224,6 +224,7 @@ message(-----------------------------------)
 
 SOURCES += \
   src/airspace/airspacecontroller.cpp \
+  src/airspace/airspaceindex.cpp \
   src/airspace/airspacetoolbarhandler.cpp \
   src/common/aircrafttrack.cpp \
   src/common/airportfiles.cpp \
@@ -244,6 +245,7 @@ SOURCES += \
   src/common/maptypesfactory.cpp \
   src/common/proctypes.cpp \
   src/common/settingsmigrate.cpp \
+  src/common/startuptrace.cpp \
   src/common/symbolpainter.cpp \
   src/common/tabindexes.cpp \
   src/common/textplacement.cpp \
@@ -253,8 +255,12 @@ SOURCES += \
   src/common/vehicleicons.cpp \
   src/connect/connectclient.cpp \
   src/connect/connectdialog.cpp \
+  src/connect/simdatadelta.cpp \
+  src/connect/simdatarecorder.cpp \
+  src/connect/simdatareplay.cpp \
   src/db/databasedialog.cpp \
   src/db/databasemanager.cpp \
+  src/db/databasepool.cpp \
   src/db/databaseprogressdialog.cpp \
   src/db/dbtypes.cpp \
   src/export/csvexporter.cpp \
@@ -275,6 +281,7 @@ SOURCES += \
   src/logbook/logdatadialog.cpp \
   src/logbook/logstatisticsdialog.cpp \
   src/main.cpp \
+  src/mapgui/airportdiagramcache.cpp \
   src/mapgui/aprongeometrycache.cpp \
   src/mapgui/imageexportdialog.cpp \
   src/mapgui/mapcontextmenu.cpp \
@@ -306,6 +313,7 @@ SOURCES += \
   src/mappainter/mappainterwind.cpp \
   src/mappainter/mappaintlayer.cpp \
   src/navapp.cpp \
+  src/online/onlineaircraftindex.cpp \
   src/online/onlinedatacontroller.cpp \
   src/options/optiondata.cpp \
   src/options/optionsdialog.cpp \
@@ -314,6 +322,7 @@ SOURCES += \
   src/perf/perfmergedialog.cpp \
   src/print/printdialog.cpp \
   src/print/printsupport.cpp \
+  src/profile/elevationpyramid.cpp \
   src/profile/profilelabelwidget.cpp \
   src/profile/profilescrollarea.cpp \
   src/profile/profilewidget.cpp \
@@ -323,8 +332,11 @@ SOURCES += \
   src/query/airwaytrackquery.cpp \
   src/query/infoquery.cpp \
   src/query/mapquery.cpp \
+  src/query/nearestindex.cpp \
   src/query/procedurequery.cpp \
+  src/query/procedurevalidation.cpp \
   src/query/querytypes.cpp \
+  src/query/runwayindex.cpp \
   src/query/waypointquery.cpp \
   src/query/waypointtrackquery.cpp \
   src/route/customproceduredialog.cpp \
@@ -378,6 +390,7 @@ SOURCES += \
   src/weather/weatherreporter.cpp \
   src/weather/windreporter.cpp \
   src/web/requesthandler.cpp \
+  src/web/webapicache.cpp \
   src/web/webapp.cpp \
   src/web/webcontroller.cpp \
   src/web/webflags.cpp \
@@ -386,6 +399,7 @@ SOURCES += \
 
 HEADERS  += \
   src/airspace/airspacecontroller.h \
+  src/airspace/airspaceindex.h \
   src/airspace/airspacetoolbarhandler.h \
   src/common/aircrafttrack.h \
   src/common/airportfiles.h \
@@ -406,6 +420,7 @@ HEADERS  += \
   src/common/maptypesfactory.h \
   src/common/proctypes.h \
   src/common/settingsmigrate.h \
+  src/common/startuptrace.h \
   src/common/symbolpainter.h \
   src/common/tabindexes.h \
   src/common/textplacement.h \
@@ -415,8 +430,12 @@ HEADERS  += \
   src/common/vehicleicons.h \
   src/connect/connectclient.h \
   src/connect/connectdialog.h \
+  src/connect/simdatadelta.h \
+  src/connect/simdatarecorder.h \
+  src/connect/simdatareplay.h \
   src/db/databasedialog.h \
   src/db/databasemanager.h \
+  src/db/databasepool.h \
   src/db/databaseprogressdialog.h \
   src/db/dbtypes.h \
   src/export/csvexporter.h \
@@ -436,6 +455,7 @@ HEADERS  += \
   src/logbook/logdataconverter.h \
   src/logbook/logdatadialog.h \
   src/logbook/logstatisticsdialog.h \
+  src/mapgui/airportdiagramcache.h \
   src/mapgui/aprongeometrycache.h \
   src/mapgui/imageexportdialog.h \
   src/mapgui/mapcontextmenu.h \
@@ -467,6 +487,7 @@ HEADERS  += \
   src/mappainter/mappainterwind.h \
   src/mappainter/mappaintlayer.h \
   src/navapp.h \
+  src/online/onlineaircraftindex.h \
   src/online/onlinedatacontroller.h \
   src/options/optiondata.h \
   src/options/optionsdialog.h \
@@ -475,6 +496,7 @@ HEADERS  += \
   src/perf/perfmergedialog.h \
   src/print/printdialog.h \
   src/print/printsupport.h \
+  src/profile/elevationpyramid.h \
   src/profile/profilelabelwidget.h \
   src/profile/profilescrollarea.h \
   src/profile/profilewidget.h \
@@ -484,8 +506,11 @@ HEADERS  += \
   src/query/airwaytrackquery.h \
   src/query/infoquery.h \
   src/query/mapquery.h \
+  src/query/nearestindex.h \
   src/query/procedurequery.h \
+  src/query/procedurevalidation.h \
   src/query/querytypes.h \
+  src/query/runwayindex.h \
   src/query/waypointquery.h \
   src/query/waypointtrackquery.h \
   src/route/customproceduredialog.h \
@@ -539,6 +564,7 @@ HEADERS  += \
   src/weather/weatherreporter.h \
   src/weather/windreporter.h \
   src/web/requesthandler.h \
+  src/web/webapicache.h \
   src/web/webapp.h \
   src/web/webcontroller.h \
   src/web/webflags.h \
@@ -22,6 +22,7 @@
 #include "geo/linestring.h"
 #include "common/constants.h"
 #include "db/databasemanager.h"
+#include "db/databasepool.h"
 #include "airspace/airspacetoolbarhandler.h"
 #include "navapp.h"
 #include "ui_mainwindow.h"
@@ -30,17 +31,207 @@
 #include "gui/mainwindow.h"
 #include "options/optionsdialog.h"
 #include "fs/userdata/airspacereaderopenair.h"
+#include "fs/navdatabase.h"
+#include "fs/navdatabaseoptions.h"
 #include "sql/sqltransaction.h"
 #include "gui/textdialog.h"
 #include "util/htmlbuilder.h"
 #include "fs/common/metadatawriter.h"
 #include "exception.h"
 #include "gui/errorhandler.h"
+#include "fs/sc/simconnectdata.h"
+#include "settings/settings.h"
+
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
 
 #include <QAction>
 #include <QDir>
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFutureWatcher>
 #include <QProgressDialog>
+#include <QSet>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+
+// Number of random positions for the containment benchmark
+static const int AIRSPACE_BENCHMARK_POSITIONS = 20000;
+
+// Maximum number of temporary databases attached while importing
+static const int MAX_AIRSPACE_IMPORT_THREADS = 8;
+
+// Number of airspace entry and exit events kept for the information window
+static const int MAX_AIRSPACE_EVENTS = 20;
+
+/* Size and modification time of an OpenAir file as stored in the database after import */
+struct AirspaceFileFingerprint
+{
+  AirspaceFileFingerprint()
+  {
+  }
+
+  explicit AirspaceFileFingerprint(const QFileInfo& fileInfo)
+    : filepath(fileInfo.absoluteFilePath()), size(fileInfo.size()),
+    modified(fileInfo.lastModified().toMSecsSinceEpoch())
+  {
+  }
+
+  QString filepath;
+  qint64 size = 0, modified = 0;
+  int fileId = -1;
+};
+
+/* Files read by one worker thread into its own temporary database */
+struct AirspaceImportBatch
+{
+  QString schemaName() const
+  {
+    return QString("airspaceimport%1").arg(index);
+  }
+
+  int index = 0;
+  QString basePath, databaseFile;
+  QVector<AirspaceFileFingerprint> files;
+
+  /* Results */
+  int numRead = 0;
+  QStringList errors;
+  QString exceptionMessage;
+
+  /* Shared between all threads */
+  std::atomic_int *filesDone = nullptr;
+  std::atomic_bool *canceled = nullptr;
+};
+
+/* Called in worker thread. Reads all files of the batch into a new temporary database using an own connection. */
+static void readAirspaceBatchThread(AirspaceImportBatch& batch)
+{
+  const QString connectionName = "LNMDBAIRSPACEIMPORT" + QString::number(batch.index);
+
+  try
+  {
+    atools::sql::SqlDatabase::addDatabase("QSQLITE", connectionName);
+
+    // Need empty block to delete db before removing driver
+    {
+      atools::sql::SqlDatabase db(connectionName);
+      db.setDatabaseName(batch.databaseFile);
+      db.open();
+
+      // Create schema directly instead of using the database manager which shows an error dialog
+      // Exceptions are passed to the batch and reported in the GUI thread
+      atools::fs::NavDatabaseOptions opts;
+      atools::fs::NavDatabase(&opts, &db, nullptr, GIT_REVISION).createAirspaceSchema();
+
+      atools::sql::SqlTransaction transaction(&db);
+      atools::fs::userdata::AirspaceReaderOpenAir reader(&db);
+      for(const AirspaceFileFingerprint& file : batch.files)
+      {
+        if(batch.canceled->load())
+          break;
+
+        // Read OpenAir file =============================================================
+        reader.readFile(file.fileId, file.filepath);
+        batch.numRead += reader.getNumAirspacesRead();
+
+        for(const atools::fs::userdata::AirspaceReaderOpenAir::AirspaceErr& err : reader.getErrors())
+          batch.errors.append(QObject::tr("File \"%1\" line %2: %3").
+                              arg(QDir(batch.basePath).relativeFilePath(err.file)).arg(err.line).arg(err.message));
+
+        (*batch.filesDone)++;
+      }
+      transaction.commit();
+      db.close();
+    }
+    atools::sql::SqlDatabase::removeDatabase(connectionName);
+  }
+  catch(atools::Exception& e)
+  {
+    batch.exceptionMessage = e.what();
+  }
+  catch(...)
+  {
+    batch.exceptionMessage = QObject::tr("Unknown error reading airspaces.");
+  }
+}
+
+/* Called in worker thread. Builds a containment index using a separate connection from the pool. */
+static AirspaceIndex buildAirspaceIndexThread(const QString& filename, const QString& queryStr,
+                                              map::MapAirspaceSources source, bool hasFirUir)
+{
+  AirspaceIndex index;
+  DatabasePool *pool = NavApp::getDatabaseManager()->getDatabasePool();
+  try
+  {
+    AirspaceQuery::fillAirspaceIndex(index, pool->getQuery(filename, queryStr), source, hasFirUir);
+    index.build();
+  }
+  catch(atools::Exception& e)
+  {
+    // Not fatal - containment is not available for this source
+    qWarning() << Q_FUNC_INFO << "Error building airspace index" << e.what();
+    index.clear();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Unknown error building airspace index";
+    index.clear();
+  }
+
+  // Close connection of this thread to release the file
+  pool->release();
+  return index;
+}
+
+/* Get fingerprints of the last import. Returns empty hash if the import has to be done from scratch,
+ * i.e. missing table or a different base path. */
+static QHash<QString, AirspaceFileFingerprint> readAirspaceFingerprints(atools::sql::SqlDatabase *db,
+                                                                       const QString& basePath)
+{
+  QHash<QString, AirspaceFileFingerprint> fingerprints;
+  atools::sql::SqlUtil util(db);
+  if(!util.hasTable("airspace_file_fingerprint") || !util.hasTable("bgl_file") || !util.hasTable("boundary"))
+    return fingerprints;
+
+  QString base = QFileInfo(basePath).absoluteFilePath();
+
+  // Join with file table to detect a schema which was recreated elsewhere
+  atools::sql::SqlQuery query(db);
+  query.exec("select f.bgl_file_id, f.filepath, f.size, f.modified from airspace_file_fingerprint f "
+             "join bgl_file b on f.bgl_file_id = b.bgl_file_id");
+  while(query.next())
+  {
+    AirspaceFileFingerprint fingerprint;
+    fingerprint.fileId = query.valueInt("bgl_file_id");
+    fingerprint.filepath = query.valueStr("filepath");
+    fingerprint.size = query.value("size").toLongLong();
+    fingerprint.modified = query.value("modified").toLongLong();
+
+    if(!fingerprint.filepath.startsWith(base))
+      // Base path has changed - read all
+      return QHash<QString, AirspaceFileFingerprint>();
+
+    fingerprints.insert(fingerprint.filepath, fingerprint);
+  }
+  return fingerprints;
+}
+
+static void createAirspaceFingerprintTable(atools::sql::SqlDatabase *db)
+{
+  atools::sql::SqlQuery(db).exec("drop table if exists airspace_file_fingerprint");
+  atools::sql::SqlQuery(db).exec("create table airspace_file_fingerprint ("
+                                 "bgl_file_id integer primary key, "
+                                 "filepath varchar(1000) not null, "
+                                 "size integer not null, "
+                                 "modified integer not null)");
+}
 
 AirspaceController::AirspaceController(MainWindow *mainWindowParam,
                                        atools::sql::SqlDatabase *dbSim, atools::sql::SqlDatabase *dbNav,
@@ -60,6 +251,19 @@ AirspaceController::AirspaceController(MainWindow *mainWindowParam,
   for(AirspaceQuery *q:queries.values())
     q->initQueries();
 
+  airspaceDebug = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_AIRSPACE_DEBUG,
+                                                                          false).toBool();
+  airspaceBenchmark = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_AIRSPACE_BENCHMARK,
+                                                                              false).toBool();
+
+  for(map::MapAirspaceSources src : queries.keys())
+  {
+    AirspaceIndexBuild *build = new AirspaceIndexBuild;
+    connect(&build->watcher, &QFutureWatcher<AirspaceIndex>::finished,
+            this, std::bind(&AirspaceController::airspaceIndexFinished, this, src));
+    indexBuilds.insert(src, build);
+  }
+
   // Button and action handler =================================
   qDebug() << Q_FUNC_INFO << "Creating InfoController";
   airspaceHandler = new AirspaceToolBarHandler(NavApp::getMainWindow());
@@ -78,6 +282,11 @@ AirspaceController::AirspaceController(MainWindow *mainWindowParam,
 
 AirspaceController::~AirspaceController()
 {
+  for(AirspaceIndexBuild *build : indexBuilds.values())
+    build->watcher.waitForFinished();
+  qDeleteAll(indexBuilds);
+  indexBuilds.clear();
+
   qDebug() << Q_FUNC_INFO << "delete airspaceHandler";
   delete airspaceHandler;
 
@@ -255,8 +464,16 @@ void AirspaceController::preDatabaseLoad()
   // preDatabaseLoadAirspaces and postDatabaseLoadAirspaces
   if(!loadingUserAirspaces)
   {
+    discardAirspaceIndexes(map::AIRSPACE_SRC_ALL);
+
     for(AirspaceQuery *q:queries.values())
       q->deInitQueries();
+
+    airspaceIndexes.clear();
+    invalidateAirspaceIndexes(map::AIRSPACE_SRC_ALL);
+
+    // Do not report exits for the removed indexes on the next update
+    containmentSources = map::AIRSPACE_SRC_NONE;
   }
 }
 
@@ -275,6 +492,7 @@ void AirspaceController::onlineClientAndAtcUpdated()
 {
   if(queries.contains(map::AIRSPACE_SRC_ONLINE))
     queries.value(map::AIRSPACE_SRC_ONLINE)->clearCache();
+  invalidateAirspaceIndexes(map::AIRSPACE_SRC_ONLINE);
 }
 
 void AirspaceController::resetAirspaceOnlineScreenGeometry()
@@ -284,6 +502,7 @@ void AirspaceController::resetAirspaceOnlineScreenGeometry()
     queries.value(map::AIRSPACE_SRC_ONLINE)->deInitQueries();
     queries.value(map::AIRSPACE_SRC_ONLINE)->initQueries();
   }
+  invalidateAirspaceIndexes(map::AIRSPACE_SRC_ONLINE);
 }
 
 void AirspaceController::resetSettingsToDefault()
@@ -337,83 +556,225 @@ void AirspaceController::loadAirspaces()
     // Disable queries to avoid locked database
     preLoadAirpaces();
 
+    QElapsedTimer timer;
+    timer.start();
+
     bool success = false;
-    int sceneryId = 1, fileId = 1, numRead = 0, numFiles = 0;
+    int sceneryId = 1, numRead = 0, numFiles = 0, numUnchanged = 0, numRemoved = 0, numTotal = 0;
     QStringList errors;
+    atools::sql::SqlDatabase *dbUserAirspace = NavApp::getDatabaseUserAirspace();
+
+    // Temporary databases for each worker thread - removed with the directory
+    QTemporaryDir tempDir;
+    QVector<AirspaceImportBatch> batches;
+    int numAttached = 0;
 
     try
     {
-      // Get database and drop and create schema =======================================
-      atools::sql::SqlDatabase *dbUserAirspace = NavApp::getDatabaseUserAirspace();
-
-      // Use a manual transaction
-      atools::sql::SqlTransaction transaction(dbUserAirspace);
-
-      NavApp::getDatabaseManager()->createEmptySchema(dbUserAirspace, true /* boundary */);
-
-      // Write scenery area for display in information window =====================
-      atools::fs::common::MetadataWriter metadataWriter(*dbUserAirspace);
-      metadataWriter.writeSceneryArea(basePath, "User Airspaces", sceneryId);
-
       // Prepare filters and flags for folder search ========================
       QStringList filter = OptionData::instance().getCacheUserAirspaceExtensions().simplified().split(" ");
       QDir::Filters filterFlags = QDir::Files | QDir::Hidden | QDir::System;
       QDirIterator::IteratorFlags iterFlags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
 
-      // Count files for progress =================================================
-      QDirIterator countDirIter(basePath, filter, filterFlags, iterFlags);
-      while(countDirIter.hasNext())
+      // Collect files and fingerprints in one pass =================================================
+      QVector<AirspaceFileFingerprint> files;
+      QDirIterator dirIter(basePath, filter, filterFlags, iterFlags);
+      while(dirIter.hasNext())
       {
-        countDirIter.next();
-        numFiles++;
+        dirIter.next();
+        files.append(AirspaceFileFingerprint(dirIter.fileInfo()));
+      }
+      numFiles = files.size();
+
+      // Compare with fingerprints of last import and find files to read =============================
+      QHash<QString, AirspaceFileFingerprint> previous = readAirspaceFingerprints(dbUserAirspace, basePath);
+      QSet<QString> currentPaths, changedPaths;
+      QVector<AirspaceFileFingerprint> changedFiles;
+      for(const AirspaceFileFingerprint& file : files)
+      {
+        currentPaths.insert(file.filepath);
+        AirspaceFileFingerprint prev = previous.value(file.filepath);
+        if(prev.fileId == -1 || prev.size != file.size || prev.modified != file.modified)
+        {
+          changedFiles.append(file);
+          changedPaths.insert(file.filepath);
+        }
+        else
+          numUnchanged++;
+      }
+
+      // Removed or changed files have to be deleted from the database
+      QVector<int> deleteFileIds;
+      int nextFileId = 1;
+      for(const AirspaceFileFingerprint& prev : previous)
+      {
+        if(!currentPaths.contains(prev.filepath))
+        {
+          deleteFileIds.append(prev.fileId);
+          numRemoved++;
+        }
+        else if(changedPaths.contains(prev.filepath))
+          deleteFileIds.append(prev.fileId);
+        nextFileId = std::max(nextFileId, prev.fileId + 1);
+      }
+
+      qDebug() << Q_FUNC_INFO << "files" << numFiles << "changed" << changedFiles.size()
+               << "unchanged" << numUnchanged << "removed" << numRemoved;
+
+      // Assign new file ids and distribute over worker batches ======================================
+      // Larger files first for better balancing
+      std::sort(changedFiles.begin(), changedFiles.end(),
+                [](const AirspaceFileFingerprint& f1, const AirspaceFileFingerprint& f2) -> bool {
+        return f1.size > f2.size;
+      });
+
+      int numBatches = std::max(1, std::min(std::min(QThread::idealThreadCount(), MAX_AIRSPACE_IMPORT_THREADS),
+                                            changedFiles.size()));
+      std::atomic_int filesDone(0);
+      std::atomic_bool canceled(false);
+      for(int i = 0; i < numBatches && !changedFiles.isEmpty(); i++)
+      {
+        AirspaceImportBatch batch;
+        batch.index = i;
+        batch.basePath = basePath;
+        batch.databaseFile = tempDir.filePath(QString("airspace_import_%1.sqlite").arg(i));
+        batch.filesDone = &filesDone;
+        batch.canceled = &canceled;
+        batches.append(batch);
+      }
+
+      for(int i = 0; i < changedFiles.size(); i++)
+      {
+        changedFiles[i].fileId = nextFileId++;
+        batches[i % batches.size()].files.append(changedFiles.at(i));
       }
 
       // Set up progress dialog ==================================================
-      QProgressDialog progress(tr("Reading airspaces ..."), tr("&Cancel"), 0, numFiles, mainWindow);
+      QProgressDialog progress(tr("Reading airspaces ..."), tr("&Cancel"), 0, changedFiles.size(), mainWindow);
       progress.setWindowModality(Qt::WindowModal);
       progress.setMinimumDuration(0);
       progress.show();
 
-      // Read files ==================================================
-      atools::fs::userdata::AirspaceReaderOpenAir writer(dbUserAirspace);
-      int fileProgress = 0;
-      bool canceled = false;
-      QDirIterator dirIter(basePath, filter, filterFlags, iterFlags);
-      while(dirIter.hasNext())
+      // Parse files into temporary databases in parallel while keeping dialog responsive ==============
+      if(!batches.isEmpty())
       {
-        QString file = dirIter.next();
-        qDebug() << Q_FUNC_INFO << file;
+        if(!tempDir.isValid())
+          throw atools::Exception(tr("Cannot create temporary directory for airspace import: %1").
+                                  arg(tempDir.errorString()));
+
+        // Run a local event loop until all batches are done and update progress periodically
+        QEventLoop loop;
+        QFutureWatcher<void> watcher;
+        connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+        connect(&progress, &QProgressDialog::canceled, &loop, [&canceled]() {
+          canceled = true;
+        });
 
-        // Write file metadata for display in information window
-        metadataWriter.writeFile(file, QString(), sceneryId, fileId);
+        QTimer progressTimer;
+        connect(&progressTimer, &QTimer::timeout, &loop, [&progress, &filesDone]() {
+          progress.setValue(filesDone.load());
+        });
+        progressTimer.start(100);
 
-        // Read OpenAir file =============================================================
-        writer.readFile(fileId, file);
-        numRead += writer.getNumAirspacesRead();
+        watcher.setFuture(QtConcurrent::map(batches, readAirspaceBatchThread));
+        if(!watcher.isFinished())
+          loop.exec();
 
-        progress.setValue(fileProgress++);
+        progressTimer.stop();
+        watcher.waitForFinished();
+      }
+      progress.setValue(changedFiles.size());
+
+      // Check for exceptions in threads
+      for(const AirspaceImportBatch& batch : batches)
+      {
+        if(!batch.exceptionMessage.isEmpty())
+          throw atools::Exception(batch.exceptionMessage);
+      }
 
-        if(progress.wasCanceled())
+      if(!canceled)
+      {
+        // Attach temporary databases - not allowed within a transaction ============================
+        for(const AirspaceImportBatch& batch : batches)
         {
-          canceled = true;
-          break;
+          QString path = batch.databaseFile;
+          atools::sql::SqlQuery(dbUserAirspace).exec("attach database '" + path.replace("'", "''") + "' as " +
+                                                     batch.schemaName());
+          numAttached++;
         }
 
-        for(const atools::fs::userdata::AirspaceReaderOpenAir::AirspaceErr& err : writer.getErrors())
-          errors.append(tr("File \"%1\" line %2: %3").
-                        arg(QDir(basePath).relativeFilePath(err.file)).arg(err.line).arg(err.message));
+        // Write all in one manual transaction ==============================================
+        atools::sql::SqlTransaction transaction(dbUserAirspace);
+        atools::fs::common::MetadataWriter metadataWriter(*dbUserAirspace);
 
-        fileId++;
-      }
-      progress.setValue(numFiles);
+        if(previous.isEmpty())
+        {
+          // First import or other base path - drop and create schema =======================================
+          NavApp::getDatabaseManager()->createEmptySchema(dbUserAirspace, true /* boundary */);
+          createAirspaceFingerprintTable(dbUserAirspace);
+
+          // Write scenery area for display in information window
+          metadataWriter.writeSceneryArea(basePath, "User Airspaces", sceneryId);
+        }
+        else
+        {
+          // Remove airspaces of changed and removed files =======================================
+          atools::sql::SqlQuery deleteBoundary(dbUserAirspace);
+          atools::sql::SqlQuery deleteFile(dbUserAirspace);
+          atools::sql::SqlQuery deleteFingerprint(dbUserAirspace);
+          deleteBoundary.prepare("delete from boundary where file_id = :id");
+          deleteFile.prepare("delete from bgl_file where bgl_file_id = :id");
+          deleteFingerprint.prepare("delete from airspace_file_fingerprint where bgl_file_id = :id");
+          for(int id : deleteFileIds)
+          {
+            deleteBoundary.bindValue(":id", id);
+            deleteBoundary.exec();
+            deleteFile.bindValue(":id", id);
+            deleteFile.exec();
+            deleteFingerprint.bindValue(":id", id);
+            deleteFingerprint.exec();
+          }
+        }
+
+        // Copy airspaces from all batches with a single writer =======================================
+        atools::sql::SqlQuery insertFingerprint(dbUserAirspace);
+        insertFingerprint.prepare("insert into airspace_file_fingerprint (bgl_file_id, filepath, size, modified) "
+                                  "values(:id, :filepath, :size, :modified)");
+
+        for(const AirspaceImportBatch& batch : batches)
+        {
+          // Move ids behind existing airspaces
+          atools::sql::SqlQuery maxQuery(dbUserAirspace);
+          maxQuery.exec("select max(boundary_id) from boundary");
+          int maxId = maxQuery.next() ? maxQuery.value(0).toInt() : 0;
+
+          atools::sql::SqlQuery(dbUserAirspace).exec("update " + batch.schemaName() + ".boundary set boundary_id = "
+                                                     "boundary_id + " + QString::number(maxId));
+          atools::sql::SqlQuery(dbUserAirspace).exec("insert into boundary select * from " + batch.schemaName() +
+                                                     ".boundary");
+
+          for(const AirspaceFileFingerprint& file : batch.files)
+          {
+            // Write file metadata for display in information window
+            metadataWriter.writeFile(file.filepath, QString(), sceneryId, file.fileId);
+
+            insertFingerprint.bindValue(":id", file.fileId);
+            insertFingerprint.bindValue(":filepath", file.filepath);
+            insertFingerprint.bindValue(":size", file.size);
+            insertFingerprint.bindValue(":modified", file.modified);
+            insertFingerprint.exec();
+          }
+
+          numRead += batch.numRead;
+          errors.append(batch.errors);
+        }
 
-      if(canceled)
-        // User bailed out - restore previous state
-        transaction.rollback();
-      else
-      {
         transaction.commit();
         success = true;
+
+        atools::sql::SqlQuery countQuery(dbUserAirspace);
+        countQuery.exec("select count(1) from boundary");
+        numTotal = countQuery.next() ? countQuery.value(0).toInt() : 0;
       }
     }
     catch(atools::Exception& e)
@@ -425,11 +786,30 @@ void AirspaceController::loadAirspaces()
       atools::gui::ErrorHandler(mainWindow).handleUnknownException();
     }
 
+    // Detach temporary databases again
+    for(int i = 0; i < numAttached; i++)
+    {
+      try
+      {
+        atools::sql::SqlQuery(dbUserAirspace).exec("detach database " + batches.at(i).schemaName());
+      }
+      catch(atools::Exception& e)
+      {
+        qWarning() << Q_FUNC_INFO << e.what();
+      }
+    }
+
+    qDebug() << Q_FUNC_INFO << "import took" << timer.elapsed() << "ms";
+
     // Show messages only if no exception and not canceled by user
     if(success)
     {
-      QString message = tr("Loaded %1 airspaces from %2 files from base path\n"
-                           "\"%3\".").arg(numRead).arg(numFiles).arg(basePath);
+      QString message = tr("Loaded %1 airspaces from %2 changed files from base path\n"
+                           "\"%3\".\n"
+                           "%4 unchanged files were skipped and %5 removed files were deleted.\n"
+                           "%6 user airspaces are available.").
+                        arg(numRead).arg(numFiles - numUnchanged).arg(basePath).
+                        arg(numUnchanged).arg(numRemoved).arg(numTotal);
 
       if(!errors.isEmpty())
       {
@@ -497,6 +877,11 @@ void AirspaceController::preLoadAirpaces()
   if(queries.contains(map::AIRSPACE_SRC_USER))
     queries.value(map::AIRSPACE_SRC_USER)->deInitQueries();
 
+  // Index is outdated after loading - skip user airspaces in containment until rebuilt
+  discardAirspaceIndexes(map::AIRSPACE_SRC_USER);
+  airspaceIndexes.remove(map::AIRSPACE_SRC_USER);
+  containmentSources = map::AIRSPACE_SRC_NONE;
+
   emit preDatabaseLoadAirspaces();
 }
 
@@ -505,6 +890,7 @@ void AirspaceController::postLoadAirpaces()
   if(queries.contains(map::AIRSPACE_SRC_USER))
     queries.value(map::AIRSPACE_SRC_USER)->initQueries();
   loadingUserAirspaces = false;
+  invalidateAirspaceIndexes(map::AIRSPACE_SRC_USER);
 
   emit postDatabaseLoadAirspaces(NavApp::getCurrentSimulatorDb());
 }
@@ -520,3 +906,206 @@ QStringList AirspaceController::getAirspaceSourcesStr() const
 
   return retval;
 }
+
+void AirspaceController::invalidateAirspaceIndexes(map::MapAirspaceSources src)
+{
+  dirtyAirspaceIndexes |= src;
+}
+
+void AirspaceController::updateAirspaceIndexes()
+{
+  for(map::MapAirspaceSources src : map::MAP_AIRSPACE_SRC_VALUES)
+  {
+    if((sources & src) && (dirtyAirspaceIndexes & src) && queries.contains(src))
+    {
+      // Avoid blocking the GUI thread - index is added or replaced when done
+      startAirspaceIndex(src);
+      dirtyAirspaceIndexes &= ~src;
+    }
+  }
+}
+
+void AirspaceController::startAirspaceIndex(map::MapAirspaceSources src)
+{
+  AirspaceIndexBuild *build = indexBuilds.value(src);
+  if(build->watcher.isRunning())
+  {
+    // Build again with the latest data when done
+    build->pending = true;
+    return;
+  }
+
+  AirspaceQuery *query = queries.value(src);
+  if(query == nullptr || query->getAirspaceIndexQueryStr().isEmpty())
+    return;
+
+  build->pending = build->discard = false;
+  build->timer.start();
+  build->watcher.setFuture(QtConcurrent::run(buildAirspaceIndexThread, query->getDatabaseFilename(),
+                                             query->getAirspaceIndexQueryStr(), src, query->hasFirUirAirspaces()));
+}
+
+void AirspaceController::airspaceIndexFinished(map::MapAirspaceSources src)
+{
+  AirspaceIndexBuild *build = indexBuilds.value(src);
+  if(build->discard)
+  {
+    build->discard = false;
+    return;
+  }
+
+  const AirspaceIndex& index = airspaceIndexes[src] = build->watcher.result();
+
+  if(airspaceDebug)
+    qDebug() << Q_FUNC_INFO << map::airspaceSourceText(src) << "airspaces" << index.size()
+             << "edges" << index.getNumEdges() << "built in" << build->timer.elapsed() << "ms";
+
+  if(airspaceBenchmark)
+    index.benchmark(AIRSPACE_BENCHMARK_POSITIONS);
+
+  // Do not report entries and exits caused by the new index on the next update
+  containmentSources = map::AIRSPACE_SRC_NONE;
+
+  if(build->pending)
+    startAirspaceIndex(src);
+}
+
+void AirspaceController::discardAirspaceIndexes(map::MapAirspaceSources src)
+{
+  // Worker uses its own connection which has to be closed before the database is changed
+  for(map::MapAirspaceSources buildSrc : indexBuilds.keys())
+  {
+    if(buildSrc & src)
+    {
+      AirspaceIndexBuild *build = indexBuilds.value(buildSrc);
+      if(build->watcher.isRunning())
+      {
+        build->discard = true;
+        build->watcher.waitForFinished();
+      }
+      build->pending = false;
+    }
+  }
+}
+
+void AirspaceController::getContainingAirspaces(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const
+{
+  for(map::MapAirspaceSources src : map::MAP_AIRSPACE_SRC_VALUES)
+  {
+    if((sources & src) && airspaceIndexes.contains(src))
+      airspaceIndexes[src].getContainingAirspaces(ids, pos);
+  }
+}
+
+void AirspaceController::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
+{
+  // Avoid queries on the user database while loading
+  if(loadingUserAirspaces)
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  updateAirspaceIndexes();
+
+  // Do not report entries and exits on the first update or if the indexes or the selected sources have changed
+  bool suppressEvents = containmentSources != sources;
+  containmentSources = sources;
+
+  // User aircraft ============================================================
+  const atools::fs::sc::SimConnectUserAircraft& userAircraft = simulatorData.getUserAircraftConst();
+  QVector<map::MapAirspaceId> ids;
+  if(userAircraft.getPosition().isValid())
+    getContainingAirspaces(ids, userAircraft.getPosition());
+
+  QSet<map::MapAirspaceId> idSet = ids.toList().toSet();
+  if(idSet != userAirspaceIds)
+  {
+    QDateTime now = userAircraft.getZuluTime();
+
+    if(!suppressEvents)
+    {
+      // Left airspaces ===============
+      for(const map::MapAirspace& airspace : userAirspaces)
+      {
+        if(!idSet.contains(airspace.combinedId()))
+          userAirspaceEvents.prepend({now, false, airspace});
+      }
+    }
+
+    QVector<map::MapAirspace> airspaces;
+    for(const map::MapAirspaceId& id : ids)
+    {
+      map::MapAirspace airspace = getAirspaceById(id);
+      if(!airspace.isValid())
+        continue;
+
+      // Entered airspaces ===============
+      if(!suppressEvents && !userAirspaceIds.contains(id))
+        userAirspaceEvents.prepend({now, true, airspace});
+      airspaces.append(airspace);
+    }
+
+    // Sort by importance like on the map
+    std::sort(airspaces.begin(), airspaces.end(),
+              [](const map::MapAirspace& airspace1, const map::MapAirspace& airspace2) -> bool
+    {
+      return map::airspaceDrawingOrder(airspace1.type) > map::airspaceDrawingOrder(airspace2.type);
+    });
+
+    userAirspaces = airspaces;
+    userAirspaceIds = idSet;
+
+    if(userAirspaceEvents.size() > MAX_AIRSPACE_EVENTS)
+      userAirspaceEvents.resize(MAX_AIRSPACE_EVENTS);
+  }
+
+  // AI aircraft ============================================================
+  const QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = simulatorData.getAiAircraftConst();
+  QHash<int, QVector<map::MapAirspaceId> > aiIds;
+  aiIds.reserve(aiAircraft.size());
+  for(const atools::fs::sc::SimConnectAircraft& aircraft : aiAircraft)
+  {
+    QVector<map::MapAirspaceId>& aircraftIds = aiIds[aircraft.getObjectId()];
+    getContainingAirspaces(aircraftIds, aircraft.getPosition());
+  }
+  // Replace to drop aircraft which are gone
+  aiAirspaceIds.swap(aiIds);
+
+  if(airspaceDebug)
+  {
+    qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    int numPositions = aiAircraft.size() + 1;
+    qDebug() << Q_FUNC_INFO << "positions" << numPositions << "in" << elapsedUs << "us"
+             << "positions/s" << (elapsedUs > 0 ? numPositions * 1000000L / elapsedUs : 0L)
+             << "user airspaces" << userAirspaces.size();
+  }
+}
+
+void AirspaceController::disconnectedFromSimulator()
+{
+  clearContainment();
+}
+
+void AirspaceController::clearContainment()
+{
+  userAirspaceIds.clear();
+  userAirspaces.clear();
+  userAirspaceEvents.clear();
+  aiAirspaceIds.clear();
+
+  // Suppress events on next update
+  containmentSources = map::AIRSPACE_SRC_NONE;
+}
+
+QVector<map::MapAirspace> AirspaceController::getAiAircraftAirspaces(int objectId)
+{
+  QVector<map::MapAirspace> airspaces;
+  for(const map::MapAirspaceId& id : aiAirspaceIds.value(objectId))
+  {
+    map::MapAirspace airspace = getAirspaceById(id);
+    if(airspace.isValid())
+      airspaces.append(airspace);
+  }
+  return airspaces;
+}
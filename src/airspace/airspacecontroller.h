@@ -18,9 +18,13 @@
 #ifndef LNM_AIRSPACECONTROLLER_H
 #define LNM_AIRSPACECONTROLLER_H
 
+#include "airspace/airspaceindex.h"
 #include "common/maptypes.h"
 #include "fs/fspaths.h"
 
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QObject>
 
 namespace atools {
@@ -28,6 +32,11 @@ namespace sql {
 class SqlDatabase;
 class SqlRecord;
 }
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
 }
 
 namespace Marble {
@@ -42,9 +51,19 @@ class MainWindow;
 typedef  QHash<map::MapAirspaceSources, AirspaceQuery *> AirspaceQueryMapType;
 typedef  QVector<const map::MapAirspace *> AirspaceVector;
 
+/* User aircraft entered or left an airspace */
+struct AirspaceContainmentEvent
+{
+  QDateTime time;
+  bool entered;
+  map::MapAirspace airspace;
+};
+
 /*
  * Wraps the airspace queries for nav, sim, user and online airspaces.
  * Provides a method to import user airspaces recursively from a folder.
+ *
+ * Keeps a containment index for each airspace source and tracks the airspaces around the user and AI aircraft.
  */
 class AirspaceController
   : public QObject
@@ -120,6 +139,27 @@ public:
 
   void resetSettingsToDefault();
 
+  /* Update airspace containment for user and AI aircraft. Starts index builds of enabled sources on demand. */
+  void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
+
+  /* Clears airspace containment and entry/exit events */
+  void disconnectedFromSimulator();
+
+  /* Airspaces containing the user aircraft from the last simulator update */
+  const QVector<map::MapAirspace>& getUserAircraftAirspaces() const
+  {
+    return userAirspaces;
+  }
+
+  /* Recent airspace entries and exits of the user aircraft. Latest first. */
+  const QVector<AirspaceContainmentEvent>& getUserAircraftAirspaceEvents() const
+  {
+    return userAirspaceEvents;
+  }
+
+  /* Airspaces containing the AI aircraft with the given object id from the last simulator update */
+  QVector<map::MapAirspace> getAiAircraftAirspaces(int objectId);
+
 signals:
   /* Filter in drop down buttons have changed */
   void updateAirspaceTypes(map::MapAirspaceFilter types);
@@ -147,11 +187,57 @@ private:
   void preLoadAirpaces();
   void postLoadAirpaces();
 
+  /* Start index builds for enabled sources which are marked dirty */
+  void updateAirspaceIndexes();
+
+  /* Get ids of airspaces containing the position in all enabled sources */
+  void getContainingAirspaces(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const;
+
+  /* Mark indexes as dirty to rebuild them on next simulator update */
+  void invalidateAirspaceIndexes(map::MapAirspaceSources src);
+
+  /* Indexes are built in a worker thread using a separate connection and replace the old ones when done.
+   * Containment skips a source until its index is available. */
+  void startAirspaceIndex(map::MapAirspaceSources src);
+  void airspaceIndexFinished(map::MapAirspaceSources src);
+
+  /* Wait for running builds of the given sources and drop their results. Needed before the database is changed. */
+  void discardAirspaceIndexes(map::MapAirspaceSources src);
+
+  void clearContainment();
+
   AirspaceQueryMapType queries;
   map::MapAirspaceSources sources = map::AIRSPACE_SRC_NONE;
   AirspaceToolBarHandler *airspaceHandler = nullptr;
   MainWindow *mainWindow;
   bool loadingUserAirspaces = false;
+
+  /* Containment index for each source and sources which need a rebuild */
+  QHash<map::MapAirspaceSources, AirspaceIndex> airspaceIndexes;
+  map::MapAirspaceSources dirtyAirspaceIndexes = map::AIRSPACE_SRC_ALL;
+
+  /* Worker state for building the index of one source */
+  struct AirspaceIndexBuild
+  {
+    QFutureWatcher<AirspaceIndex> watcher;
+    QElapsedTimer timer;
+    bool pending = false /* Data changed while building - start again when done */,
+         discard = false /* Database was closed while building - drop result */;
+  };
+
+  QHash<map::MapAirspaceSources, AirspaceIndexBuild *> indexBuilds;
+
+  /* Sources used for the last containment update. Events are suppressed if these change. */
+  map::MapAirspaceSources containmentSources = map::AIRSPACE_SRC_NONE;
+
+  QSet<map::MapAirspaceId> userAirspaceIds;
+  QVector<map::MapAirspace> userAirspaces;
+  QVector<AirspaceContainmentEvent> userAirspaceEvents;
+
+  /* Airspaces containing AI aircraft by object id */
+  QHash<int, QVector<map::MapAirspaceId> > aiAirspaceIds;
+
+  bool airspaceDebug = false, airspaceBenchmark = false;
 };
 
 #endif // LNM_AIRSPACECONTROLLER_H
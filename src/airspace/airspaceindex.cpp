@@ -0,0 +1,286 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "airspace/airspaceindex.h"
+
+#include "common/maptypes.h"
+#include "geo/linestring.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+// Number of one degree buckets
+static const int GRID_WIDTH = 360;
+static const int GRID_HEIGHT = 180;
+
+// Edges per latitude band used to calculate the number of bands and the maximum
+static const int EDGES_PER_BAND = 8;
+static const int MAX_BANDS = 128;
+
+AirspaceIndex::AirspaceIndex()
+{
+}
+
+void AirspaceIndex::clear()
+{
+  polygons.clear();
+  grid.clear();
+}
+
+int AirspaceIndex::getNumEdges() const
+{
+  int num = 0;
+  for(const Polygon& polygon : polygons)
+    num += polygon.points.size();
+  return num;
+}
+
+void AirspaceIndex::add(const map::MapAirspace& airspace, const atools::geo::LineString& geometry)
+{
+  if(geometry.size() < 3)
+    return;
+
+  Polygon polygon;
+  polygon.id = airspace.combinedId();
+  polygon.minAltitude = airspace.minAltitude;
+  polygon.maxAltitude = airspace.maxAltitude;
+
+  // Check if geometry crosses the anti-meridian by looking for large longitude jumps
+  polygon.shifted = false;
+  for(int i = 0; i < geometry.size(); i++)
+  {
+    const atools::geo::Pos& p1 = geometry.at(i);
+    const atools::geo::Pos& p2 = geometry.at((i + 1) % geometry.size());
+    if(std::abs(p1.getLonX() - p2.getLonX()) > 180.f)
+    {
+      polygon.shifted = true;
+      break;
+    }
+  }
+
+  // Copy points and calculate bounding rectangle ============================
+  polygon.west = polygon.south = std::numeric_limits<float>::max();
+  polygon.east = polygon.north = std::numeric_limits<float>::lowest();
+  polygon.points.reserve(geometry.size());
+  for(const atools::geo::Pos& pos : geometry)
+  {
+    float lonx = pos.getLonX();
+    if(polygon.shifted && lonx < 0.f)
+      lonx += 360.f;
+
+    polygon.points.append(QPointF(lonx, pos.getLatY()));
+    polygon.west = std::min(polygon.west, lonx);
+    polygon.east = std::max(polygon.east, lonx);
+    polygon.south = std::min(polygon.south, pos.getLatY());
+    polygon.north = std::max(polygon.north, pos.getLatY());
+  }
+
+  // Sort edges into latitude bands ============================
+  int numBands = std::max(1, std::min(polygon.points.size() / EDGES_PER_BAND, MAX_BANDS));
+  polygon.bandHeight = std::max((polygon.north - polygon.south) / numBands, 0.000001f);
+  polygon.bands.resize(numBands);
+
+  for(int i = 0; i < polygon.points.size(); i++)
+  {
+    const QPointF& p1 = polygon.points.at(i);
+    const QPointF& p2 = polygon.points.at((i + 1) % polygon.points.size());
+    float minLat = static_cast<float>(std::min(p1.y(), p2.y()));
+    float maxLat = static_cast<float>(std::max(p1.y(), p2.y()));
+
+    int first = std::max(0, static_cast<int>((minLat - polygon.south) / polygon.bandHeight));
+    int last = std::min(numBands - 1, static_cast<int>((maxLat - polygon.south) / polygon.bandHeight));
+    for(int band = first; band <= last; band++)
+      polygon.bands[band].append(i);
+  }
+
+  polygons.append(polygon);
+}
+
+void AirspaceIndex::build()
+{
+  grid.clear();
+  grid.resize(GRID_WIDTH * GRID_HEIGHT);
+
+  for(int i = 0; i < polygons.size(); i++)
+  {
+    const Polygon& polygon = polygons.at(i);
+    int west = static_cast<int>(std::floor(polygon.west)), east = static_cast<int>(std::floor(polygon.east));
+    int south = static_cast<int>(std::floor(polygon.south)), north = static_cast<int>(std::floor(polygon.north));
+
+    // Limit to one full round for very large airspaces
+    east = std::min(east, west + GRID_WIDTH - 1);
+
+    for(int laty = south; laty <= north; laty++)
+    {
+      for(int lonx = west; lonx <= east; lonx++)
+        grid[gridIndex(lonx, laty)].append(i);
+    }
+  }
+}
+
+int AirspaceIndex::gridIndex(int lonx, int laty)
+{
+  // Wrap longitude for shifted polygons and clamp latitude at the poles
+  int x = ((lonx + 180) % GRID_WIDTH + GRID_WIDTH) % GRID_WIDTH;
+  int y = std::max(0, std::min(laty + 90, GRID_HEIGHT - 1));
+  return y * GRID_WIDTH + x;
+}
+
+void AirspaceIndex::getContainingAirspaces(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const
+{
+  if(grid.isEmpty() || !pos.isValid())
+    return;
+
+  float lonx = pos.getLonX(), laty = pos.getLatY(), alt = pos.getAltitude();
+  const QVector<int>& bucket =
+    grid.at(gridIndex(static_cast<int>(std::floor(lonx)), static_cast<int>(std::floor(laty))));
+
+  for(int index : bucket)
+  {
+    const Polygon& polygon = polygons.at(index);
+
+    if(alt < polygon.minAltitude || alt > polygon.maxAltitude)
+      continue;
+
+    // Use shifted longitude for airspaces crossing the anti-meridian
+    float x = polygon.shifted && lonx < 0.f ? lonx + 360.f : lonx;
+
+    if(x < polygon.west || x > polygon.east || laty < polygon.south || laty > polygon.north)
+      continue;
+
+    if(containsPoint(polygon, x, laty))
+      ids.append(polygon.id);
+  }
+}
+
+bool AirspaceIndex::containsPoint(const Polygon& polygon, float lonx, float laty)
+{
+  int band = std::max(0, std::min(static_cast<int>((laty - polygon.south) / polygon.bandHeight),
+                                  polygon.bands.size() - 1));
+
+  // Count crossings of a ray to the east
+  bool inside = false;
+  const QVector<QPointF>& points = polygon.points;
+  for(int i : polygon.bands.at(band))
+  {
+    const QPointF& p1 = points.at(i);
+    const QPointF& p2 = points.at((i + 1) % points.size());
+
+    if((p1.y() > laty) != (p2.y() > laty) &&
+       lonx < (p2.x() - p1.x()) * (laty - p1.y()) / (p2.y() - p1.y()) + p1.x())
+      inside = !inside;
+  }
+  return inside;
+}
+
+void AirspaceIndex::getContainingAirspacesLinear(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const
+{
+  if(!pos.isValid())
+    return;
+
+  float lonx = pos.getLonX(), laty = pos.getLatY(), alt = pos.getAltitude();
+  for(const Polygon& polygon : polygons)
+  {
+    if(alt < polygon.minAltitude || alt > polygon.maxAltitude)
+      continue;
+
+    float x = polygon.shifted && lonx < 0.f ? lonx + 360.f : lonx;
+
+    // Count crossings of a ray to the east using all edges
+    bool inside = false;
+    const QVector<QPointF>& points = polygon.points;
+    for(int i = 0; i < points.size(); i++)
+    {
+      const QPointF& p1 = points.at(i);
+      const QPointF& p2 = points.at((i + 1) % points.size());
+
+      if((p1.y() > laty) != (p2.y() > laty) &&
+         x < (p2.x() - p1.x()) * (laty - p1.y()) / (p2.y() - p1.y()) + p1.x())
+        inside = !inside;
+    }
+
+    if(inside)
+      ids.append(polygon.id);
+  }
+}
+
+void AirspaceIndex::benchmark(int numPositions) const
+{
+  if(polygons.isEmpty())
+    return;
+
+  // Half of the positions in random airspaces and half evenly spread - fixed seed for comparable results
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> random(0.f, 1.f);
+  QVector<atools::geo::Pos> positions;
+  positions.reserve(numPositions);
+  for(int i = 0; i < numPositions; i++)
+  {
+    float alt = random(generator) * 40000.f;
+    if(i % 2 == 0)
+    {
+      const Polygon& polygon = polygons.at(static_cast<int>(random(generator) * (polygons.size() - 1)));
+      float lonx = polygon.west + random(generator) * (polygon.east - polygon.west);
+      if(lonx > 180.f)
+        lonx -= 360.f;
+      positions.append(atools::geo::Pos(lonx, polygon.south + random(generator) * (polygon.north - polygon.south),
+                                        alt));
+    }
+    else
+      positions.append(atools::geo::Pos(random(generator) * 360.f - 180.f, random(generator) * 170.f - 85.f, alt));
+  }
+
+  // Linear search as used before the index ===========================
+  QVector<QVector<map::MapAirspaceId> > linearIds(positions.size());
+  QElapsedTimer timer;
+  timer.start();
+  for(int i = 0; i < positions.size(); i++)
+    getContainingAirspacesLinear(linearIds[i], positions.at(i));
+  qint64 linearNs = std::max(timer.nsecsElapsed(), 1LL);
+
+  // Index ===========================
+  QVector<QVector<map::MapAirspaceId> > indexIds(positions.size());
+  timer.start();
+  for(int i = 0; i < positions.size(); i++)
+    getContainingAirspaces(indexIds[i], positions.at(i));
+  qint64 indexNs = std::max(timer.nsecsElapsed(), 1LL);
+
+  // Compare results ignoring order - all ids have the same source ===========================
+  auto lessThan = [](const map::MapAirspaceId& id1, const map::MapAirspaceId& id2) -> bool {
+                    return id1.id < id2.id;
+                  };
+  int numDifferent = 0;
+  for(int i = 0; i < positions.size(); i++)
+  {
+    std::sort(linearIds[i].begin(), linearIds[i].end(), lessThan);
+    std::sort(indexIds[i].begin(), indexIds[i].end(), lessThan);
+    if(linearIds[i] != indexIds[i])
+      numDifferent++;
+  }
+
+  qInfo().noquote().nospace() << Q_FUNC_INFO << " airspaces " << polygons.size() << ", edges " << getNumEdges()
+                              << ", positions " << positions.size()
+                              << ": linear " << positions.size() * 1000000000LL / linearNs << " positions/s"
+                              << ", index " << positions.size() * 1000000000LL / indexNs << " positions/s"
+                              << ", speedup " << QString::number(static_cast<double>(linearNs) / indexNs, 'f', 1)
+                              << ", different results " << numDifferent;
+}
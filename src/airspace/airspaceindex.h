@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACEINDEX_H
+#define LNM_AIRSPACEINDEX_H
+
+#include "common/mapflags.h"
+
+#include <QPointF>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class LineString;
+class Pos;
+}
+}
+
+namespace map {
+struct MapAirspace;
+}
+
+/*
+ * Point in polygon index for fast airspace containment tests of aircraft positions.
+ *
+ * All airspaces are kept in a global grid of one degree buckets which contains the airspaces whose bounding
+ * rectangle overlaps a bucket. Each airspace keeps its edges sorted into latitude bands so that the
+ * crossing number test only has to check the edges in the band of the position.
+ *
+ * Coordinates are used as plain longitude/latitude. Airspaces crossing the anti-meridian are shifted to
+ * the east. Altitudes are in feet and checked against the minimum and maximum airspace altitude.
+ */
+class AirspaceIndex
+{
+public:
+  AirspaceIndex();
+
+  /* Add an airspace and its geometry. Call build() after adding all. */
+  void add(const map::MapAirspace& airspace, const atools::geo::LineString& geometry);
+
+  /* Fill global bucket grid after adding all airspaces */
+  void build();
+
+  void clear();
+
+  /* Get ids of all airspaces containing the position. Altitude of pos is used in feet. */
+  void getContainingAirspaces(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const;
+
+  /* Reference implementation testing all edges of all polygons without grid and bands.
+   * Used to verify the index and to measure the speedup. */
+  void getContainingAirspacesLinear(QVector<map::MapAirspaceId>& ids, const atools::geo::Pos& pos) const;
+
+  /* Test random positions with the index and the linear search, compare results and
+   * print the number of positions per second for both to the log */
+  void benchmark(int numPositions) const;
+
+  bool isEmpty() const
+  {
+    return polygons.isEmpty();
+  }
+
+  int size() const
+  {
+    return polygons.size();
+  }
+
+  /* Total number of edges in all polygons */
+  int getNumEdges() const;
+
+private:
+  struct Polygon
+  {
+    map::MapAirspaceId id;
+    int minAltitude, maxAltitude;
+
+    /* Bounding rectangle. East can be larger than 180 if shifted */
+    float west, east, north, south;
+
+    /* true if longitudes west of the anti-meridian were shifted by 360 degrees */
+    bool shifted;
+
+    /* Closed ring of coordinates as x = longitude and y = latitude */
+    QVector<QPointF> points;
+
+    /* Index of the first point of each edge in each latitude band */
+    float bandHeight;
+    QVector<QVector<int> > bands;
+  };
+
+  /* Crossing number test using only edges in the latitude band of the point */
+  static bool containsPoint(const Polygon& polygon, float lonx, float laty);
+
+  /* Grid index for one degree bucket */
+  static int gridIndex(int lonx, int laty);
+
+  QVector<Polygon> polygons;
+
+  /* One degree buckets from -180,-90 to 180,90 containing indexes into polygons */
+  QVector<QVector<int> > grid;
+};
+
+#endif // LNM_AIRSPACEINDEX_H
@@ -273,6 +273,24 @@ const QLatin1Literal OPTIONS_TRACK_DEBUG("Options/TrackDebug");
 const QLatin1Literal OPTIONS_WEATHER_LEVELS("Options/WeatherLevels");
 const QLatin1Literal OPTIONS_WIND_DEBUG("Options/WindDebug");
 const QLatin1Literal OPTIONS_WEBSERVER_DEBUG("Options/WebserverDebug");
+const QLatin1Literal OPTIONS_STARTUP_TRACE("Options/StartupTrace");
+const QLatin1Literal OPTIONS_DATABASE_WARMUP_MB("Options/DatabaseWarmupMb");
+const QLatin1Literal OPTIONS_MAP_PAINT_DEBUG("Options/MapPaintDebug");
+const QLatin1Literal OPTIONS_MAP_PARALLEL_PAINT("Options/MapParallelPaint");
+const QLatin1Literal OPTIONS_AIRSPACE_DEBUG("Options/AirspaceDebug");
+const QLatin1Literal OPTIONS_AIRSPACE_BENCHMARK("Options/AirspaceBenchmark");
+const QLatin1Literal OPTIONS_NEAREST_DEBUG("Options/NearestDebug");
+const QLatin1Literal OPTIONS_SIMDATA_RECORD_FILE("Options/SimDataRecordFile");
+const QLatin1Literal OPTIONS_SIMDATA_REPLAY_FILE("Options/SimDataReplayFile");
+const QLatin1Literal OPTIONS_SIMDATA_REPLAY_SPEED("Options/SimDataReplaySpeed");
+const QLatin1Literal OPTIONS_SIMDATA_REPLAY_BENCHMARK("Options/SimDataReplayBenchmark");
+const QLatin1Literal OPTIONS_AIRCRAFT_EXTRAPOLATION_MS("Options/AircraftExtrapolationUpdateMs");
+const QLatin1Literal OPTIONS_SIMDATA_DELTA_PROTOCOL("Options/SimDataDeltaProtocol");
+const QLatin1Literal OPTIONS_SIMDATA_DELTA_COMPRESSION("Options/SimDataDeltaCompression");
+const QLatin1Literal OPTIONS_SIMDATA_DELTA_BENCHMARK("Options/SimDataDeltaBenchmark");
+const QLatin1Literal OPTIONS_MAP_SYMBOL_SPRITES("Options/MapSymbolSprites");
+const QLatin1Literal OPTIONS_MAP_SYMBOL_SPRITES_DEBUG("Options/MapSymbolSpritesDebug");
+const QLatin1Literal OPTIONS_PROCEDURE_VALIDATION("Options/ProcedureValidation");
 const QLatin1Literal OPTIONS_VERSION("Options/Version");
 const QLatin1Literal OPTIONS_NO_USER_AGENT("Options/NoUserAgent");
 const QLatin1Literal OPTIONS_WEATHER_UPDATE("Options/WeatherUpdate");
@@ -47,6 +47,17 @@ public:
   CoordinateConverter(const Marble::ViewportParams *viewportParams);
   virtual ~CoordinateConverter();
 
+  /* Use another viewport for all conversions. Used to give painters in worker threads a private copy. */
+  void setViewport(const Marble::ViewportParams *viewportParams)
+  {
+    viewport = viewportParams;
+  }
+
+  const Marble::ViewportParams *getViewport() const
+  {
+    return viewport;
+  }
+
   /* Default size (100x100) for the screen object. Needed to find the repeating pattern for the
    *  Mercator projection. */
   const static QSize DEFAULT_WTOS_SIZE;
@@ -58,6 +58,7 @@
 
 #include <QSize>
 #include <QFileInfo>
+#include <QRegularExpression>
 
 using namespace map;
 using atools::sql::SqlRecord;
@@ -97,6 +98,9 @@ const int WEATHER_MAX_AGE_HOURS = 6;
 // Maximum distance for bearing display
 const int MAX_DISTANCE_FOR_BEARING_METER = ageo::nmToMeter(500);
 
+// Marker in HTML comment which is replaced by bearing and distance to user aircraft
+const static QLatin1String BEARING_PLACEHOLDER("lnm-bearing");
+
 HtmlInfoBuilder::HtmlInfoBuilder(QWidget *parent, bool formatInfo, bool formatPrint)
   : parentWidget(parent), info(formatInfo), print(formatPrint)
 {
@@ -2523,6 +2527,34 @@ void HtmlInfoBuilder::distanceToRouteText(const ageo::Pos& pos, HtmlBuilder& htm
 }
 
 void HtmlInfoBuilder::bearingToUserText(const ageo::Pos& pos, float magVar, HtmlBuilder& html) const
+{
+  if(bearingPlaceholders)
+    // Keep position and declination in the comment to allow filling in values later
+    html.textHtml(QString("<!--%1 %2 %3 %4-->").arg(BEARING_PLACEHOLDER).
+                  arg(pos.getLonX(), 0, 'f', 6).arg(pos.getLatY(), 0, 'f', 6).arg(magVar, 0, 'f', 2));
+  else
+    bearingToUserRow(pos, magVar, html);
+}
+
+void HtmlInfoBuilder::replaceBearingPlaceholders(QString& html) const
+{
+  static const QRegularExpression PLACEHOLDER_REGEXP(QString("<!--%1 ([-0-9.]+) ([-0-9.]+) ([-0-9.]+)-->").
+                                                     arg(BEARING_PLACEHOLDER));
+
+  QRegularExpressionMatch match = PLACEHOLDER_REGEXP.match(html);
+  while(match.hasMatch())
+  {
+    HtmlBuilder row(false);
+    bearingToUserRow(ageo::Pos(match.captured(1).toFloat(), match.captured(2).toFloat()),
+                     match.captured(3).toFloat(), row);
+
+    QString rowText = row.getHtml();
+    html.replace(match.capturedStart(), match.capturedLength(), rowText);
+    match = PLACEHOLDER_REGEXP.match(html, match.capturedStart() + rowText.size());
+  }
+}
+
+void HtmlInfoBuilder::bearingToUserRow(const ageo::Pos& pos, float magVar, HtmlBuilder& html) const
 {
   if(NavApp::isConnectedAndAircraft())
   {
@@ -3923,6 +3955,33 @@ void HtmlInfoBuilder::aircraftProgressText(const atools::fs::sc::SimConnectAircr
 
   if(!less && longDisplay)
   {
+    // Airspaces containing the aircraft ============================
+    AirspaceController *airspaceController = NavApp::getAirspaceController();
+    QVector<map::MapAirspace> airspaces = userAircaft != nullptr ?
+                                          airspaceController->getUserAircraftAirspaces() :
+                                          airspaceController->getAiAircraftAirspaces(aircraft.getObjectId());
+    const QVector<AirspaceContainmentEvent> emptyEvents;
+    const QVector<AirspaceContainmentEvent>& events = userAircaft != nullptr ?
+                                                      airspaceController->getUserAircraftAirspaceEvents() :
+                                                      emptyEvents;
+
+    if(!airspaces.isEmpty() || !events.isEmpty())
+    {
+      head(html, tr("Airspaces"));
+      html.table();
+      for(const map::MapAirspace& airspace : airspaces)
+        html.row2(map::airspaceTypeToString(airspace.type) + tr(":"), map::airspaceName(airspace));
+
+      // Show only the latest entries and exits
+      for(int i = 0; i < std::min(events.size(), 5); i++)
+      {
+        const AirspaceContainmentEvent& event = events.at(i);
+        html.row2(locale.toString(event.time.time(), QLocale::ShortFormat) + tr(":"),
+                  (event.entered ? tr("Entered ") : tr("Left ")) + map::airspaceName(event.airspace));
+      }
+      html.tableEnd();
+    }
+
     head(html, tr("Position"));
     addCoordinates(aircraft.getPosition(), html);
     html.tableEnd();
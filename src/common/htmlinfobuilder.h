@@ -293,6 +293,17 @@ public:
     symbolSizeTitle = value;
   }
 
+  /* Write a placeholder instead of the bearing and distance to the user aircraft. This allows to cache
+   * the generated HTML. Use replaceBearingPlaceholders() to fill in the current values. */
+  void setBearingPlaceholders(bool value)
+  {
+    bearingPlaceholders = value;
+  }
+
+  /* Replace all placeholders with the current bearing and distance to the user aircraft.
+   * Placeholders are removed if not connected. */
+  void replaceBearingPlaceholders(QString& html) const;
+
 private:
   void head(atools::util::HtmlBuilder& html, const QString& text) const;
 
@@ -316,6 +327,7 @@ private:
 
   /* Bearing to simulator aircraft if connected */
   void bearingToUserText(const atools::geo::Pos& pos, float magVar, atools::util::HtmlBuilder& html) const;
+  void bearingToUserRow(const atools::geo::Pos& pos, float magVar, atools::util::HtmlBuilder& html) const;
 
   /* Distance to last flight plan waypoint */
   void distanceToRouteText(const atools::geo::Pos& pos, atools::util::HtmlBuilder& html) const;
@@ -411,7 +423,7 @@ private:
   AirportQuery *airportQuerySim, *airportQueryNav;
   InfoQuery *infoQuery;
   atools::fs::util::MorseCode *morse;
-  bool info, print;
+  bool info, print, bearingPlaceholders = false;
   QLocale locale;
 
 };
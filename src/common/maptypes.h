@@ -646,6 +646,7 @@ struct MapUserpoint
   }
 
   QString name, ident, region, type, description, tags;
+  float visibleFrom = 0.f; /* Point is shown if the view distance is below this value */
   bool temp = false;
 };
 
@@ -848,6 +849,15 @@ struct MapAirway
 
 };
 
+/* Consecutive segments of an airway or track with the same name, fragment and type merged into one line.
+ * Used for painting and screen index to avoid handling each segment separately. */
+struct MapAirwayLine
+{
+  QVector<int> indexes; /* Indexes into the list of airway segments in order of sequence number */
+  atools::geo::LineString line; /* From position of first segment and to positions of all segments */
+  atools::geo::Rect bounding;
+};
+
 // =====================================================================
 /* Marker beacon */
 /* database id marker.marker_id */
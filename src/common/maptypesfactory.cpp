@@ -334,6 +334,8 @@ void MapTypesFactory::fillUserdataPoint(const SqlRecord& rec, map::MapUserpoint&
     obj.description = rec.valueStr("description");
     obj.tags = rec.valueStr("tags");
     obj.temp = rec.valueBool("temp", false);
+    if(rec.contains("visible_from"))
+      obj.visibleFrom = rec.valueFloat("visible_from");
     obj.position = atools::geo::Pos(rec.valueFloat("lonx"), rec.valueFloat("laty"));
   }
 }
@@ -0,0 +1,162 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/startuptrace.h"
+
+#include "common/constants.h"
+#include "settings/settings.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+namespace startuptrace {
+
+struct Entry
+{
+  QString name;
+  qint64 beginMs = -1, endMs = -1;
+  int depth = 0;
+  bool background = false;
+};
+
+static QMutex mutex;
+static QElapsedTimer timer;
+static QVector<Entry> entries;
+static int mainDepth = 0;
+static bool running = false;
+static qint64 finishMs = -1;
+
+static bool isMainThread()
+{
+  return QCoreApplication::instance() == nullptr ||
+         QThread::currentThread() == QCoreApplication::instance()->thread();
+}
+
+void start()
+{
+  QMutexLocker locker(&mutex);
+  entries.clear();
+  mainDepth = 0;
+  finishMs = -1;
+  running = true;
+  timer.start();
+}
+
+void begin(const QString& name)
+{
+  QMutexLocker locker(&mutex);
+  if(!running)
+    return;
+
+  Entry entry;
+  entry.name = name;
+  entry.beginMs = timer.elapsed();
+  entry.background = !isMainThread();
+  entry.depth = entry.background ? 0 : mainDepth++;
+  entries.append(entry);
+}
+
+void end(const QString& name)
+{
+  QMutexLocker locker(&mutex);
+  if(!running)
+    return;
+
+  bool background = !isMainThread();
+
+  // Find last open entry with the same name from the same thread type
+  for(int i = entries.size() - 1; i >= 0; i--)
+  {
+    Entry& entry = entries[i];
+    if(entry.endMs == -1 && entry.background == background && entry.name == name)
+    {
+      entry.endMs = timer.elapsed();
+      if(!background)
+        mainDepth = std::max(0, mainDepth - 1);
+      break;
+    }
+  }
+}
+
+QString report()
+{
+  QMutexLocker locker(&mutex);
+
+  QString str;
+  QTextStream stream(&str);
+  stream << "Startup trace - " << QCoreApplication::applicationName() << " "
+         << QCoreApplication::applicationVersion() << endl;
+  stream << "Begin ms   Duration ms   Phase" << endl;
+
+  for(const Entry& entry : entries)
+  {
+    qint64 duration = entry.endMs == -1 ? -1 : entry.endMs - entry.beginMs;
+    stream << qSetFieldWidth(8) << right << entry.beginMs << qSetFieldWidth(0) << "   "
+           << qSetFieldWidth(11) << right << duration << qSetFieldWidth(0) << "   "
+           << QString(entry.depth * 2, ' ') << entry.name
+           << (entry.background ? " (background)" : "")
+           << (entry.endMs == -1 ? " (not finished)" : "") << endl;
+  }
+
+  if(finishMs != -1)
+    stream << "Main window ready after " << finishMs << " ms" << endl;
+
+  return str;
+}
+
+void finish()
+{
+  {
+    QMutexLocker locker(&mutex);
+    if(!running || finishMs != -1)
+      return;
+
+    finishMs = timer.elapsed();
+  }
+
+  QString rep = report();
+  qInfo().noquote().nospace() << Q_FUNC_INFO << endl << rep;
+
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  if(settings.getAndStoreValue(lnm::OPTIONS_STARTUP_TRACE, false).toBool())
+  {
+    QFile file(atools::settings::Settings::getPath() + QDir::separator() + "little_navmap_startup.txt");
+    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+      QTextStream stream(&file);
+      stream.setCodec("UTF-8");
+      stream << rep;
+      file.close();
+      qInfo() << Q_FUNC_INFO << "Startup trace written to" << file.fileName();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << file.fileName() << file.errorString();
+  }
+
+  // Do not record background phases after startup
+  QMutexLocker locker(&mutex);
+  running = false;
+}
+
+}
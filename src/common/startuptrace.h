@@ -0,0 +1,68 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_STARTUPTRACE_H
+#define LNM_STARTUPTRACE_H
+
+#include <QString>
+
+/*
+ * Records the duration of startup phases from main() until the main window is shown.
+ * Phases can be nested and can run in background threads. All methods are thread safe.
+ *
+ * The report is always printed to the log when calling finish() and is written additionally to
+ * "little_navmap_startup.txt" in the settings folder if option "Options/StartupTrace" is set.
+ */
+namespace startuptrace {
+
+/* Start the clock. Called once early in main() */
+void start();
+
+/* Stop recording, print report and write it to a file if enabled. Further calls are ignored. */
+void finish();
+
+/* Mark begin and end of a phase */
+void begin(const QString& name);
+void end(const QString& name);
+
+/* Formatted report of all phases. Background phases are marked. */
+QString report();
+
+/* Records a phase from construction to destruction */
+class Phase
+{
+public:
+  explicit Phase(const QString& nameParam)
+    : name(nameParam)
+  {
+    begin(name);
+  }
+
+  ~Phase()
+  {
+    end(name);
+  }
+
+private:
+  Q_DISABLE_COPY(Phase)
+
+  QString name;
+};
+
+}
+
+#endif // LNM_STARTUPTRACE_H
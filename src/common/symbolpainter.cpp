@@ -30,6 +30,8 @@
 
 #include <QPainter>
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QDebug>
 #include <marble/GeoPainter.h>
 
 using namespace Marble;
@@ -43,8 +45,15 @@ const QVector<QLine> AIRCRAFTLINES({QLine(0, -20, 0, 16), // Body
                                     QLine(-10, 18, 0, 14), QLine(0, 14, 10, 18) // Horizontal stabilizer
                                    });
 
+/* Size of sprite image cache in kB */
+const static int SPRITE_CACHE_SIZE_KB = 8192;
+
+/* Wind barb sprites are rotated in steps of this degree value */
+const static int SPRITE_ROTATION_STEP = 5;
+
 SymbolPainter::SymbolPainter()
 {
+  spriteImages.setMaxCost(SPRITE_CACHE_SIZE_KB);
 }
 
 SymbolPainter::~SymbolPainter()
@@ -52,6 +61,56 @@ SymbolPainter::~SymbolPainter()
 
 }
 
+uint qHash(const SymbolPainter::SpriteKey& key)
+{
+  return static_cast<uint>(key.type) ^ (static_cast<uint>(key.size) << 2) ^ (static_cast<uint>(key.rotate) << 12) ^
+         (static_cast<uint>(key.value1) << 21) ^ (static_cast<uint>(key.value2) << 26) ^
+         (static_cast<uint>(key.flags) << 28) ^ static_cast<uint>(key.pixelRatio) ^
+         key.color1 ^ (key.color2 << 1) ^ (key.color3 << 2);
+}
+
+bool SymbolPainter::SpriteKey::operator==(const SymbolPainter::SpriteKey& other) const
+{
+  return type == other.type && size == other.size && rotate == other.rotate && value1 == other.value1 &&
+         value2 == other.value2 && flags == other.flags && pixelRatio == other.pixelRatio &&
+         color1 == other.color1 && color2 == other.color2 && color3 == other.color3;
+}
+
+bool SymbolPainter::useSprites(QPainter *painter) const
+{
+  // Vector drawing methods reset the transformation - allow only translation here
+  return spritesEnabled && painter->device() != nullptr && painter->transform().type() <= QTransform::TxTranslate;
+}
+
+template<typename DRAW>
+void SymbolPainter::drawSprite(QPainter *painter, SpriteKey key, float x, float y, int extent, DRAW draw) const
+{
+  qreal pixelRatio = painter->device()->devicePixelRatioF();
+  key.pixelRatio = atools::roundToInt(pixelRatio * 100.);
+
+  // Top left position of the image rounded to full pixels to avoid blurring
+  QPointF pos(std::round(x - extent / 2.f), std::round(y - extent / 2.f));
+
+  const QImage *image = spriteImages.object(key);
+  if(image != nullptr)
+    painter->drawImage(pos, *image);
+  else
+  {
+    QImage *newImage = new QImage(QSize(extent, extent) * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+    newImage->setDevicePixelRatio(pixelRatio);
+    newImage->fill(Qt::transparent);
+    {
+      QPainter spritePainter(newImage);
+      prepareForIcon(spritePainter);
+      draw(&spritePainter, extent / 2.f, extent / 2.f);
+    }
+    painter->drawImage(pos, *newImage);
+
+    // Cache takes ownership and might delete the image immediately if it is too large
+    spriteImages.insert(key, newImage, std::max(newImage->width() * newImage->height() * 4 / 1024, 1));
+  }
+}
+
 QIcon SymbolPainter::createAirportIcon(const map::MapAirport& airport, int size)
 {
   QPixmap pixmap(size, size);
@@ -302,6 +361,24 @@ void SymbolPainter::drawAirportSymbol(QPainter *painter, const map::MapAirport&
 }
 
 void SymbolPainter::drawWaypointSymbol(QPainter *painter, const QColor& col, float x, float y, int size, bool fill)
+{
+  if(useSprites(painter) && size > 4)
+  {
+    QColor color = col.isValid() ? col : mapcolors::waypointSymbolColor;
+    float lineWidth = std::max(size / 6.f, 1.5f);
+
+    SpriteKey key = {SPRITE_WAYPOINT, size, 0, 0, 0, fill, 0, color.rgba(), mapcolors::routeTextBoxColor.rgba(), 0};
+    drawSprite(painter, key, x, y, atools::roundToInt(size + lineWidth * 2.f) + 2,
+               [ =](QPainter *spritePainter, float cx, float cy) -> void {
+      drawWaypointSymbolInternal(spritePainter, color, cx, cy, size, fill);
+    });
+  }
+  else
+    drawWaypointSymbolInternal(painter, col, x, y, size, fill);
+}
+
+void SymbolPainter::drawWaypointSymbolInternal(QPainter *painter, const QColor& col, float x, float y, int size,
+                                               bool fill) const
 {
   atools::util::PainterContextSaver saver(painter);
   painter->setBackgroundMode(Qt::TransparentMode);
@@ -448,6 +525,53 @@ void SymbolPainter::drawWindBarbs(QPainter *painter, const atools::fs::weather::
 void SymbolPainter::drawWindBarbs(QPainter *painter, float wind, float gust, float dir,
                                   float x, float y, float size, bool windBarbs, bool altWind, bool route,
                                   bool fast) const
+{
+  if(useSprites(painter))
+  {
+    const float INVALID = atools::fs::weather::INVALID_METAR_VALUE / 2.f;
+
+    // Quantize wind speeds to the five knot steps of the feathers.
+    // -1 is no pointer, 0 is a pointer without feathers.
+    int windQuant = -1, gustQuant = -1;
+    if(wind >= 2.f && wind < INVALID && dir >= 0.f && dir < INVALID)
+      windQuant = static_cast<int>(wind / 5.f);
+    if(gust >= 2.f && gust < INVALID && windBarbs && !fast)
+      gustQuant = static_cast<int>(gust / 5.f);
+
+    int rotate = windQuant >= 0 ?
+                 (atools::roundToInt(dir / SPRITE_ROTATION_STEP) * SPRITE_ROTATION_STEP) % 360 : 0;
+
+    // Get the speeds which result in the same feathers as the original values
+    float windSprite = windQuant > 0 ? windQuant * 5.f : (windQuant == 0 ? 2.f : 0.f);
+    float gustSprite = gustQuant > 0 ? gustQuant * 5.f : (gustQuant == 0 ? 2.f : 0.f);
+
+    // Calculate image size from the longest pointer including feathers
+    float lineWidth = size * (altWind ? 0.2f : 0.3f);
+    float lineLength = size, gustLineLength = size;
+    if(windBarbs && !fast)
+    {
+      calculateWindBarbs(lineLength, lineWidth, windSprite, true);
+      calculateWindBarbs(gustLineLength, lineWidth, gustSprite, true);
+    }
+    float radius = std::max(lineLength, gustLineLength) + size * 0.7f /* 50 knot barb */ + lineWidth * 2.5f;
+
+    int flags = windBarbs | altWind << 1 | route << 2 | fast << 3;
+    SpriteKey key = {SPRITE_WIND_BARB, atools::roundToInt(size * 10.f), rotate, windQuant, gustQuant, flags, 0,
+                     mapcolors::weatherWindColor.rgba(), mapcolors::weatherWindGustColor.rgba(),
+                     (route ? mapcolors::routeTextBoxColor : mapcolors::weatherBackgoundColor).rgba()};
+    drawSprite(painter, key, x, y, atools::roundToInt(radius * 2.f) + 2,
+               [ =](QPainter *spritePainter, float cx, float cy) -> void {
+      drawWindBarbsInternal(spritePainter, windSprite, gustSprite, rotate, cx, cy, size, windBarbs, altWind, route,
+                            fast);
+    });
+  }
+  else
+    drawWindBarbsInternal(painter, wind, gust, dir, x, y, size, windBarbs, altWind, route, fast);
+}
+
+void SymbolPainter::drawWindBarbsInternal(QPainter *painter, float wind, float gust, float dir,
+                                          float x, float y, float size, bool windBarbs, bool altWind, bool route,
+                                          bool fast) const
 {
   // Make lines thinner for high altitude wind barbs
   float lineWidth = size * (altWind ? 0.2f : 0.3f);
@@ -881,6 +1005,24 @@ void SymbolPainter::drawVorSymbol(QPainter *painter, const map::MapVor& vor, flo
 }
 
 void SymbolPainter::drawNdbSymbol(QPainter *painter, float x, float y, float size, bool routeFill, bool fast)
+{
+  if(useSprites(painter))
+  {
+    float lineWidth = std::max(size / 16.f, 1.5f);
+
+    SpriteKey key = {SPRITE_NDB, atools::roundToInt(size * 10.f), 0, 0, 0, routeFill | fast << 1, 0,
+                     mapcolors::ndbSymbolColor.rgba(), mapcolors::routeTextBoxColor.rgba(), 0};
+    drawSprite(painter, key, x, y, atools::roundToInt(size + lineWidth * 2.f) + 2,
+               [ =](QPainter *spritePainter, float cx, float cy) -> void {
+      drawNdbSymbolInternal(spritePainter, cx, cy, size, routeFill, fast);
+    });
+  }
+  else
+    drawNdbSymbolInternal(painter, x, y, size, routeFill, fast);
+}
+
+void SymbolPainter::drawNdbSymbolInternal(QPainter *painter, float x, float y, float size, bool routeFill,
+                                          bool fast) const
 {
   atools::util::PainterContextSaver saver(painter);
 
@@ -1262,7 +1404,64 @@ const QPixmap *SymbolPainter::trackLineFromCache(int size)
   }
 }
 
-void SymbolPainter::prepareForIcon(QPainter& painter)
+void SymbolPainter::benchmarkSprites()
+{
+  const int IMAGE_SIZE = 1024, STEP = 32, PASSES = 10;
+  QImage image(IMAGE_SIZE, IMAGE_SIZE, QImage::Format_ARGB32_Premultiplied);
+  bool enabled = spritesEnabled;
+
+  for(bool sprites : {false, true})
+  {
+    spritesEnabled = sprites;
+    spriteImages.clear();
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+
+    // Wind barb grid with varying speed and direction ==============================
+    QElapsedTimer timer;
+    timer.start();
+    int num = 0;
+    for(int pass = 0; pass < PASSES; pass++)
+    {
+      for(int y = STEP / 2; y < IMAGE_SIZE; y += STEP)
+      {
+        for(int x = STEP / 2; x < IMAGE_SIZE; x += STEP)
+        {
+          drawWindBarbs(&painter, (x + y + pass) % 120, 0.f, (x * 7 + y * 3 + pass) % 360, x, y, 12.f,
+                        true /* wind barbs */, true /* alt wind */, false /* route */, false /* fast */);
+          num++;
+        }
+      }
+    }
+    qint64 windUs = timer.nsecsElapsed() / 1000;
+
+    // Dense navaids ==============================
+    timer.restart();
+    for(int pass = 0; pass < PASSES; pass++)
+    {
+      for(int y = STEP / 4; y < IMAGE_SIZE; y += STEP / 2)
+      {
+        for(int x = STEP / 4; x < IMAGE_SIZE; x += STEP / 2)
+        {
+          drawNdbSymbol(&painter, x, y, 14.f, false /* route fill */, false /* fast */);
+          drawWaypointSymbol(&painter, QColor(), x + STEP / 4, y, 8, false /* fill */);
+        }
+      }
+    }
+    qint64 navaidUs = timer.nsecsElapsed() / 1000;
+
+    qDebug() << Q_FUNC_INFO << (sprites ? "sprites" : "vector") << num << "wind barbs" << windUs << "us"
+             << "navaids" << navaidUs << "us" << "cache" << spriteImages.size() << "images"
+             << spriteImages.totalCost() << "kB";
+  }
+
+  spritesEnabled = enabled;
+  spriteImages.clear();
+}
+
+void SymbolPainter::prepareForIcon(QPainter& painter) const
 {
   painter.setRenderHint(QPainter::Antialiasing, true);
   painter.setRenderHint(QPainter::TextAntialiasing, true);
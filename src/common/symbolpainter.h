@@ -24,6 +24,7 @@
 
 #include <QColor>
 #include <QIcon>
+#include <QImage>
 #include <QApplication>
 #include <QCache>
 
@@ -64,6 +65,8 @@ class SymbolPainter
 {
   Q_DECLARE_TR_FUNCTIONS(SymbolPainter)
 
+  struct SpriteKey;
+
 public:
   /*
    * @param backgroundColor used for tooltips of table view icons
@@ -161,14 +164,67 @@ public:
   void drawWindBarbs(QPainter *painter, float wind, float gust, float dir, float x, float y, float size,
                      bool windBarbs, bool altWind, bool route, bool fast) const;
 
+  /* Draw wind barbs, NDB and waypoint symbols from pre-rendered images instead of vector drawing.
+   * Images are keyed by symbol type, size, colors and quantized rotation and wind speed.
+   * Used only for painters without rotation or scaling. Enabled by default for map painters and can be
+   * switched off with Options/MapSymbolSprites in the configuration. */
+  void setSpritesEnabled(bool value)
+  {
+    spritesEnabled = value;
+  }
+
+  bool isSpritesEnabled() const
+  {
+    return spritesEnabled;
+  }
+
+  /* Draw a grid of symbols with vector drawing and sprites into an image and print timing to the log */
+  void benchmarkSprites();
+
 private:
+  friend uint qHash(const SymbolPainter::SpriteKey& key);
+
+  enum SpriteType
+  {
+    SPRITE_WIND_BARB,
+    SPRITE_NDB,
+    SPRITE_WAYPOINT
+  };
+
+  /* Key built from all attributes which change the appearance of a sprite */
+  struct SpriteKey
+  {
+    bool operator==(const SymbolPainter::SpriteKey& other) const;
+
+    SpriteType type;
+    int size, rotate, value1, value2, flags, pixelRatio;
+    QRgb color1, color2, color3;
+  };
+
+  /* Get image from cache or call draw to render it and blit it centered at x and y */
+  template<typename DRAW>
+  void drawSprite(QPainter *painter, SpriteKey key, float x, float y, int extent, DRAW draw) const;
+
+  /* true if sprites can be used for this painter */
+  bool useSprites(QPainter *painter) const;
+
+  /* Vector drawing methods */
+  void drawWindBarbsInternal(QPainter *painter, float wind, float gust, float dir, float x, float y, float size,
+                             bool windBarbs, bool altWind, bool route, bool fast) const;
+  void drawNdbSymbolInternal(QPainter *painter, float x, float y, float size, bool routeFill, bool fast) const;
+  void drawWaypointSymbolInternal(QPainter *painter, const QColor& col, float x, float y, int size, bool fill) const;
+
   QStringList airportTexts(optsd::DisplayOptions dispOpts, textflags::TextFlags flags,
                            const map::MapAirport& airport, int maxTextLength);
   const QPixmap *windPointerFromCache(int size);
   const QPixmap *trackLineFromCache(int size);
 
   QCache<int, QPixmap> windPointerPixmaps, trackLinePixmaps;
-  void prepareForIcon(QPainter& painter);
+
+  /* QImage instead of QPixmap since wind barbs are drawn in a separate thread. Cost is kB. */
+  mutable QCache<SpriteKey, QImage> spriteImages;
+  bool spritesEnabled = false;
+  void prepareForIcon(QPainter& painter) const;
 
   void drawWindBarbs(QPainter *painter, const atools::fs::weather::MetarParser& parsedMetar, float x, float y,
                      float size, bool windBarbs, bool altWind, bool route, bool fast) const;
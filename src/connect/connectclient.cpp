@@ -19,6 +19,9 @@
 
 #include "navapp.h"
 #include "common/constants.h"
+#include "connect/simdatadelta.h"
+#include "connect/simdatarecorder.h"
+#include "connect/simdatareplay.h"
 #include "fs/sc/simconnectreply.h"
 #include "fs/sc/datareaderthread.h"
 #include "gui/dialog.h"
@@ -31,6 +34,7 @@
 #include "fs/sc/xpconnecthandler.h"
 
 #include <QDataStream>
+#include <QDateTime>
 #include <QTcpSocket>
 #include <QWidget>
 #include <QApplication>
@@ -48,6 +52,8 @@ ConnectClient::ConnectClient(MainWindow *parent)
   errorMessageBox = new QMessageBox(QMessageBox::Critical, QApplication::applicationName(),
                                     QString(), QMessageBox::Ok, mainWindow);
 
+  deltaDecoder = new simdelta::Decoder;
+
   // Create FSX/P3D handler for SimConnect
   simConnectHandler = new atools::fs::sc::SimConnectHandler(verbose);
   simConnectHandler->loadSimConnect(QApplication::applicationFilePath() + ".simconnect");
@@ -80,6 +86,25 @@ ConnectClient::ConnectClient(MainWindow *parent)
   connect(dialog, &ConnectDialog::disconnectClicked, this, &ConnectClient::disconnectClicked);
   connect(dialog, &ConnectDialog::autoConnectToggled, this, &ConnectClient::autoConnectToggled);
 
+  // Record all packets to file if set in configuration. "%1" is replaced with the current time.
+  QString recordFile = settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_RECORD_FILE, QString()).toString();
+  if(!recordFile.isEmpty())
+  {
+    if(recordFile.contains("%1"))
+      recordFile = recordFile.arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+
+    recorder = new SimDataRecorder;
+    if(!recorder->open(recordFile))
+    {
+      delete recorder;
+      recorder = nullptr;
+    }
+  }
+
+  replay = new SimDataReplay(this);
+  connect(replay, &SimDataReplay::simDataReplayed, this, &ConnectClient::postSimConnectData);
+  connect(replay, &SimDataReplay::replayFinished, this, &ConnectClient::replayFinished);
+
   reconnectNetworkTimer.setSingleShot(true);
   connect(&reconnectNetworkTimer, &QTimer::timeout, this, &ConnectClient::connectInternalAuto);
 
@@ -97,6 +122,14 @@ ConnectClient::~ConnectClient()
 
   disconnectClicked();
 
+  // Close file without sending signals
+  replay->close();
+
+  qDebug() << Q_FUNC_INFO << "delete recorder";
+  delete recorder;
+
+  delete deltaDecoder;
+
   qDebug() << Q_FUNC_INFO << "delete dataReader";
   delete dataReader;
 
@@ -136,6 +169,7 @@ void ConnectClient::connectToServerDialog()
     errorState = false;
     silent = false;
     closeSocket(false /* allow restart */);
+    stopReplay();
 
     dataReader->terminateThread();
 
@@ -148,6 +182,16 @@ void ConnectClient::connectToServerDialog()
 
 void ConnectClient::tryConnectOnStartup()
 {
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  QString replayFile = settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_REPLAY_FILE, QString()).toString();
+  if(!replayFile.isEmpty() &&
+     !settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_REPLAY_BENCHMARK, false).toBool())
+  {
+    // Replay recorded flight instead of connecting
+    if(startReplay(replayFile, settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_REPLAY_SPEED, 1.f).toFloat()))
+      return;
+  }
+
   if(dialog->isAutoConnect())
   {
     reconnectNetworkTimer.stop();
@@ -182,6 +226,44 @@ QString ConnectClient::simShortName() const
   return QString();
 }
 
+bool ConnectClient::startReplay(const QString& filename, float speed)
+{
+  if(isConnected())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot replay while connected";
+    return false;
+  }
+
+  if(!replay->open(filename))
+    return false;
+
+  qDebug() << Q_FUNC_INFO << filename << "speed" << speed;
+  replaying = true;
+  mainWindow->setConnectionStatusMessageText(tr("Replay"), tr("Replaying recorded flight \"%1\".").arg(filename));
+  emit connectedToSimulator();
+
+  replay->start(speed);
+  return true;
+}
+
+void ConnectClient::stopReplay()
+{
+  if(replaying)
+  {
+    replay->close();
+    replayFinished();
+  }
+}
+
+void ConnectClient::replayFinished()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  replaying = false;
+  mainWindow->setConnectionStatusMessageText(tr("Disconnected"), tr("Replay of recorded flight finished."));
+  emit disconnectedFromSimulator();
+}
+
 void ConnectClient::connectedToSimulatorDirect()
 {
   qDebug() << Q_FUNC_INFO;
@@ -224,6 +306,10 @@ void ConnectClient::disconnectedFromSimulatorDirect()
 /* Posts data received directly from simconnect or the socket and caches any metar reports */
 void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
 {
+  // Save unmodified packet - do not record a replay again
+  if(recorder != nullptr && !replaying)
+    recorder->write(dataPacket);
+
   // Modify AI aircraft and set shadow flag if a online network with the same callsign exists
   for(atools::fs::sc::SimConnectAircraft& aircraft : dataPacket.getAiAircraft())
   {
@@ -552,6 +638,9 @@ void ConnectClient::connectInternal()
 
 bool ConnectClient::isConnected() const
 {
+  if(replaying)
+    return true;
+
   if(dataReader != nullptr)
     return (socket != nullptr && socket->isOpen()) || dataReader->isConnected();
   else
@@ -625,6 +714,10 @@ void ConnectClient::closeSocket(bool allowRestart)
   delete simConnectData;
   simConnectData = nullptr;
 
+  // Negotiate again on next connection
+  deltaRequested = deltaAccepted = false;
+  deltaDecoder->reset();
+
   QString msgTooltip, msg;
   if(error == QAbstractSocket::RemoteHostClosedError || error == QAbstractSocket::UnknownSocketError)
   {
@@ -712,6 +805,18 @@ void ConnectClient::connectedToServerSocket()
 
   silent = false;
 
+  // Ask server for delta protocol if enabled - legacy servers might close the connection
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  if(settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_DELTA_PROTOCOL, false).toBool())
+  {
+    quint8 flags = settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_DELTA_COMPRESSION, true).toBool() ?
+                   simdelta::COMPRESSED : simdelta::NONE;
+    socket->write(simdelta::helloFrame(flags));
+    socket->flush();
+    deltaRequested = true;
+    qInfo() << Q_FUNC_INFO << "Requesting delta protocol" << "compressed" << (flags & simdelta::COMPRESSED);
+  }
+
   dialog->setConnected(isConnected());
 
   // Let other program parts know about the new connection
@@ -725,10 +830,22 @@ void ConnectClient::readFromSocket()
 {
   if(socket != nullptr)
   {
-    while(socket->bytesAvailable())
+    while(socket != nullptr && socket->bytesAvailable())
     {
       if(verbose)
         qDebug() << "readFromSocket" << socket->bytesAvailable();
+
+      if(deltaRequested && simConnectData == nullptr)
+      {
+        // Check for delta protocol frames if not in the middle of a legacy packet
+        bool legacy = false;
+        if(!readFrameFromSocket(legacy))
+          return;
+
+        if(!legacy)
+          continue;
+      }
+
       if(simConnectData == nullptr)
         // Need to keep the data in background since this method can be called multiple times until the data is filled
         simConnectData = new atools::fs::sc::SimConnectData;
@@ -751,33 +868,7 @@ void ConnectClient::readFromSocket()
         qDebug() << "readFromSocket 2" << socket->bytesAvailable();
       if(read)
       {
-        if(verbose)
-          qDebug() << "readFromSocket id " << simConnectData->getPacketId();
-
-        if(simConnectData->getPacketId() > 0)
-        {
-          if(verbose)
-            qDebug() << "readFromSocket id " << simConnectData->getPacketId() << "replying";
-
-          // Data was read completely and successfully - reply to server
-          atools::fs::sc::SimConnectReply reply;
-          reply.setPacketId(simConnectData->getPacketId());
-          writeReplyToSocket(reply);
-        }
-        else if(!simConnectData->getMetars().isEmpty())
-        {
-          if(verbose)
-            qDebug() << "readFromSocket id " << simConnectData->getPacketId() << "metars";
-
-          for(const atools::fs::weather::MetarResult& metar : simConnectData->getMetars())
-            outstandingReplies.remove(metar.requestIdent);
-
-          // Start request on next invocation of the event queue
-          QTimer::singleShot(0, this, &ConnectClient::flushQueuedRequests);
-        }
-
-        // Send around in the application
-        postSimConnectData(*simConnectData);
+        handleSocketData(*simConnectData);
         delete simConnectData;
         simConnectData = nullptr;
       }
@@ -791,3 +882,79 @@ void ConnectClient::readFromSocket()
     }
   }
 }
+
+bool ConnectClient::readFrameFromSocket(bool& legacy)
+{
+  QByteArray frame;
+  simdelta::ReadStatus status = simdelta::readFrame(socket, frame);
+
+  if(status == simdelta::FRAME_INCOMPLETE)
+    // Wait for more data
+    return false;
+  else if(status == simdelta::FRAME_LEGACY)
+  {
+    legacy = true;
+    return true;
+  }
+
+  QString error = tr("Invalid frame");
+  simdelta::FrameType type;
+  quint8 flags = simdelta::NONE;
+  if(status == simdelta::FRAME_OK && simdelta::frameType(frame, type, flags))
+  {
+    if(type == simdelta::ACK)
+    {
+      qInfo() << Q_FUNC_INFO << "Server accepted delta protocol" << "compressed" << (flags & simdelta::COMPRESSED);
+      deltaAccepted = true;
+      return true;
+    }
+    else if(deltaAccepted && (type == simdelta::KEYFRAME || type == simdelta::DELTA))
+    {
+      atools::fs::sc::SimConnectData data;
+      if(deltaDecoder->decode(frame, data))
+      {
+        handleSocketData(data);
+        return true;
+      }
+      error = deltaDecoder->getErrorString();
+    }
+  }
+
+  // Something went wrong - shutdown
+  qWarning() << Q_FUNC_INFO << error;
+  closeSocket(false);
+  QMessageBox::critical(mainWindow, QApplication::applicationName(),
+                        tr("Error reading data from Little Navconnect: %1.").arg(error));
+  return false;
+}
+
+void ConnectClient::handleSocketData(atools::fs::sc::SimConnectData& data)
+{
+  if(verbose)
+    qDebug() << "readFromSocket id " << data.getPacketId();
+
+  if(data.getPacketId() > 0)
+  {
+    if(verbose)
+      qDebug() << "readFromSocket id " << data.getPacketId() << "replying";
+
+    // Data was read completely and successfully - reply to server
+    atools::fs::sc::SimConnectReply reply;
+    reply.setPacketId(data.getPacketId());
+    writeReplyToSocket(reply);
+  }
+  else if(!data.getMetars().isEmpty())
+  {
+    if(verbose)
+      qDebug() << "readFromSocket id " << data.getPacketId() << "metars";
+
+    for(const atools::fs::weather::MetarResult& metar : data.getMetars())
+      outstandingReplies.remove(metar.requestIdent);
+
+    // Start request on next invocation of the event queue
+    QTimer::singleShot(0, this, &ConnectClient::flushQueuedRequests);
+  }
+
+  // Send around in the application
+  postSimConnectData(data);
+}
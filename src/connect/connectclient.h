@@ -30,6 +30,12 @@ class QTcpSocket;
 class ConnectDialog;
 class MainWindow;
 class QMessageBox;
+class SimDataRecorder;
+class SimDataReplay;
+
+namespace simdelta {
+class Decoder;
+}
 
 namespace atools {
 namespace fs {
@@ -87,6 +93,16 @@ public:
   bool isFetchAiShip() const;
   bool isFetchAiAircraft() const;
 
+  /* Play back a file recorded by SimDataRecorder instead of connecting to a simulator.
+   * speed 1 is real time. Does nothing if connected. */
+  bool startReplay(const QString& filename, float speed);
+  void stopReplay();
+
+  bool isReplaying() const
+  {
+    return replaying;
+  }
+
 signals:
   /* Emitted when new data was received from the server (Little Navconnect), SimConnect or X-Plane.
    * can be aircraft position or weather update */
@@ -116,6 +132,12 @@ private:
   const int NOT_AVAILABLE_TIMEOUT_FS_SECS = 300;
 
   void readFromSocket();
+
+  /* Read delta protocol frame if negotiated. Returns false if nothing was read and the loop has to stop. */
+  bool readFrameFromSocket(bool& legacy);
+
+  /* Reply to server and send data around after a packet was read completely */
+  void handleSocketData(atools::fs::sc::SimConnectData& data);
   void readFromSocketError(QAbstractSocket::SocketError error);
   void connectedToServerSocket();
   void closeSocket(bool allowRestart);
@@ -140,6 +162,7 @@ private:
   void handleError(atools::fs::sc::SimConnectStatus status, const QString& error, bool xplane, bool network);
 
   void statusPosted(atools::fs::sc::SimConnectStatus status, QString statusText);
+  void replayFinished();
 
   bool silent = false, manualDisconnect = false;
   ConnectDialog *dialog = nullptr;
@@ -153,6 +176,11 @@ private:
   atools::fs::sc::SimConnectData *simConnectData = nullptr;
 
   QTcpSocket *socket = nullptr;
+
+  /* Delta protocol was requested from server and server accepted it */
+  bool deltaRequested = false, deltaAccepted = false;
+  simdelta::Decoder *deltaDecoder = nullptr;
+
   /* Used to trigger reconnects on socket base connections */
   QTimer reconnectNetworkTimer, flushQueuedRequestsTimer;
   MainWindow *mainWindow;
@@ -175,6 +203,12 @@ private:
   bool socketConnected = false;
 
   bool errorState = false;
+
+  /* Records all received packets if enabled in configuration */
+  SimDataRecorder *recorder = nullptr;
+
+  SimDataReplay *replay = nullptr;
+  bool replaying = false;
 };
 
 #endif // LITTLENAVMAP_CONNECTCLIENT_H
@@ -0,0 +1,549 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdatadelta.h"
+
+#include "connect/simdatareplay.h"
+#include "fs/sc/simconnectdata.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+using atools::fs::sc::SimConnectData;
+using atools::fs::sc::SimConnectAircraft;
+
+namespace simdelta {
+
+/* Record types in payload */
+enum RecordType : quint8
+{
+  RECORD_SAME = 0,
+  RECORD_FULL = 1,
+  RECORD_DIFF = 2
+};
+
+/* Do not accept frames larger than this */
+const quint32 MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+/* Do not compress small payloads */
+const int MIN_COMPRESS_SIZE = 256;
+
+/* Unchanged bytes between two changed runs which are included in the run to avoid segment overhead */
+const int MIN_DIFF_GAP = 8;
+
+/* Smallest possible AI record in payload: id and record type */
+const qint64 MIN_AI_RECORD_SIZE = sizeof(qint32) + sizeof(quint8);
+
+/* Same settings for all streams of aircraft records on both sides */
+static void initStream(QDataStream& stream)
+{
+  stream.setVersion(QDataStream::Qt_5_5);
+  stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+static QByteArray buildFrame(FrameType type, quint8 flags, quint32 sequence, const QByteArray& payload)
+{
+  QByteArray frame;
+  QDataStream out(&frame, QIODevice::WriteOnly);
+  out << MAGIC << static_cast<quint32>(0) << VERSION << static_cast<quint8>(type) << flags << sequence << payload;
+
+  // Update size of the bytes following the frame header
+  qToBigEndian(static_cast<quint32>(frame.size() - FRAME_HEADER_SIZE), reinterpret_cast<uchar *>(frame.data() + 4));
+  return frame;
+}
+
+static bool parseFrame(const QByteArray& frame, FrameType& type, quint8& flags, quint32& sequence,
+                       QByteArray *payload)
+{
+  QDataStream in(frame);
+  quint32 magic, size;
+  quint8 version, typeValue;
+  in >> magic >> size >> version >> typeValue >> flags >> sequence;
+
+  if(in.status() != QDataStream::Ok || magic != MAGIC || version != VERSION ||
+     size != static_cast<quint32>(frame.size() - FRAME_HEADER_SIZE) || typeValue < HELLO || typeValue > DELTA)
+    return false;
+
+  type = static_cast<FrameType>(typeValue);
+  if(payload != nullptr)
+    in >> *payload;
+  return in.status() == QDataStream::Ok;
+}
+
+/* Byte difference of two arrays with equal size. Segments of bytes to skip, number of changed bytes and bytes. */
+static QByteArray byteDiff(const QByteArray& base, const QByteArray& current)
+{
+  QByteArray diff;
+  QDataStream out(&diff, QIODevice::WriteOnly);
+
+  const char *b = base.constData(), *c = current.constData();
+  int size = current.size(), last = 0, i = 0;
+  while(i < size)
+  {
+    if(b[i] == c[i])
+    {
+      i++;
+      continue;
+    }
+
+    // Find end of changed run and include short unchanged gaps
+    int start = i, end = i;
+    while(end < size)
+    {
+      if(b[end] != c[end])
+        end++;
+      else
+      {
+        int gap = end;
+        while(gap < size && gap - end < MIN_DIFF_GAP && b[gap] == c[gap])
+          gap++;
+
+        if(gap == size || gap - end >= MIN_DIFF_GAP)
+          break;
+        end = gap;
+      }
+    }
+
+    out << static_cast<quint32>(start - last) << static_cast<quint32>(end - start);
+    out.writeRawData(c + start, end - start);
+    last = i = end;
+  }
+  return diff;
+}
+
+/* Apply a difference created by byteDiff. Returns false if the difference does not fit the base. */
+static bool applyByteDiff(QByteArray& result, const QByteArray& base, const QByteArray& diff)
+{
+  result = base;
+  QDataStream in(diff);
+  const qint64 size = result.size();
+  qint64 pos = 0;
+  while(!in.atEnd())
+  {
+    quint32 skip, length;
+    in >> skip >> length;
+
+    // Check separately and in 64 bit to avoid overflow
+    if(in.status() != QDataStream::Ok || skip > size - pos || length > size - pos - skip)
+      return false;
+    pos += skip;
+
+    if(in.readRawData(result.data() + pos, static_cast<int>(length)) != static_cast<int>(length))
+      return false;
+    pos += length;
+  }
+  return true;
+}
+
+static void writeRecord(QDataStream& out, const QByteArray& base, const QByteArray& current)
+{
+  if(base.isEmpty() || base.size() != current.size())
+    out << static_cast<quint8>(RECORD_FULL) << current;
+  else if(base == current)
+    out << static_cast<quint8>(RECORD_SAME);
+  else
+  {
+    QByteArray diff = byteDiff(base, current);
+    if(diff.size() < current.size())
+      out << static_cast<quint8>(RECORD_DIFF) << diff;
+    else
+      out << static_cast<quint8>(RECORD_FULL) << current;
+  }
+}
+
+static bool readRecord(QDataStream& in, const QByteArray& base, QByteArray& record)
+{
+  quint8 type;
+  in >> type;
+  if(in.status() != QDataStream::Ok)
+    return false;
+
+  if(type == RECORD_SAME)
+  {
+    record = base;
+    return !base.isEmpty();
+  }
+
+  QByteArray bytes;
+  in >> bytes;
+  if(in.status() != QDataStream::Ok)
+    return false;
+
+  if(type == RECORD_FULL)
+  {
+    record = bytes;
+    return true;
+  }
+  else if(type == RECORD_DIFF)
+    return applyByteDiff(record, base, bytes);
+  else
+    return false;
+}
+
+/* Serialize packet without AI in legacy format */
+static QByteArray headerBytes(const SimConnectData& data)
+{
+  SimConnectData header(data);
+  header.getAiAircraft().clear();
+
+  QByteArray bytes;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::WriteOnly);
+  header.write(&buffer);
+  return bytes;
+}
+
+static QByteArray aircraftBytes(const SimConnectAircraft& aircraft)
+{
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  initStream(out);
+  aircraft.write(out);
+  return bytes;
+}
+
+ReadStatus readFrame(QIODevice *device, QByteArray& frame)
+{
+  if(device->bytesAvailable() < 4)
+    return FRAME_INCOMPLETE;
+
+  QByteArray header = device->peek(FRAME_HEADER_SIZE);
+  if(qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(header.constData())) != MAGIC)
+    return FRAME_LEGACY;
+
+  if(header.size() < FRAME_HEADER_SIZE)
+    return FRAME_INCOMPLETE;
+
+  quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(header.constData() + 4));
+  if(size > MAX_FRAME_SIZE)
+  {
+    qWarning() << Q_FUNC_INFO << "Frame too large" << size;
+    return FRAME_ERROR;
+  }
+
+  if(device->bytesAvailable() < FRAME_HEADER_SIZE + size)
+    return FRAME_INCOMPLETE;
+
+  frame = device->read(FRAME_HEADER_SIZE + size);
+  return frame.size() == FRAME_HEADER_SIZE + size ? FRAME_OK : FRAME_ERROR;
+}
+
+QByteArray helloFrame(quint8 flags)
+{
+  return buildFrame(HELLO, flags, 0, QByteArray());
+}
+
+QByteArray ackFrame(quint8 flags)
+{
+  return buildFrame(ACK, flags, 0, QByteArray());
+}
+
+bool frameType(const QByteArray& frame, FrameType& type, quint8& flags)
+{
+  quint32 sequence;
+  return parseFrame(frame, type, flags, sequence, nullptr);
+}
+
+// =======================================================================================
+QByteArray Encoder::encode(const SimConnectData& data)
+{
+  bool keyframe = keyframeNeeded || deltasSinceKeyframe >= keyframeInterval;
+  if(keyframe)
+  {
+    // Encode against empty state - all records are complete
+    lastHeader.clear();
+    lastAircraft.clear();
+    deltasSinceKeyframe = 0;
+    keyframeNeeded = false;
+  }
+  else
+    deltasSinceKeyframe++;
+  sequence++;
+
+  QByteArray payload;
+  QDataStream out(&payload, QIODevice::WriteOnly);
+
+  QByteArray header = headerBytes(data);
+  writeRecord(out, lastHeader, header);
+
+  const QVector<SimConnectAircraft>& aiAircraft = data.getAiAircraftConst();
+  out << static_cast<quint32>(aiAircraft.size());
+
+  QHash<int, QByteArray> aircraft;
+  aircraft.reserve(aiAircraft.size());
+  for(const SimConnectAircraft& ac : aiAircraft)
+  {
+    int id = static_cast<int>(ac.getObjectId());
+    QByteArray record = aircraftBytes(ac);
+
+    out << static_cast<qint32>(id);
+    writeRecord(out, lastAircraft.value(id), record);
+    aircraft.insert(id, record);
+  }
+
+  lastHeader = header;
+  lastAircraft.swap(aircraft);
+
+  quint8 flags = NONE;
+  if(compression && payload.size() > MIN_COMPRESS_SIZE)
+  {
+    QByteArray compressed = qCompress(payload);
+    if(compressed.size() < payload.size())
+    {
+      payload = compressed;
+      flags |= COMPRESSED;
+    }
+  }
+
+  return buildFrame(keyframe ? KEYFRAME : DELTA, flags, sequence, payload);
+}
+
+void Encoder::reset()
+{
+  keyframeNeeded = true;
+}
+
+// =======================================================================================
+bool Decoder::decode(const QByteArray& frame, SimConnectData& data)
+{
+  errorString.clear();
+
+  FrameType type;
+  quint8 flags;
+  quint32 seq;
+  QByteArray payload;
+  if(!parseFrame(frame, type, flags, seq, &payload))
+  {
+    errorString = QObject::tr("Invalid frame");
+    return false;
+  }
+
+  if(type == KEYFRAME)
+  {
+    lastHeader.clear();
+    lastAircraft.clear();
+    hasKeyframe = true;
+  }
+  else if(type == DELTA)
+  {
+    if(!hasKeyframe || seq != sequence + 1)
+    {
+      errorString = QObject::tr("Delta frame %1 does not follow frame %2").arg(seq).arg(sequence);
+      return false;
+    }
+  }
+  else
+  {
+    errorString = QObject::tr("Unexpected frame type %1").arg(static_cast<int>(type));
+    return false;
+  }
+
+  if(flags & COMPRESSED)
+  {
+    payload = qUncompress(payload);
+    if(payload.isEmpty())
+    {
+      errorString = QObject::tr("Cannot uncompress frame %1").arg(seq);
+      return false;
+    }
+  }
+
+  QDataStream in(payload);
+
+  // Read packet without AI in legacy format =========================
+  QByteArray header;
+  if(!readRecord(in, lastHeader, header))
+  {
+    errorString = QObject::tr("Invalid header in frame %1").arg(seq);
+    return false;
+  }
+
+  QBuffer buffer(&header);
+  buffer.open(QIODevice::ReadOnly);
+  data = SimConnectData();
+  if(!data.read(&buffer))
+  {
+    errorString = QObject::tr("Cannot read packet in frame %1: %2").arg(seq).arg(data.getStatusText());
+    return false;
+  }
+
+  // Read AI records =========================
+  quint32 num;
+  in >> num;
+
+  // Do not trust the count before reserving - each record needs at least id and type
+  if(in.status() != QDataStream::Ok || num > in.device()->bytesAvailable() / MIN_AI_RECORD_SIZE)
+  {
+    errorString = QObject::tr("Invalid frame %1").arg(seq);
+    return false;
+  }
+
+  QVector<SimConnectAircraft>& aiAircraft = data.getAiAircraft();
+  aiAircraft.reserve(static_cast<int>(num));
+  QHash<int, QByteArray> aircraft;
+  aircraft.reserve(static_cast<int>(num));
+  for(quint32 i = 0; i < num; i++)
+  {
+    qint32 id;
+    in >> id;
+    QByteArray record;
+    if(in.status() != QDataStream::Ok || !readRecord(in, lastAircraft.value(id), record))
+    {
+      errorString = QObject::tr("Invalid AI record %1 in frame %2").arg(id).arg(seq);
+      return false;
+    }
+
+    SimConnectAircraft ac;
+    QDataStream recordStream(record);
+    initStream(recordStream);
+    ac.read(recordStream);
+    if(recordStream.status() != QDataStream::Ok)
+    {
+      errorString = QObject::tr("Invalid AI record %1 in frame %2").arg(id).arg(seq);
+      return false;
+    }
+    aiAircraft.append(ac);
+    aircraft.insert(id, record);
+  }
+
+  lastHeader = header;
+  lastAircraft.swap(aircraft);
+  sequence = seq;
+  return true;
+}
+
+void Decoder::reset()
+{
+  lastHeader.clear();
+  lastAircraft.clear();
+  sequence = 0;
+  hasKeyframe = false;
+  errorString.clear();
+}
+
+// =======================================================================================
+void benchmark(const QString& replayFilename)
+{
+  SimDataReplay replay;
+  if(!replay.open(replayFilename))
+    return;
+
+  // Keep original serialized packets for verification
+  QVector<SimConnectData> packets;
+  QVector<QByteArray> packetBytes;
+  SimConnectData data;
+  qint64 timestampMs;
+  while(replay.readNext(data, timestampMs))
+  {
+    QByteArray bytes;
+    QBuffer buffer(&bytes);
+    buffer.open(QIODevice::WriteOnly);
+    data.write(&buffer);
+
+    packets.append(data);
+    packetBytes.append(bytes);
+  }
+
+  if(packets.isEmpty())
+    return;
+
+  qInfo() << Q_FUNC_INFO << "Benchmark start" << replayFilename << packets.size() << "packets";
+
+  enum Mode
+  {
+    LEGACY,
+    DELTA_PLAIN,
+    DELTA_COMPRESSED
+  };
+
+  for(Mode mode : {LEGACY, DELTA_PLAIN, DELTA_COMPRESSED})
+  {
+    Encoder encoder;
+    encoder.setCompression(mode == DELTA_COMPRESSED);
+    Decoder decoder;
+
+    qint64 bytesTotal = 0, encodeNs = 0, decodeNs = 0;
+    int errors = 0;
+    QElapsedTimer timer;
+
+    // Loopback buffer which is written by the sender and read by the receiver
+    QBuffer loopback;
+    loopback.open(QIODevice::ReadWrite);
+
+    for(int i = 0; i < packets.size(); i++)
+    {
+      loopback.buffer().clear();
+      loopback.seek(0);
+
+      // Send =====================================
+      timer.start();
+      if(mode == LEGACY)
+      {
+        SimConnectData copy(packets.at(i));
+        copy.write(&loopback);
+      }
+      else
+        loopback.write(encoder.encode(packets.at(i)));
+      encodeNs += timer.nsecsElapsed();
+      bytesTotal += loopback.size();
+      loopback.seek(0);
+
+      // Receive =====================================
+      timer.start();
+      SimConnectData received;
+      QByteArray frame;
+      ReadStatus status = readFrame(&loopback, frame);
+      bool ok;
+      if(mode == LEGACY)
+        ok = status == FRAME_LEGACY && received.read(&loopback);
+      else
+        ok = status == FRAME_OK && decoder.decode(frame, received);
+      decodeNs += timer.nsecsElapsed();
+
+      // Verify by comparing the serialized packets =====================================
+      if(ok)
+      {
+        QByteArray bytes;
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        received.write(&buffer);
+        ok = bytes == packetBytes.at(i);
+      }
+
+      if(!ok)
+      {
+        if(errors == 0)
+          qWarning() << Q_FUNC_INFO << "Packet" << i << "differs" << decoder.getErrorString();
+        errors++;
+      }
+    }
+
+    int num = packets.size();
+    qInfo().noquote().nospace() << (mode == LEGACY ? "Legacy" : (mode == DELTA_PLAIN ? "Delta" : "Delta zlib"))
+                                << ": total " << bytesTotal / 1024 << " kB"
+                                << ", average " << bytesTotal / num << " bytes"
+                                << ", encode " << encodeNs / num / 1000 << " us"
+                                << ", decode " << decodeNs / num / 1000 << " us"
+                                << ", errors " << errors;
+  }
+  qInfo() << Q_FUNC_INFO << "Benchmark done";
+}
+
+} // namespace simdelta
@@ -0,0 +1,151 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_SIMDATADELTA_H
+#define LNM_SIMDATADELTA_H
+
+#include <QByteArray>
+#include <QHash>
+
+class QIODevice;
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+namespace simdelta {
+
+/* Protocol extension for network connections to Little Navconnect.
+ *
+ * All frames start with MAGIC which is different from the magic number of the legacy SimConnectData packet.
+ * This allows to mix legacy packets and frames on the same connection.
+ *
+ * Frame: MAGIC, size of the following bytes, VERSION, FrameType, FrameFlags, sequence number, payload byte array
+ *
+ * Negotiation: The client sends HELLO with the requested flags. A server supporting the extension answers with
+ * ACK and the accepted flags and sends only KEYFRAME and DELTA frames afterwards. A server not supporting it
+ * never answers and the client continues to read legacy packets. Legacy servers may close the connection on
+ * HELLO, therefore the client sends it only if enabled in the configuration.
+ *
+ * Payload of KEYFRAME and DELTA: SimConnectData without AI as record, number of AI records and for each
+ * object id and record. A record is either unchanged, complete or a byte difference to the record
+ * with the same id in the previous frame. KEYFRAME resets the state of the decoder and contains complete
+ * records only. */
+const quint32 MAGIC = 0x444d4e4c; /* LNMD */
+const quint8 VERSION = 1;
+
+/* Size of magic and frame size */
+const qint64 FRAME_HEADER_SIZE = 8;
+
+enum FrameType : quint8
+{
+  HELLO = 1,
+  ACK = 2,
+  KEYFRAME = 3,
+  DELTA = 4
+};
+
+enum FrameFlag : quint8
+{
+  NONE = 0,
+  COMPRESSED = 1 << 0 /* Negotiation: zlib compression requested/accepted. Data: payload is compressed */
+};
+
+enum ReadStatus
+{
+  FRAME_OK, /* Complete frame was read */
+  FRAME_INCOMPLETE, /* Not enough bytes available yet - nothing was read */
+  FRAME_LEGACY, /* Next bytes are a legacy SimConnectData packet - nothing was read */
+  FRAME_ERROR /* Invalid frame */
+};
+
+/* Check device for a complete frame and read it if available */
+ReadStatus readFrame(QIODevice *device, QByteArray& frame);
+
+/* Build negotiation frames */
+QByteArray helloFrame(quint8 flags);
+QByteArray ackFrame(quint8 flags);
+
+/* Get type and flags of a frame. Returns false if the frame is invalid. */
+bool frameType(const QByteArray& frame, FrameType& type, quint8& flags);
+
+/* Encodes SimConnectData into KEYFRAME and DELTA frames. Used on the server side and for the benchmark. */
+class Encoder
+{
+public:
+  /* Enable zlib compression of the payload */
+  void setCompression(bool value)
+  {
+    compression = value;
+  }
+
+  /* Send a keyframe after this number of deltas */
+  void setKeyframeInterval(int value)
+  {
+    keyframeInterval = value;
+  }
+
+  /* Build frame for the data packet. Data is not modified. */
+  QByteArray encode(const atools::fs::sc::SimConnectData& data);
+
+  /* Force a keyframe for the next packet */
+  void reset();
+
+private:
+  QByteArray lastHeader;
+  QHash<int, QByteArray> lastAircraft;
+  quint32 sequence = 0;
+  int deltasSinceKeyframe = 0, keyframeInterval = 50;
+  bool compression = false, keyframeNeeded = true;
+};
+
+/* Decodes KEYFRAME and DELTA frames back into SimConnectData. Used on the client side. */
+class Decoder
+{
+public:
+  /* Decode frame into data. Returns false and sets an error message if the frame is invalid or
+   * does not fit the previous frame. */
+  bool decode(const QByteArray& frame, atools::fs::sc::SimConnectData& data);
+
+  /* Clear state. A keyframe is required afterwards. */
+  void reset();
+
+  const QString& getErrorString() const
+  {
+    return errorString;
+  }
+
+private:
+  QByteArray lastHeader;
+  QHash<int, QByteArray> lastAircraft;
+  quint32 sequence = 0;
+  bool hasKeyframe = false;
+  QString errorString;
+};
+
+/* Loopback test harness. Reads all packets of a recording made by SimDataRecorder, sends them through a buffer
+ * as legacy packets, as delta frames and as compressed delta frames and reads them back. Verifies that all
+ * decoded packets are equal to the original and logs bytes and CPU time per update. */
+void benchmark(const QString& replayFilename);
+
+} // namespace simdelta
+
+#endif // LNM_SIMDATADELTA_H
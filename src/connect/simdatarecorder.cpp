@@ -0,0 +1,123 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdatarecorder.h"
+
+#include "fs/sc/simconnectdata.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+
+SimDataRecorder::SimDataRecorder()
+{
+  qDebug() << Q_FUNC_INFO;
+}
+
+SimDataRecorder::~SimDataRecorder()
+{
+  qDebug() << Q_FUNC_INFO;
+  close();
+}
+
+bool SimDataRecorder::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    QDataStream out(&file);
+    out << simrec::MAGIC << simrec::VERSION;
+
+    timer.start();
+    block.clear();
+    index.clear();
+    blockPackets = numPackets = 0;
+    blockFirstMs = lastMs = 0L;
+
+    qInfo() << Q_FUNC_INFO << "Recording simulator data to" << filename;
+    return true;
+  }
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+}
+
+void SimDataRecorder::close()
+{
+  if(file.isOpen())
+  {
+    writeBlock();
+
+    // Write index and footer to allow seeking without scanning the whole file
+    qint64 indexOffset = file.pos();
+    QDataStream out(&file);
+    out << simrec::INDEX_MAGIC << static_cast<quint32>(index.size());
+    for(const simrec::BlockIndex& idx : index)
+      out << idx.offset << idx.firstTimestampMs;
+    out << indexOffset << simrec::FOOTER_MAGIC;
+
+    qInfo() << Q_FUNC_INFO << "Recorded" << numPackets << "packets in" << index.size() << "blocks"
+             << file.size() / 1024 << "kB to" << file.fileName();
+    file.close();
+  }
+}
+
+void SimDataRecorder::write(atools::fs::sc::SimConnectData& data)
+{
+  if(!file.isOpen())
+    return;
+
+  qint64 now = timer.elapsed();
+  if(blockPackets > 0 && (blockPackets >= MAX_BLOCK_PACKETS || now - blockFirstMs > MAX_BLOCK_SPAN_MS))
+    writeBlock();
+
+  if(blockPackets == 0)
+    // Timestamps in a block are relative to its first packet
+    blockFirstMs = lastMs = now;
+
+  // Serialize packet using the network protocol of Little Navconnect
+  QByteArray bytes;
+  QBuffer buffer(&bytes);
+  buffer.open(QIODevice::WriteOnly);
+  data.write(&buffer);
+  buffer.close();
+
+  QDataStream out(&block, QIODevice::WriteOnly | QIODevice::Append);
+  out << static_cast<quint32>(now - lastMs) << bytes;
+
+  lastMs = now;
+  blockPackets++;
+  numPackets++;
+}
+
+void SimDataRecorder::writeBlock()
+{
+  if(blockPackets == 0)
+    return;
+
+  index.append({file.pos(), blockFirstMs});
+
+  QDataStream out(&file);
+  out << simrec::BLOCK_MAGIC << blockFirstMs << lastMs << static_cast<quint32>(blockPackets) << qCompress(block);
+
+  block.clear();
+  blockPackets = 0;
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_SIMDATARECORDER_H
+#define LNM_SIMDATARECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+namespace simrec {
+
+/* File layout:
+ * Header: MAGIC, VERSION
+ * Blocks: BLOCK_MAGIC, first and last timestamp in ms, number of packets, compressed packets as byte array
+ *         Packets inside the block: timestamp delta to previous packet in ms, size and serialized SimConnectData
+ * Index: INDEX_MAGIC, number of blocks and offset and first timestamp for each block
+ * Footer: offset of index and FOOTER_MAGIC
+ * The index is written on close. Files without index are scanned block by block when opening. */
+const quint32 MAGIC = 0x524d4e4c; /* LNMR */
+const quint16 VERSION = 1;
+const quint32 BLOCK_MAGIC = 0x4b4c4252; /* RBLK */
+const quint32 INDEX_MAGIC = 0x58444952; /* RIDX */
+const quint32 FOOTER_MAGIC = 0x52544f46; /* FOTR */
+
+/* Byte size of footer at end of file */
+const qint64 FOOTER_SIZE = 12;
+
+struct BlockIndex
+{
+  qint64 offset, firstTimestampMs;
+};
+
+}
+
+/*
+ * Writes the stream of simulator data packets to a compact binary file which can be replayed by SimDataReplay.
+ *
+ * Packets are collected into blocks which are compressed as a whole. Consecutive packets differ only in a few
+ * values, so the compression removes most of the redundancy. Blocks are limited by packet number and time span
+ * to keep seeking cheap.
+ */
+class SimDataRecorder
+{
+public:
+  SimDataRecorder();
+  ~SimDataRecorder();
+
+  /* Create or overwrite file and start recording. Returns false if file cannot be opened. */
+  bool open(const QString& filename);
+
+  /* Write remaining packets and the index and close the file */
+  void close();
+
+  bool isOpen() const
+  {
+    return file.isOpen();
+  }
+
+  /* Add a packet with the current time since opening. Data is not modified. */
+  void write(atools::fs::sc::SimConnectData& data);
+
+  int getNumPackets() const
+  {
+    return numPackets;
+  }
+
+private:
+  void writeBlock();
+
+  /* Maximum number of packets and time span in one block */
+  static Q_DECL_CONSTEXPR int MAX_BLOCK_PACKETS = 200;
+  static Q_DECL_CONSTEXPR qint64 MAX_BLOCK_SPAN_MS = 10000L;
+
+  QFile file;
+  QElapsedTimer timer;
+
+  /* Uncompressed packets of current block */
+  QByteArray block;
+  int blockPackets = 0, numPackets = 0;
+  qint64 blockFirstMs = 0L, lastMs = 0L;
+
+  QVector<simrec::BlockIndex> index;
+};
+
+#endif // LNM_SIMDATARECORDER_H
@@ -0,0 +1,287 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdatareplay.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+
+#include <algorithm>
+
+SimDataReplay::SimDataReplay(QObject *parent)
+  : QObject(parent)
+{
+  qDebug() << Q_FUNC_INFO;
+
+  replayTimer.setSingleShot(true);
+  replayTimer.setTimerType(Qt::PreciseTimer);
+  connect(&replayTimer, &QTimer::timeout, this, &SimDataReplay::replayTimeout);
+}
+
+SimDataReplay::~SimDataReplay()
+{
+  qDebug() << Q_FUNC_INFO;
+  close();
+}
+
+bool SimDataReplay::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return false;
+  }
+
+  QDataStream in(&file);
+  quint32 magic;
+  quint16 version;
+  in >> magic >> version;
+  if(magic != simrec::MAGIC || version != simrec::VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid file" << filename << "magic" << magic << "version" << version;
+    file.close();
+    return false;
+  }
+
+  if(!readIndex())
+  {
+    // Recording was not closed properly
+    qWarning() << Q_FUNC_INFO << "No index in" << filename << "- scanning";
+    scanBlocks();
+  }
+
+  // Get time of last packet from last block header
+  // Recorder time starts when the file is opened and not with the first packet - use first block as base
+  durationMs = firstTimestampMs = 0L;
+  if(!index.isEmpty())
+  {
+    qint64 firstMs;
+    quint32 numPackets;
+    file.seek(index.last().offset);
+    readBlock(firstMs, durationMs, numPackets, nullptr);
+
+    firstTimestampMs = index.first().firstTimestampMs;
+    durationMs -= firstTimestampMs;
+  }
+
+  seek(0L);
+
+  qInfo() << Q_FUNC_INFO << filename << "blocks" << index.size() << "duration" << durationMs / 1000 << "s";
+  return true;
+}
+
+void SimDataReplay::close()
+{
+  stop();
+  file.close();
+  index.clear();
+  packets.clear();
+  currentBlock = -1;
+  currentPacket = 0;
+  durationMs = firstTimestampMs = 0L;
+}
+
+bool SimDataReplay::readIndex()
+{
+  index.clear();
+
+  qint64 headerSize = file.pos();
+  if(file.size() < headerSize + simrec::FOOTER_SIZE)
+    return false;
+
+  QDataStream in(&file);
+  file.seek(file.size() - simrec::FOOTER_SIZE);
+  qint64 indexOffset;
+  quint32 magic;
+  in >> indexOffset >> magic;
+  if(magic != simrec::FOOTER_MAGIC || indexOffset < headerSize || indexOffset >= file.size())
+    return false;
+
+  file.seek(indexOffset);
+  quint32 numBlocks;
+  in >> magic >> numBlocks;
+  if(magic != simrec::INDEX_MAGIC)
+    return false;
+
+  for(quint32 i = 0; i < numBlocks && in.status() == QDataStream::Ok; i++)
+  {
+    simrec::BlockIndex idx;
+    in >> idx.offset >> idx.firstTimestampMs;
+    index.append(idx);
+  }
+  return in.status() == QDataStream::Ok;
+}
+
+void SimDataReplay::scanBlocks()
+{
+  index.clear();
+
+  // Start after header
+  file.seek(sizeof(simrec::MAGIC) + sizeof(simrec::VERSION));
+  while(!file.atEnd())
+  {
+    qint64 offset = file.pos(), firstMs, lastMs;
+    quint32 numPackets;
+    QByteArray compressed;
+    if(!readBlock(firstMs, lastMs, numPackets, &compressed))
+      // Index or truncated block
+      break;
+    index.append({offset, firstMs});
+  }
+}
+
+bool SimDataReplay::readBlock(qint64& firstMs, qint64& lastMs, quint32& numPackets, QByteArray *compressed)
+{
+  QDataStream in(&file);
+  quint32 magic;
+  in >> magic;
+  if(magic != simrec::BLOCK_MAGIC)
+    return false;
+
+  in >> firstMs >> lastMs >> numPackets;
+  if(compressed != nullptr)
+    in >> *compressed;
+  return in.status() == QDataStream::Ok;
+}
+
+bool SimDataReplay::loadBlock(int blockIndex)
+{
+  packets.clear();
+  currentPacket = 0;
+  currentBlock = blockIndex;
+
+  if(blockIndex < 0 || blockIndex >= index.size())
+    return false;
+
+  file.seek(index.at(blockIndex).offset);
+  qint64 firstMs, lastMs;
+  quint32 numPackets;
+  QByteArray compressed;
+  if(!readBlock(firstMs, lastMs, numPackets, &compressed))
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading block" << blockIndex;
+    return false;
+  }
+
+  QByteArray block = qUncompress(compressed);
+  QDataStream in(&block, QIODevice::ReadOnly);
+
+  // Accumulate time deltas
+  qint64 timestampMs = firstMs;
+  packets.reserve(static_cast<int>(numPackets));
+  for(quint32 i = 0; i < numPackets && in.status() == QDataStream::Ok; i++)
+  {
+    quint32 delta;
+    Packet packet;
+    in >> delta >> packet.bytes;
+    timestampMs += delta;
+    packet.timestampMs = timestampMs;
+    packets.append(packet);
+  }
+  return true;
+}
+
+bool SimDataReplay::readNext(atools::fs::sc::SimConnectData& data, qint64& timestampMs)
+{
+  while(currentPacket >= packets.size())
+  {
+    // Block exhausted - load next one
+    if(currentBlock + 1 >= index.size() || !loadBlock(currentBlock + 1))
+      return false;
+  }
+
+  const Packet& packet = packets.at(currentPacket++);
+  timestampMs = packet.timestampMs - firstTimestampMs;
+
+  // Shallow copy of the implicitly shared bytes
+  QBuffer buffer;
+  buffer.setData(packet.bytes);
+  buffer.open(QIODevice::ReadOnly);
+  data = atools::fs::sc::SimConnectData();
+  return data.read(&buffer);
+}
+
+void SimDataReplay::seek(qint64 timestampMs)
+{
+  // Convert to recorder time
+  timestampMs += firstTimestampMs;
+
+  // Find last block starting before or at the requested time
+  auto it = std::upper_bound(index.constBegin(), index.constEnd(), timestampMs,
+                             [](qint64 ts, const simrec::BlockIndex& idx) -> bool
+  {
+    return ts < idx.firstTimestampMs;
+  });
+  int blockIndex = std::max(0, static_cast<int>(it - index.constBegin()) - 1);
+
+  if(loadBlock(blockIndex))
+  {
+    while(currentPacket < packets.size() && packets.at(currentPacket).timestampMs < timestampMs)
+      currentPacket++;
+  }
+}
+
+void SimDataReplay::start(float speed)
+{
+  stop();
+  replaySpeed = std::max(speed, 0.01f);
+
+  if(readNext(nextData, nextTimestampMs))
+  {
+    replayStartMs = nextTimestampMs;
+    replaySkippedMs = 0L;
+    replayClock.start();
+    replayTimer.start(0);
+  }
+  else
+    emit replayFinished();
+}
+
+void SimDataReplay::stop()
+{
+  replayTimer.stop();
+}
+
+void SimDataReplay::replayTimeout()
+{
+  qint64 sentTimestampMs = nextTimestampMs;
+  emit simDataReplayed(nextData);
+
+  if(readNext(nextData, nextTimestampMs))
+  {
+    // Do not wait for gaps like between simulator sessions in real time
+    qint64 gapMs = nextTimestampMs - sentTimestampMs;
+    if(gapMs > MAX_REPLAY_GAP_MS)
+    {
+      qDebug() << Q_FUNC_INFO << "Skipping gap of" << gapMs / 1000 << "s at" << sentTimestampMs / 1000 << "s";
+      replaySkippedMs += gapMs - MAX_REPLAY_GAP_MS;
+    }
+
+    // Schedule relative to start of playback to avoid accumulating timer drift
+    qint64 dueMs = static_cast<qint64>((nextTimestampMs - replayStartMs - replaySkippedMs) / replaySpeed);
+    replayTimer.start(static_cast<int>(std::max(dueMs - replayClock.elapsed(), static_cast<qint64>(0))));
+  }
+  else
+  {
+    qInfo() << Q_FUNC_INFO << "Replay finished";
+    emit replayFinished();
+  }
+}
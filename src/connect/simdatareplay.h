@@ -0,0 +1,127 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_SIMDATAREPLAY_H
+#define LNM_SIMDATAREPLAY_H
+
+#include "connect/simdatarecorder.h"
+#include "fs/sc/simconnectdata.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+/*
+ * Reads files written by SimDataRecorder and plays them back at real or accelerated speed.
+ *
+ * All timestamps are relative to the first packet of the recording. Playback is scheduled against a clock
+ * started with the replay to avoid accumulating timer drift. Gaps longer than MAX_REPLAY_GAP_MS, like between
+ * simulator sessions, are shortened.
+ *
+ * Packets can also be read sequentially without timer. Seeking uses the block index
+ * and decompresses only the block containing the requested time.
+ */
+class SimDataReplay :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit SimDataReplay(QObject *parent = nullptr);
+  virtual ~SimDataReplay() override;
+
+  /* Open file and read or rebuild the block index. Returns false if the file cannot be read. */
+  bool open(const QString& filename);
+  void close();
+
+  bool isOpen() const
+  {
+    return file.isOpen();
+  }
+
+  /* Read next packet and its timestamp in milliseconds since the first packet. Returns false at end of file. */
+  bool readNext(atools::fs::sc::SimConnectData& data, qint64& timestampMs);
+
+  /* Position before first packet at or after timestampMs */
+  void seek(qint64 timestampMs);
+
+  /* Time of the last packet in milliseconds since the first packet */
+  qint64 getDurationMs() const
+  {
+    return durationMs;
+  }
+
+  /* Start playback from current position. speed 1 is real time, 10 is ten times faster. */
+  void start(float speed);
+  void stop();
+
+  bool isPlaying() const
+  {
+    return replayTimer.isActive();
+  }
+
+signals:
+  /* Emitted for each packet during playback */
+  void simDataReplayed(atools::fs::sc::SimConnectData data);
+
+  /* Emitted after the last packet was sent */
+  void replayFinished();
+
+private:
+  struct Packet
+  {
+    qint64 timestampMs;
+    QByteArray bytes;
+  };
+
+  /* Read block header at current file position. Does not decompress. */
+  bool readBlock(qint64& firstMs, qint64& lastMs, quint32& numPackets, QByteArray *compressed);
+
+  bool readIndex();
+  void scanBlocks();
+  bool loadBlock(int blockIndex);
+  void replayTimeout();
+
+  /* Gaps between two packets longer than this are shortened to this value on playback */
+  static const qint64 MAX_REPLAY_GAP_MS = 5000L;
+
+  QFile file;
+  QVector<simrec::BlockIndex> index;
+  qint64 durationMs = 0L;
+
+  /* Recorder time of the first packet. Subtracted from all timestamps. */
+  qint64 firstTimestampMs = 0L;
+
+  /* Decompressed packets of current block */
+  QVector<Packet> packets;
+  int currentBlock = -1, currentPacket = 0;
+
+  QTimer replayTimer;
+  float replaySpeed = 1.f;
+
+  /* Started with playback. Packets are scheduled against this clock and not relative to the previous one. */
+  QElapsedTimer replayClock;
+
+  /* Timestamp of the first packet played and sum of all gap time skipped since */
+  qint64 replayStartMs = 0L, replaySkippedMs = 0L;
+
+  /* Packet to be sent on next timer event */
+  atools::fs::sc::SimConnectData nextData;
+  qint64 nextTimestampMs = 0L;
+};
+
+#endif // LNM_SIMDATAREPLAY_H
@@ -23,6 +23,7 @@
 #include "common/constants.h"
 #include "fs/db/databasemeta.h"
 #include "db/databasedialog.h"
+#include "db/databasepool.h"
 #include "settings/settings.h"
 #include "fs/navdatabaseoptions.h"
 #include "fs/navdatabaseprogress.h"
@@ -47,9 +48,12 @@
 #include "track/trackmanager.h"
 #include "util/version.h"
 #include "fs/navdatabaseerrors.h"
+#include "common/startuptrace.h"
 
 #include <QElapsedTimer>
 #include <QDir>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QSettings>
 
 using atools::gui::ErrorHandler;
@@ -70,6 +74,8 @@ const int MAX_TEXT_LENGTH = 120;
 DatabaseManager::DatabaseManager(MainWindow *parent)
   : QObject(parent), mainWindow(parent)
 {
+  databasePool = new DatabasePool;
+
   databaseMetaText = QObject::tr(
     "<p><big>Last Update: %1. Database Version: %2.%3. Program Version: %4.%5.%6</big></p>");
 
@@ -272,6 +278,9 @@ DatabaseManager::~DatabaseManager()
   closeUserAirspaceDatabase();
   closeOnlineDatabase();
 
+  // Close pooled connections of this thread before the drivers are removed
+  delete databasePool;
+
   delete databaseSim;
   delete databaseNav;
   delete databaseMora;
@@ -918,6 +927,73 @@ void DatabaseManager::openAllDatabases()
 
   openDatabaseFile(databaseSimAirspace, simAirspaceDbFile, true /* readonly */, true /* createSchema */);
   openDatabaseFile(databaseNavAirspace, navAirspaceDbFile, true /* readonly */, true /* createSchema */);
+
+  if(mainWindow != nullptr)
+    startDatabaseWarmup();
+}
+
+void DatabaseManager::startDatabaseWarmup()
+{
+  stopDatabaseWarmup();
+
+  qint64 maxMb = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_DATABASE_WARMUP_MB,
+                                                                        DATABASE_WARMUP_DEFAULT_MB).toLongLong();
+  if(maxMb <= 0)
+    return;
+
+  // Collect files without duplicates since airspace and MORA connections use the same files
+  QStringList files;
+  for(const SqlDatabase *db : {databaseSim, databaseNav, databaseSimAirspace, databaseNavAirspace})
+  {
+    if(db != nullptr && db->isOpen() && !files.contains(db->databaseName()))
+      files.append(db->databaseName());
+  }
+
+  warmupAbort = false;
+  warmupFuture = QtConcurrent::run(this, &DatabaseManager::databaseWarmupThread, files, maxMb * 1024LL * 1024LL);
+}
+
+void DatabaseManager::stopDatabaseWarmup()
+{
+  warmupAbort = true;
+  warmupFuture.waitForFinished();
+}
+
+void DatabaseManager::databaseWarmupThread(const QStringList& files, qint64 maxBytes)
+{
+  QThread::currentThread()->setPriority(QThread::LowestPriority);
+  startuptrace::Phase trace("Database file warmup");
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Plain sequential reads are much faster than the random access done by SQLite on a cold cache
+  QByteArray buffer(static_cast<int>(DATABASE_WARMUP_BUFFER_BYTES), '\0');
+  qint64 totalBytes = 0;
+  for(const QString& filename : files)
+  {
+    QFile file(filename);
+    if(file.open(QIODevice::ReadOnly))
+    {
+      // Limit is shared by all files
+      while(!warmupAbort && totalBytes < maxBytes)
+      {
+        qint64 bytesRead = file.read(buffer.data(), buffer.size());
+        if(bytesRead <= 0)
+          break;
+        totalBytes += bytesRead;
+      }
+      file.close();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+
+    if(warmupAbort || totalBytes >= maxBytes)
+      break;
+  }
+
+  qDebug() << Q_FUNC_INFO << files << "read" << totalBytes / 1024 / 1024 << "MB in" << timer.elapsed() << "ms"
+           << (warmupAbort ? "(aborted)" : QString());
 }
 
 void DatabaseManager::openDatabaseFile(atools::sql::SqlDatabase *db, const QString& file, bool readonly,
@@ -1015,6 +1091,13 @@ void DatabaseManager::openDatabaseFileInternal(atools::sql::SqlDatabase *db, con
 
 void DatabaseManager::closeAllDatabases()
 {
+  // Release file handles before databases are replaced
+  stopDatabaseWarmup();
+
+  // Pooled connections of other threads are reopened on next use
+  databasePool->invalidate();
+  databasePool->logStatistics();
+
   closeDatabaseFile(databaseSim);
   closeDatabaseFile(databaseNav);
   closeDatabaseFile(databaseMora);
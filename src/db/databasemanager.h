@@ -22,8 +22,11 @@
 #include "db/dbtypes.h"
 
 #include <QAction>
+#include <QFuture>
 #include <QObject>
 
+#include <atomic>
+
 namespace atools {
 namespace sql {
 class SqlDatabase;
@@ -50,6 +53,7 @@ class QSplashScreen;
 class QMessageBox;
 class TrackManager;
 class DatabaseProgressDialog;
+class DatabasePool;
 
 namespace dm {
 enum NavdatabaseStatus
@@ -97,6 +101,15 @@ public:
    * Only for scenery database */
   void openAllDatabases();
 
+  /* Reads the simulator and navigation database files in a background thread to get them into the
+   * file system cache. This speeds up the first queries after startup or switching databases.
+   * Total size is limited by Options/DatabaseWarmupMb. 0 disables the warm-up.
+   * Only for instances created by the main window. Called by openAllDatabases(). */
+  void startDatabaseWarmup();
+
+  /* Stop the background reading and wait for the thread to finish. Called by closeAllDatabases(). */
+  void stopDatabaseWarmup();
+
   /* Open a writeable database for userpoints or online network data. Automatic transactions are off.  */
   void openWriteableDatabase(atools::sql::SqlDatabase *database, const QString& name, const QString& displayName,
                              bool backup);
@@ -201,6 +214,12 @@ public:
 
   atools::sql::SqlDatabase *getDatabaseOnline() const;
 
+  /* Per thread read only connections and prepared statements for background queries */
+  DatabasePool *getDatabasePool() const
+  {
+    return databasePool;
+  }
+
   /* Create an empty database schema. Boundary option does not use transaction. */
   void createEmptySchema(atools::sql::SqlDatabase *db, bool boundary = false);
 
@@ -225,6 +244,9 @@ private:
 
   void closeDatabaseFile(atools::sql::SqlDatabase *db);
 
+  /* Background thread for startDatabaseWarmup() */
+  void databaseWarmupThread(const QStringList& files, qint64 maxBytes);
+
   void restoreState();
 
   bool isDatabaseCompatible(atools::sql::SqlDatabase *db);
@@ -293,6 +315,14 @@ private:
   const QString DATABASE_NAME_DLG_INFO_TEMP = "LNMTEMPDB2";
   const QString DATABASE_TYPE = "QSQLITE";
 
+  /* Default for the number of megabytes read in total for all database files into the file system cache.
+   * Kept small to avoid pushing other data out of the cache. */
+  static Q_DECL_CONSTEXPR int DATABASE_WARMUP_DEFAULT_MB = 128;
+  static Q_DECL_CONSTEXPR qint64 DATABASE_WARMUP_BUFFER_BYTES = 1024LL * 1024LL;
+
+  QFuture<void> warmupFuture;
+  std::atomic_bool warmupAbort{false};
+
   DatabaseDialog *databaseDialog = nullptr;
   QString databaseDirectory;
   qint64 progressTimerElapsed = 0L;
@@ -344,6 +374,7 @@ private:
   atools::fs::userdata::LogdataManager *logdataManager = nullptr;
   atools::fs::online::OnlinedataManager *onlinedataManager = nullptr;
 
+  DatabasePool *databasePool = nullptr;
 };
 
 #endif // LITTLENAVMAP_DATABASEMANAGER_H
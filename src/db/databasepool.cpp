@@ -0,0 +1,172 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/databasepool.h"
+
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QThread>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+DatabasePool::DatabasePool()
+{
+  qDebug() << Q_FUNC_INFO;
+}
+
+DatabasePool::~DatabasePool()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  // Connections of other threads are closed when these exit
+  release();
+  logStatistics();
+}
+
+SqlDatabase *DatabasePool::getDatabase(const QString& filename)
+{
+  return connection(filename).db;
+}
+
+SqlDatabase *DatabasePool::getDatabase(const SqlDatabase *database)
+{
+  return connection(database->databaseName()).db;
+}
+
+SqlQuery *DatabasePool::getQuery(const QString& filename, const QString& queryStr)
+{
+  Connection& conn = connection(filename);
+
+  SqlQuery *query = conn.queries.value(queryStr, nullptr);
+  if(query == nullptr)
+  {
+    query = new SqlQuery(conn.db);
+    query->prepare(queryStr);
+    conn.queries.insert(queryStr, query);
+    numPrepared++;
+  }
+  else
+    numReused++;
+  return query;
+}
+
+void DatabasePool::release()
+{
+  if(threadConnections.hasLocalData())
+  {
+    ThreadConnections *data = threadConnections.localData();
+    for(Connection& conn : data->connections)
+      closeConnection(conn);
+    data->connections.clear();
+
+    // Deletes the data
+    threadConnections.setLocalData(nullptr);
+  }
+}
+
+void DatabasePool::invalidate()
+{
+  generation++;
+  release();
+
+  if(numOpen.load() > 0)
+    qWarning() << Q_FUNC_INFO << numOpen.load() << "connections still open in other threads."
+               << "These are closed on next use.";
+}
+
+void DatabasePool::logStatistics() const
+{
+  qDebug() << Q_FUNC_INFO << "connections opened" << numOpened.load() << "closed" << numClosed.load()
+           << "statements prepared" << numPrepared.load() << "reused" << numReused.load();
+}
+
+DatabasePool::Connection& DatabasePool::connection(const QString& filename)
+{
+  if(!threadConnections.hasLocalData())
+    threadConnections.setLocalData(new ThreadConnections(this));
+
+  ThreadConnections *data = threadConnections.localData();
+  if(data->generation != generation)
+  {
+    // Databases were replaced - close all connections of this thread, not only the requested one,
+    // to release the file handles of replaced databases
+    for(Connection& conn : data->connections)
+      closeConnection(conn);
+    data->connections.clear();
+    data->generation = generation;
+  }
+
+  Connection& conn = data->connections[filename];
+
+  if(conn.db == nullptr)
+  {
+    // Connection names have to be unique across all threads
+    conn.connectionName = QString("LNMDBPOOL%1").arg(connectionCounter++);
+
+    SqlDatabase::addDatabase("QSQLITE", conn.connectionName);
+    conn.db = new SqlDatabase(conn.connectionName);
+    conn.db->setDatabaseName(filename);
+    conn.db->setReadonly(true);
+
+    try
+    {
+      numOpen++;
+      numOpened++;
+      conn.db->open();
+    }
+    catch(...)
+    {
+      // Remove broken connection to try again on next call
+      closeConnection(conn);
+      data->connections.remove(filename);
+      throw;
+    }
+
+    qDebug() << Q_FUNC_INFO << "Opened" << conn.connectionName << filename << "in thread" << QThread::currentThread();
+  }
+  return conn;
+}
+
+void DatabasePool::closeConnection(Connection& connection)
+{
+  qDeleteAll(connection.queries);
+  connection.queries.clear();
+
+  if(connection.db != nullptr)
+  {
+    // Need to delete the database object before removing the driver
+    connection.db->close();
+    delete connection.db;
+    connection.db = nullptr;
+    SqlDatabase::removeDatabase(connection.connectionName);
+    numOpen--;
+    numClosed++;
+  }
+}
+
+DatabasePool::ThreadConnections::~ThreadConnections()
+{
+  // Connections are usually closed by release() - this is only reached if a thread exits without calling it
+  if(!connections.isEmpty())
+    qWarning() << Q_FUNC_INFO << connections.size() << "connections not released";
+
+  for(Connection& conn : connections)
+    pool->closeConnection(conn);
+}
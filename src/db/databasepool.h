@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_DATABASEPOOL_H
+#define LNM_DATABASEPOOL_H
+
+#include <QHash>
+#include <QThreadStorage>
+
+#include <atomic>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+}
+
+/*
+ * Hands out read only database connections and prepared statements for the calling thread.
+ *
+ * Connections cannot be shared between threads. Each thread gets its own connection for a database file
+ * which is opened on first use. Statements are prepared once per connection and kept until the connection
+ * is closed.
+ *
+ * invalidate() has to be called from the main thread before databases are replaced and after all background
+ * threads using the pool are finished. Connections of the main thread are closed immediately. A thread still
+ * holding connections of a previous generation closes all of them on its next call into the pool and never gets
+ * a stale handle. Background threads have to call release() when done to free the file handles.
+ *
+ * Users are the MORA grid reader and the airspace containment index builder. All other queries run in the
+ * main thread using the connections of the DatabaseManager.
+ */
+class DatabasePool
+{
+public:
+  DatabasePool();
+  ~DatabasePool();
+
+  /* Get a read only connection to the file for the calling thread. Opened on first use.
+   * Throws an exception if the database cannot be opened. */
+  atools::sql::SqlDatabase *getDatabase(const QString& filename);
+
+  /* Same as above for the file of an already opened connection */
+  atools::sql::SqlDatabase *getDatabase(const atools::sql::SqlDatabase *database);
+
+  /* Get a prepared statement for the calling thread. Statement is prepared on first use. Bound values and result
+   * of a previous use are kept, so call exec() before using the query. */
+  atools::sql::SqlQuery *getQuery(const QString& filename, const QString& queryStr);
+
+  /* Close all connections and statements of the calling thread */
+  void release();
+
+  /* Close connections of the calling thread and force all other threads to close theirs on next use.
+   * Prints a warning if other threads still have connections open. */
+  void invalidate();
+
+  /* Print number of opened connections, prepared statements and statement reuse to the log */
+  void logStatistics() const;
+
+private:
+  /* Connection and statements of one thread for one database file */
+  struct Connection
+  {
+    atools::sql::SqlDatabase *db = nullptr;
+    QHash<QString, atools::sql::SqlQuery *> queries;
+    QString connectionName;
+  };
+
+  /* Deleted when the thread exits */
+  struct ThreadConnections
+  {
+    explicit ThreadConnections(DatabasePool *poolParam)
+      : pool(poolParam)
+    {
+    }
+
+    ~ThreadConnections();
+
+    DatabasePool *pool;
+    QHash<QString, Connection> connections;
+
+    /* Generation of the pool when the connections were opened */
+    int generation = 0;
+  };
+
+  Connection& connection(const QString& filename);
+  void closeConnection(Connection& connection);
+
+  QThreadStorage<ThreadConnections *> threadConnections;
+
+  /* Incremented by invalidate() */
+  std::atomic_int generation{0};
+
+  /* Number of connections currently open in all threads */
+  std::atomic_int numOpen{0};
+
+  /* Statistics */
+  std::atomic_int numOpened{0}, numClosed{0}, numPrepared{0}, numReused{0}, connectionCounter{0};
+};
+
+#endif // LNM_DATABASEPOOL_H
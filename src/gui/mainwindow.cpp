@@ -29,6 +29,8 @@
 #include "route/routealtitude.h"
 #include "weather/weatherreporter.h"
 #include "connect/connectclient.h"
+#include "connect/simdatadelta.h"
+#include "connect/simdatareplay.h"
 #include "common/elevationprovider.h"
 #include "db/databasemanager.h"
 #include "gui/dialog.h"
@@ -61,6 +63,7 @@
 #include "common/unit.h"
 #include "fs/pln/flightplanio.h"
 #include "query/procedurequery.h"
+#include "query/procedurevalidation.h"
 #include "search/proceduresearch.h"
 #include "userdata/userdatacontroller.h"
 #include "online/onlinedatacontroller.h"
@@ -74,6 +77,7 @@
 #include "fs/perf/aircraftperf.h"
 #include "mapgui/imageexportdialog.h"
 #include "web/webcontroller.h"
+#include "common/startuptrace.h"
 #include "weather/windreporter.h"
 #include "logbook/logdatacontroller.h"
 #include "search/logdatasearch.h"
@@ -90,6 +94,7 @@
 #include <marble/HttpDownloadManager.h>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QCloseEvent>
 #include <QDesktopServices>
 #include <QFileInfo>
@@ -194,10 +199,12 @@ MainWindow::MainWindow()
     routeExport = new RouteExport(this);
 
     qDebug() << Q_FUNC_INFO << "Creating OptionsDialog";
+    startuptrace::begin("OptionsDialog");
     optionsDialog = new OptionsDialog(this);
     // Has to load the state now so options are available for all controller and manager classes
     optionsDialog->restoreState();
     optionsChanged();
+    startuptrace::end("OptionsDialog");
 
     // Dialog is opened with asynchronous open()
     connect(optionsDialog, &QDialog::finished, [ = ](int result) {
@@ -217,7 +224,9 @@ MainWindow::MainWindow()
     if(OptionData::instance().getFlags2().testFlag(opts2::MAP_ALLOW_UNDOCK))
       centralWidget()->hide();
 
+    startuptrace::begin("Setup UI");
     setupUi();
+    startuptrace::end("Setup UI");
 
     // Load all map feature colors
     mapcolors::syncColors();
@@ -232,7 +241,9 @@ MainWindow::MainWindow()
     // Prepare database and queries
     qDebug() << Q_FUNC_INFO << "Creating DatabaseManager";
 
+    startuptrace::begin("NavApp::init");
     NavApp::init(this);
+    startuptrace::end("NavApp::init");
 
     NavApp::getStyleHandler()->insertMenuItems(ui->menuWindowStyle);
     NavApp::getStyleHandler()->restoreState();
@@ -242,18 +253,22 @@ MainWindow::MainWindow()
     NavApp::getDatabaseManager()->insertSimSwitchActions();
 
     qDebug() << Q_FUNC_INFO << "Creating WeatherReporter";
+    startuptrace::begin("Weather and wind");
     weatherReporter = new WeatherReporter(this, NavApp::getCurrentSimulatorDb());
 
     qDebug() << Q_FUNC_INFO << "Creating WindReporter";
     windReporter = new WindReporter(this, NavApp::getCurrentSimulatorDb());
     windReporter->addToolbarButton();
+    startuptrace::end("Weather and wind");
 
     qDebug() << Q_FUNC_INFO << "Creating FileHistoryHandler for flight plans";
     routeFileHistory = new FileHistoryHandler(this, lnm::ROUTE_FILENAMES_RECENT, ui->menuRecentRoutes,
                                               ui->actionRecentRoutesClear);
 
     qDebug() << Q_FUNC_INFO << "Creating RouteController";
+    startuptrace::begin("RouteController");
     routeController = new RouteController(this, ui->tableViewRoute);
+    startuptrace::end("RouteController");
 
     qDebug() << Q_FUNC_INFO << "Creating FileHistoryHandler for KML files";
     kmlFileHistory = new FileHistoryHandler(this, lnm::ROUTE_FILENAMESKML_RECENT, ui->menuRecentKml,
@@ -265,6 +280,7 @@ MainWindow::MainWindow()
 
     // Create map widget and replace dummy widget in window
     qDebug() << Q_FUNC_INFO << "Creating MapWidget";
+    startuptrace::begin("MapWidget");
     mapWidget = new MapWidget(this);
     if(OptionData::instance().getFlags2() & opts2::MAP_ALLOW_UNDOCK)
     {
@@ -277,16 +293,23 @@ MainWindow::MainWindow()
       ui->dockWidgetMap->hide();
     }
 
+    startuptrace::end("MapWidget");
+
+    startuptrace::begin("Elevation provider");
     NavApp::initElevationProvider();
+    startuptrace::end("Elevation provider");
 
     // Create elevation profile widget and replace dummy widget in window
     qDebug() << Q_FUNC_INFO << "Creating ProfileWidget";
+    startuptrace::begin("ProfileWidget");
     profileWidget = new ProfileWidget(ui->scrollAreaProfile->viewport());
     ui->scrollAreaProfile->setWidget(profileWidget);
     profileWidget->show();
+    startuptrace::end("ProfileWidget");
 
     // Have to create searches in the same order as the tabs
     qDebug() << Q_FUNC_INFO << "Creating SearchController";
+    startuptrace::begin("SearchController");
     searchController = new SearchController(this, ui->tabWidgetSearch);
     searchController->createAirportSearch(ui->tableViewAirportSearch);
     searchController->createNavSearch(ui->tableViewNavSearch);
@@ -299,9 +322,12 @@ MainWindow::MainWindow()
     searchController->createOnlineClientSearch(ui->tableViewOnlineClientSearch);
     searchController->createOnlineCenterSearch(ui->tableViewOnlineCenterSearch);
     searchController->createOnlineServerSearch(ui->tableViewOnlineServerSearch);
+    startuptrace::end("SearchController");
 
     qDebug() << Q_FUNC_INFO << "Creating InfoController";
+    startuptrace::begin("InfoController");
     infoController = new InfoController(this);
+    startuptrace::end("InfoController");
 
     qDebug() << Q_FUNC_INFO << "Creating PrintSupport";
     printSupport = new PrintSupport(this);
@@ -320,7 +346,9 @@ MainWindow::MainWindow()
     NavApp::getUserdataController()->addToolbarButton();
 
     qDebug() << Q_FUNC_INFO << "Reading settings";
+    startuptrace::begin("Restore state");
     restoreStateMain();
+    startuptrace::end("Restore state");
 
     allowDockingWindows();
     updateActionStates();
@@ -331,10 +359,12 @@ MainWindow::MainWindow()
     updateOnlineActionStates();
 
     qDebug() << Q_FUNC_INFO << "Setting theme";
+    startuptrace::begin("Map theme and projection");
     changeMapTheme();
 
     qDebug() << Q_FUNC_INFO << "Setting projection";
     mapWidget->setProjection(mapProjectionComboBox->currentData().toInt());
+    startuptrace::end("Map theme and projection");
 
     // Wait until everything is set up and update map
     updateMapObjectsShown();
@@ -418,6 +448,8 @@ MainWindow::~MainWindow()
   delete weatherReporter;
   qDebug() << Q_FUNC_INFO << "delete windReporter";
   delete windReporter;
+  qDebug() << Q_FUNC_INFO << "delete procedureValidation";
+  delete procedureValidation;
   qDebug() << Q_FUNC_INFO << "delete profileWidget";
   delete profileWidget;
   qDebug() << Q_FUNC_INFO << "delete marbleAbout";
@@ -956,6 +988,7 @@ void MainWindow::connectAllSlots()
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, routeController, &RouteController::styleChanged);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, searchController, &SearchController::styleChanged);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, mapWidget, &MapPaintWidget::styleChanged);
+  connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, mapWidget, &MapWidget::clearTooltipCache);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, profileWidget, &ProfileWidget::styleChanged);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged,
           NavApp::getAircraftPerfController(), &AircraftPerfController::optionsChanged);
@@ -988,6 +1021,7 @@ void MainWindow::connectAllSlots()
   connect(routeController, &RouteController::showPos, mapWidget, &MapPaintWidget::showPos);
   connect(routeController, &RouteController::changeMark, mapWidget, &MapWidget::changeSearchMark);
   connect(routeController, &RouteController::routeChanged, mapWidget, &MapPaintWidget::routeChanged);
+  connect(routeController, &RouteController::routeChanged, mapWidget, &MapWidget::clearTooltipCache);
   connect(routeController, &RouteController::routeAltitudeChanged, mapWidget, &MapPaintWidget::routeAltitudeChanged);
   connect(routeController, &RouteController::preRouteCalc, profileWidget, &ProfileWidget::preRouteCalc);
   connect(routeController, &RouteController::showInformation, infoController, &InfoController::showInformation);
@@ -1386,6 +1420,9 @@ void MainWindow::connectAllSlots()
   connect(airspaceController, &AirspaceController::updateAirspaceTypes, this, &MainWindow::updateAirspaceTypes);
   connect(airspaceController, &AirspaceController::userAirspacesUpdated,
           NavApp::getOnlinedataController(), &OnlinedataController::userAirspacesUpdated);
+  connect(airspaceController, &AirspaceController::userAirspacesUpdated, mapWidget, &MapWidget::clearTooltipCache);
+  connect(airspaceController, &AirspaceController::userAirspacesUpdated, mapWidget, &MapPaintWidget::airspacesUpdated);
+  connect(airspaceController, &AirspaceController::updateAirspaceSources, mapWidget, &MapPaintWidget::airspacesUpdated);
 
   // Connect airspace manger signals to database manager signals
   connect(airspaceController, &AirspaceController::preDatabaseLoadAirspaces,
@@ -1402,6 +1439,8 @@ void MainWindow::connectAllSlots()
   connect(trackController, &TrackController::postTrackLoad, infoController, &InfoController::tracksChanged);
   connect(trackController, &TrackController::postTrackLoad, routeController, &RouteController::tracksChanged);
   connect(trackController, &TrackController::postTrackLoad, this, &MainWindow::updateMapObjectsShown);
+  connect(trackController, &TrackController::postTrackLoad, mapWidget, &MapWidget::clearTooltipCache);
+  connect(trackController, &TrackController::postTrackLoad, mapWidget, &MapPaintWidget::tracksUpdated);
 
   connect(ui->actionRouteDownloadTracks, &QAction::toggled, trackController, &TrackController::downloadToggled);
   connect(ui->actionRouteDownloadTracksNow, &QAction::triggered, trackController, &TrackController::startDownload);
@@ -1493,6 +1532,12 @@ void MainWindow::connectAllSlots()
   // Deliver first to route controller to update active leg and distances
   connect(connectClient, &ConnectClient::dataPacketReceived, routeController, &RouteController::simDataChanged);
 
+  // Update airspace containment before the information window shows it
+  connect(connectClient, &ConnectClient::dataPacketReceived,
+          NavApp::getAirspaceController(), &AirspaceController::simDataChanged);
+  connect(connectClient, &ConnectClient::disconnectedFromSimulator,
+          NavApp::getAirspaceController(), &AirspaceController::disconnectedFromSimulator);
+
   connect(connectClient, &ConnectClient::dataPacketReceived, mapWidget, &MapWidget::simDataChanged);
   connect(connectClient, &ConnectClient::dataPacketReceived, profileWidget, &ProfileWidget::simDataChanged);
   connect(connectClient, &ConnectClient::dataPacketReceived, infoController, &InfoController::simDataChanged);
@@ -1529,16 +1574,19 @@ void MainWindow::connectAllSlots()
   connect(mapWidget, &MapPaintWidget::aircraftTrackPruned, profileWidget, &ProfileWidget::aircraftTrackPruned);
 
   // Weather update ===================================================
+  connect(weatherReporter, &WeatherReporter::weatherUpdated, mapWidget, &MapWidget::clearTooltipCache);
   connect(weatherReporter, &WeatherReporter::weatherUpdated, mapWidget, &MapWidget::updateTooltip);
   connect(weatherReporter, &WeatherReporter::weatherUpdated, infoController, &InfoController::updateAirportWeather);
   connect(weatherReporter, &WeatherReporter::weatherUpdated, mapWidget, &MapPaintWidget::weatherUpdated);
 
   connect(connectClient, &ConnectClient::weatherUpdated, mapWidget, &MapPaintWidget::weatherUpdated);
+  connect(connectClient, &ConnectClient::weatherUpdated, mapWidget, &MapWidget::clearTooltipCache);
   connect(connectClient, &ConnectClient::weatherUpdated, mapWidget, &MapWidget::updateTooltip);
   connect(connectClient, &ConnectClient::weatherUpdated, infoController, &InfoController::updateAirportWeather);
 
   // Wind update ===================================================
   connect(windReporter, &WindReporter::windUpdated, routeController, &RouteController::windUpdated);
+  connect(windReporter, &WindReporter::windUpdated, mapWidget, &MapWidget::clearTooltipCache);
   connect(windReporter, &WindReporter::windUpdated, perfController, &AircraftPerfController::updateReports);
   connect(windReporter, &WindReporter::windUpdated, this, &MainWindow::updateMapObjectsShown);
   connect(windReporter, &WindReporter::windUpdated, this, &MainWindow::updateActionStates);
@@ -1554,6 +1602,12 @@ void MainWindow::connectAllSlots()
   connect(ui->actionOpenWebserver, &QAction::triggered, this, &MainWindow::openWebserver);
   connect(NavApp::getWebController(), &WebController::webserverStatusChanged,
           this, &MainWindow::webserverStatusChanged);
+  connect(connectClient, &ConnectClient::dataPacketReceived,
+          NavApp::getWebController(), &WebController::simDataChanged);
+  connect(connectClient, &ConnectClient::disconnectedFromSimulator,
+          NavApp::getWebController(), &WebController::disconnectedFromSimulator);
+  connect(routeController, &RouteController::routeChanged,
+          NavApp::getWebController(), &WebController::routeChanged);
 
   // Shortcut menu
   connect(ui->actionShortcutMap, &QAction::triggered,
@@ -2693,6 +2747,101 @@ void MainWindow::mapCopyToClipboard()
   }
 }
 
+void MainWindow::benchmarkSimDataReplay(const QString& filename)
+{
+  if(benchmarkReplay != nullptr)
+    return;
+
+  benchmarkReplay = new SimDataReplay(this);
+  if(!benchmarkReplay->open(filename))
+  {
+    delete benchmarkReplay;
+    benchmarkReplay = nullptr;
+    return;
+  }
+
+  // Same order as connected in connectAllSlots()
+  AirspaceController *airspaceController = NavApp::getAirspaceController();
+  AircraftPerfController *aircraftPerfController = NavApp::getAircraftPerfController();
+  WebController *webController = NavApp::getWebController();
+  benchmarkConsumers = {
+    {"RouteController", [ = ](const atools::fs::sc::SimConnectData& data) {
+       routeController->simDataChanged(data);
+     }, 0L, 0L},
+    {"AirspaceController", [ = ](const atools::fs::sc::SimConnectData& data) {
+       airspaceController->simDataChanged(data);
+     }, 0L, 0L},
+    {"MapWidget", [ = ](const atools::fs::sc::SimConnectData& data) {
+       mapWidget->simDataChanged(data);
+     }, 0L, 0L},
+    {"ProfileWidget", [ = ](const atools::fs::sc::SimConnectData& data) {
+       profileWidget->simDataChanged(data);
+     }, 0L, 0L},
+    {"InfoController", [ = ](const atools::fs::sc::SimConnectData& data) {
+       infoController->simDataChanged(data);
+     }, 0L, 0L},
+    {"AircraftPerfController", [ = ](const atools::fs::sc::SimConnectData& data) {
+       aircraftPerfController->simDataChanged(data);
+     }, 0L, 0L},
+    {"WebController", [ = ](const atools::fs::sc::SimConnectData& data) {
+       webController->simDataChanged(data);
+     }, 0L, 0L}
+  };
+  benchmarkPackets = 0;
+
+  // Consumers like InfoController and WebController throttle updates by wall clock and skip more
+  // work at higher speeds
+  float speed = Settings::instance().getAndStoreValue(lnm::OPTIONS_SIMDATA_REPLAY_SPEED, 1.f).toFloat();
+
+  qInfo() << Q_FUNC_INFO << "Benchmark start" << filename
+          << "duration" << benchmarkReplay->getDurationMs() / 1000 << "s" << "speed" << speed;
+
+  connect(benchmarkReplay, &SimDataReplay::simDataReplayed, this, [ = ](atools::fs::sc::SimConnectData data) {
+    QElapsedTimer timer;
+    for(ReplayBenchmarkConsumer& consumer : benchmarkConsumers)
+    {
+      timer.start();
+      consumer.func(data);
+      qint64 ns = timer.nsecsElapsed();
+      consumer.totalNs += ns;
+      consumer.maxNs = std::max(consumer.maxNs, ns);
+    }
+    benchmarkPackets++;
+  });
+  connect(benchmarkReplay, &SimDataReplay::replayFinished, this, &MainWindow::benchmarkSimDataReplayFinished);
+
+  // Widgets paint between packets like in normal operation - painting is not measured
+  benchmarkReplay->start(speed);
+}
+
+void MainWindow::benchmarkSimDataReplayFinished()
+{
+  qInfo() << Q_FUNC_INFO << "Benchmark done" << benchmarkPackets << "packets";
+  for(const ReplayBenchmarkConsumer& consumer : benchmarkConsumers)
+    qInfo().noquote().nospace() << consumer.name
+                                << ": total " << consumer.totalNs / 1000000 << " ms"
+                                << ", average " << (benchmarkPackets > 0 ?
+                                                    consumer.totalNs / benchmarkPackets / 1000 : 0) << " us"
+                                << ", max " << consumer.maxNs / 1000 << " us";
+
+  benchmarkConsumers.clear();
+
+  // Called from a signal of the replay
+  benchmarkReplay->deleteLater();
+  benchmarkReplay = nullptr;
+}
+
+void MainWindow::startProcedureValidation()
+{
+  if(Settings::instance().getAndStoreValue(lnm::OPTIONS_PROCEDURE_VALIDATION, false).toBool())
+  {
+    if(procedureValidation == nullptr)
+      procedureValidation = new ProcedureValidation(this);
+
+    procedureValidation->start(Settings::getConfigFilename("_procedure_validation.csv"));
+  }
+}
+
 void MainWindow::sunShadingTimeChanged()
 {
   qDebug() << Q_FUNC_INFO;
@@ -3014,6 +3163,7 @@ void MainWindow::setDetailLabelText(const QString& text)
 void MainWindow::mainWindowShown()
 {
   qDebug() << Q_FUNC_INFO << "enter";
+  startuptrace::begin("Main window shown");
 
   // Set empty to disable arbitrary messages from map view changes
   setStatusMessage(QString());
@@ -3153,6 +3303,22 @@ void MainWindow::mainWindowShown()
   // If enabled connect to simulator without showing dialog
   NavApp::getConnectClient()->tryConnectOnStartup();
 
+  // Run offline benchmark on recorded flight if enabled in configuration
+  Settings& settings = Settings::instance();
+  if(settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_REPLAY_BENCHMARK, false).toBool())
+  {
+    QString replayFile = settings.valueStr(lnm::OPTIONS_SIMDATA_REPLAY_FILE);
+    QTimer::singleShot(0, this, std::bind(&MainWindow::benchmarkSimDataReplay, this, replayFile));
+  }
+
+  // Compare network protocols using the recorded flight if enabled in configuration
+  if(settings.getAndStoreValue(lnm::OPTIONS_SIMDATA_DELTA_BENCHMARK, false).toBool())
+    QTimer::singleShot(0, this, std::bind(&simdelta::benchmark,
+                                          settings.valueStr(lnm::OPTIONS_SIMDATA_REPLAY_FILE)));
+
+  // Check all procedures in the navigation database if enabled in configuration
+  startProcedureValidation();
+
   // Start weather downloads
   weatherUpdateTimeout();
 
@@ -3184,6 +3350,11 @@ void MainWindow::mainWindowShown()
   if(ui->actionRouteDownloadTracks->isChecked())
     QTimer::singleShot(2000, NavApp::getTrackController(), &TrackController::startDownload);
 
+  startuptrace::end("Main window shown");
+
+  // Print startup report once the map is painted and the event queue is idle
+  QTimer::singleShot(0, startuptrace::finish);
+
   // Log screen information ==============
   for(QScreen *screen : QGuiApplication::screens())
     qDebug() << Q_FUNC_INFO
@@ -3929,11 +4100,16 @@ void MainWindow::preDatabaseLoad()
     searchController->preDatabaseLoad();
     routeController->preDatabaseLoad();
     mapWidget->preDatabaseLoad();
+    mapWidget->clearTooltipCache();
     profileWidget->preDatabaseLoad();
     infoController->preDatabaseLoad();
     weatherReporter->preDatabaseLoad();
     windReporter->preDatabaseLoad();
 
+    // Stop batch job before queries are closed
+    if(procedureValidation != nullptr)
+      procedureValidation->cancel();
+
     NavApp::preDatabaseLoad();
 
     clearWeatherContext();
@@ -3961,6 +4137,9 @@ void MainWindow::postDatabaseLoad(atools::fs::FsPaths::SimulatorType type)
     // U actions for flight simulator database switch in main menu
     NavApp::getDatabaseManager()->insertSimSwitchActions();
 
+    // Validate procedures of the new database if enabled
+    startProcedureValidation();
+
     hasDatabaseLoadStatus = false;
   }
   else
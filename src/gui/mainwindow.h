@@ -27,12 +27,15 @@
 #include <QDateTime>
 #include <marble/MarbleGlobal.h>
 
+#include <functional>
+
 class ConnectClient;
 class DatabaseManager;
 class InfoController;
 class OptionsDialog;
 class PrintSupport;
 class ProcedureSearch;
+class ProcedureValidation;
 class ProfileWidget;
 class QActionGroup;
 class QComboBox;
@@ -44,6 +47,7 @@ class RouteController;
 class RouteExport;
 class SearchBaseTable;
 class SearchController;
+class SimDataReplay;
 class WeatherReporter;
 class WindReporter;
 
@@ -62,6 +66,12 @@ namespace sql {
 class SqlDatabase;
 }
 
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+
 namespace gui {
 class Dialog;
 class ErrorHandler;
@@ -353,6 +363,15 @@ private:
   /* Actions that define the time source call this*/
   void sunShadingTimeChanged();
 
+  /* Play back a recorded flight at the configured replay speed to the simulator data consumers.
+   * Returns immediately. The processing time for each consumer is printed to the log when done. */
+  void benchmarkSimDataReplay(const QString& filename);
+  void benchmarkSimDataReplayFinished();
+
+  /* Build all procedures of the navigation database and write a report of erroneous ones if enabled
+   * in configuration */
+  void startProcedureValidation();
+
   /* Set user defined time for sun shading */
   void sunShadingTimeSet();
 
@@ -454,6 +473,7 @@ private:
   WindReporter *windReporter = nullptr;
   InfoController *infoController = nullptr;
   RouteExport *routeExport = nullptr;
+  ProcedureValidation *procedureValidation = nullptr;
 
   /* Action  groups for main menu */
   QActionGroup *actionGroupMapProjection = nullptr, *actionGroupMapTheme = nullptr, *actionGroupMapSunShading = nullptr,
@@ -474,6 +494,19 @@ private:
   QString aboutMessage;
   QTimer clockTimer, renderStatusTimer;
   Marble::RenderStatus lastRenderStatus = Marble::Incomplete;
+
+  /* Consumer and accumulated processing time for benchmarkSimDataReplay() */
+  struct ReplayBenchmarkConsumer
+  {
+    QString name;
+    std::function<void(const atools::fs::sc::SimConnectData& data)> func;
+    qint64 totalNs, maxNs;
+  };
+
+  /* Not null while the benchmark is running */
+  SimDataReplay *benchmarkReplay = nullptr;
+  QVector<ReplayBenchmarkConsumer> benchmarkConsumers;
+  int benchmarkPackets = 0;
 };
 
 #endif // LITTLENAVMAP_MAINWINDOW_H
@@ -34,6 +34,7 @@
 #include "common/aircrafttrack.h"
 #include "logbook/logdatadialog.h"
 #include "logbook/logstatisticsdialog.h"
+#include "mapgui/mapwidget.h"
 #include "zip/gzip.h"
 #include "navapp.h"
 #include "query/airportquery.h"
@@ -186,6 +187,18 @@ void LogdataController::createTakeoffLanding(const atools::fs::sc::SimConnectUse
       return;
     }
 
+    if(takeoff)
+    {
+      // Prefer the runway where the aircraft was lined up since the track might have changed after liftoff
+      int linedUpAirportId = -1;
+      int linedUpRunwayEndId = NavApp::getMapWidget()->getLinedUpRunwayEndId(linedUpAirportId);
+      if(linedUpRunwayEndId != -1 && linedUpAirportId == airport.id && linedUpRunwayEndId != runwayEnd.id)
+      {
+        qDebug() << Q_FUNC_INFO << "Using lined up runway end" << linedUpRunwayEndId << "instead of" << runwayEnd.id;
+        runwayEnd = NavApp::getAirportQuerySim()->getRunwayEndById(linedUpRunwayEndId);
+      }
+    }
+
     QString departureArrivalText = takeoff ? tr("Departure") : tr("Arrival");
     QString runwayText = runwayEnd.isValid() ? tr(" runway %1").arg(runwayEnd.name) : QString();
 
@@ -42,6 +42,7 @@
 #include "userdata/userdataicons.h"
 #include "routeexport/routeexportformat.h"
 #include "gui/dockwidgethandler.h"
+#include "common/startuptrace.h"
 
 #include <QCommandLineParser>
 #include <QDebug>
@@ -159,6 +160,10 @@ int main(int argc, char *argv[])
   int retval = 0;
   NavApp app(argc, argv);
 
+  // Measure startup phases until main window is shown
+  startuptrace::start();
+  startuptrace::begin("Application setup");
+
 #ifndef DEBUG_DISABLE_SPLASH
   // Start splash screen
   NavApp::initSplashScreen();
@@ -349,20 +354,28 @@ int main(int argc, char *argv[])
     QApplication::setEffectEnabled(Qt::UI_FadeTooltip, false);
     QApplication::setEffectEnabled(Qt::UI_AnimateTooltip, false);
 
+    startuptrace::end("Application setup");
+
     // Check if database is compatible and ask the user to erase all incompatible ones
     // If erasing databases is refused exit application
     bool databasesErased = false;
+    startuptrace::begin("Check and prepare databases");
     dbManager = new DatabaseManager(nullptr);
 
     /* Copy from application directory to settings directory if newer and create indexes if missing */
     dbManager->checkCopyAndPrepareDatabases();
 
-    if(dbManager->checkIncompatibleDatabases(&databasesErased))
+    bool databasesCompatible = dbManager->checkIncompatibleDatabases(&databasesErased);
+    startuptrace::end("Check and prepare databases");
+
+    if(databasesCompatible)
     {
       delete dbManager;
       dbManager = nullptr;
 
+      startuptrace::begin("MainWindow");
       MainWindow mainWindow;
+      startuptrace::end("MainWindow");
 
       // Show database dialog if something was removed
       mainWindow.setDatabaseErased(databasesErased);
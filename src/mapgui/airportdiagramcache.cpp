@@ -0,0 +1,76 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/airportdiagramcache.h"
+
+// ======= AirportDiagram  ===============================================================
+int AirportDiagram::size() const
+{
+  return runwayCenters.size() + taxiLines.size() + aprons.size() + parkings.size() + helipads.size() + 1;
+}
+
+// ======= Key  ===============================================================
+uint qHash(const AirportDiagramCache::Key& key)
+{
+  return static_cast<uint>(key.airportId) ^ (static_cast<uint>(key.zoomDistanceMeter) << 8) ^
+         static_cast<uint>(key.projection);
+}
+
+AirportDiagramCache::Key::Key(int airportIdParam, float zoomDistanceMeterParam, int projectionParam)
+  : airportId(airportIdParam), zoomDistanceMeter(static_cast<int>(zoomDistanceMeterParam)),
+  projection(projectionParam)
+{
+
+}
+
+bool AirportDiagramCache::Key::operator==(const AirportDiagramCache::Key& other) const
+{
+  return airportId == other.airportId && zoomDistanceMeter == other.zoomDistanceMeter &&
+         projection == other.projection;
+}
+
+bool AirportDiagramCache::Key::operator!=(const AirportDiagramCache::Key& other) const
+{
+  return !(*this == other);
+}
+
+// ======= AirportDiagramCache ===============================================================
+AirportDiagramCache::AirportDiagramCache()
+  : diagramCache(CACHE_SIZE)
+{
+
+}
+
+AirportDiagramCache::~AirportDiagramCache()
+{
+
+}
+
+const AirportDiagram *AirportDiagramCache::getDiagram(int airportId, float zoomDistanceMeter, int projection)
+{
+  return diagramCache.object(Key(airportId, zoomDistanceMeter, projection));
+}
+
+void AirportDiagramCache::insert(int airportId, float zoomDistanceMeter, int projection, AirportDiagram *diagram)
+{
+  diagramCache.insert(Key(airportId, zoomDistanceMeter, projection), diagram, diagram->size());
+}
+
+void AirportDiagramCache::clear()
+{
+  diagramCache.clear();
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRPORTDIAGRAMCACHE_H
+#define LNM_AIRPORTDIAGRAMCACHE_H
+
+#include <QCache>
+#include <QLineF>
+#include <QPolygonF>
+#include <QRect>
+
+/*
+ * Projected geometry of an airport diagram for one zoom distance.
+ *
+ * All coordinates are screen coordinates relative to the airport reference point. Indexes match the lists
+ * returned by AirportQuery for the airport.
+ */
+struct AirportDiagram
+{
+  /* Runway centers and rectangles as calculated by MapPainterAirport::runwayCoords() */
+  QList<QPoint> runwayCenters;
+  QList<QRect> runwayRects, runwayOutlineRects;
+
+  /* Taxiway, apron, parking and helipad geometry. Only filled if detail is true. */
+  QVector<QLineF> taxiLines;
+  QVector<int> taxiThickness;
+
+  /* FSX/P3D apron polygons. Empty for X-Plane aprons which are cached in ApronGeometryCache. */
+  QVector<QPolygonF> aprons;
+
+  /* Parking and helipad centers */
+  QVector<QPointF> parkings, helipads;
+
+  /* true if taxiways, aprons, parking and helipads are included */
+  bool detail = false;
+
+  /* Number of elements used as cache cost */
+  int size() const;
+};
+
+/*
+ * Caches projected airport diagram geometry by airport id, zoom distance and projection.
+ *
+ * Geometry is kept relative to the airport reference point so that panning the map only needs a translation
+ * instead of projecting all runways, taxiways, aprons and parking spots again for each frame.
+ */
+class AirportDiagramCache
+{
+public:
+  AirportDiagramCache();
+  ~AirportDiagramCache();
+
+  /* Get diagram or null if not cached */
+  const AirportDiagram *getDiagram(int airportId, float zoomDistanceMeter, int projection);
+
+  /* Insert diagram. Cache takes ownership. */
+  void insert(int airportId, float zoomDistanceMeter, int projection, AirportDiagram *diagram);
+
+  /* Clear the cache */
+  void clear();
+
+private:
+  /* Cache key used to identify the geometry of an airport */
+  struct Key
+  {
+    Key(int airportIdParam, float zoomDistanceMeterParam, int projectionParam);
+
+    int airportId;
+    int zoomDistanceMeter;
+    int projection;
+
+    bool operator!=(const AirportDiagramCache::Key& other) const;
+    bool operator==(const AirportDiagramCache::Key& other) const;
+
+  };
+
+  friend uint qHash(const AirportDiagramCache::Key& key);
+
+  /* Maximum number of cached elements. Large hubs have several thousand taxi paths and parking spots. */
+  static const int CACHE_SIZE = 200000;
+
+  QCache<Key, AirportDiagram> diagramCache;
+};
+
+#endif // LNM_AIRPORTDIAGRAMCACHE_H
@@ -18,12 +18,15 @@
 #include "mapgui/mapfunctions.h"
 
 #include "fs/sc/simconnectaircraft.h"
+#include "geo/calculations.h"
 #include "online/onlinedatacontroller.h"
 #include "mapgui/maplayer.h"
 #include "navapp.h"
 
 #include <QVector>
 
+#include <algorithm>
+
 namespace mapfunc {
 
 bool aircraftVisible(const atools::fs::sc::SimConnectAircraft& ac, const MapLayer *layer)
@@ -43,4 +46,28 @@ bool aircraftVisible(const atools::fs::sc::SimConnectAircraft& ac, const MapLaye
   return show;
 }
 
+atools::geo::Pos extrapolatedPosition(const atools::fs::sc::SimConnectAircraft& ac, float seconds)
+{
+  using atools::fs::sc::SC_INVALID_FLOAT;
+
+  const atools::geo::Pos& pos = ac.getPosition();
+  float groundSpeed = ac.getGroundSpeedKts();
+  if(!(seconds > 0.f) || !pos.isValid() || groundSpeed < 1.f || groundSpeed >= SC_INVALID_FLOAT)
+    return pos;
+
+  // Online clients do not provide a track
+  float course = ac.getTrackDegTrue() < SC_INVALID_FLOAT ? ac.getTrackDegTrue() : ac.getHeadingDegTrue();
+  if(course >= SC_INVALID_FLOAT)
+    return pos;
+
+  atools::geo::Pos next = pos.endpoint(atools::geo::nmToMeter(groundSpeed * seconds / 3600.f), course);
+
+  float altitude = pos.getAltitude();
+  float verticalSpeed = ac.getVerticalSpeedFeetPerMin();
+  if(!ac.isOnGround() && verticalSpeed < SC_INVALID_FLOAT)
+    altitude = std::max(altitude + verticalSpeed * seconds / 60.f, 0.f);
+
+  return next.alt(altitude);
+}
+
 } // namespace mapfunc
@@ -19,6 +19,9 @@
 #define LNM_MAPFUNCTIONS_H
 
 namespace atools {
+namespace geo {
+class Pos;
+}
 namespace fs {
 namespace sc {
 class SimConnectAircraft;
@@ -36,6 +39,10 @@ namespace mapfunc {
 /* True if aircraft is visible for current layer and aicraft properties */
 bool aircraftVisible(const atools::fs::sc::SimConnectAircraft& ac, const MapLayer *layer);
 
+/* Dead reckoning. Position after moving for the given time with ground speed, track and vertical speed.
+ * Returns the unchanged position for aircraft standing still or without valid track or heading. */
+atools::geo::Pos extrapolatedPosition(const atools::fs::sc::SimConnectAircraft& ac, float seconds);
+
 } // namespace mapfunc
 
 #endif // LNM_MAPFUNCTIONS_H
@@ -27,6 +27,11 @@
 #include "common/unit.h"
 #include "common/aircrafttrack.h"
 #include "mapgui/aprongeometrycache.h"
+#include "mapgui/airportdiagramcache.h"
+#include "online/onlinedatacontroller.h"
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "atools.h"
 
 #include <QPainter>
 #include <QJsonDocument>
@@ -43,6 +48,10 @@ const static double MINIMUM_DISTANCE_KM = 0.1;
 const static double MAXIMUM_DISTANCE_KM = 6000.;
 const static int MAXIMUM_ZOOM = 1120;
 
+/* Do not extrapolate aircraft positions longer than this after the last update */
+const static float MAX_EXTRAPOLATION_SECONDS_SIM = 5.f;
+const static float MAX_EXTRAPOLATION_SECONDS_ONLINE = 180.f;
+
 using namespace Marble;
 using atools::geo::Rect;
 using atools::geo::Pos;
@@ -74,6 +83,11 @@ MapPaintWidget::MapPaintWidget(QWidget *parent, bool visible)
   // Initialize the X-Plane apron geometry cache
   apronGeometryCache = new ApronGeometryCache();
   apronGeometryCache->setViewportParams(viewport());
+
+  airportDiagramCache = new AirportDiagramCache();
+
+  extrapolationUpdateMs = atools::settings::Settings::instance().getAndStoreValue(
+    lnm::OPTIONS_AIRCRAFT_EXTRAPOLATION_MS, 500).toInt();
 }
 
 MapPaintWidget::~MapPaintWidget()
@@ -89,6 +103,7 @@ MapPaintWidget::~MapPaintWidget()
   delete aircraftTrack;
 
   delete apronGeometryCache;
+  delete airportDiagramCache;
 }
 
 void MapPaintWidget::copySettings(const MapPaintWidget& other)
@@ -250,11 +265,13 @@ void MapPaintWidget::optionsChanged()
 
   // reloadMap();
   updateCacheSizes();
+  paintLayer->invalidateStaticCache();
   update();
 }
 
 void MapPaintWidget::styleChanged()
 {
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -283,14 +300,32 @@ void MapPaintWidget::setShowMapSunShading(bool show)
 void MapPaintWidget::weatherUpdated()
 {
   if(paintLayer->getShownMapObjects() | map::AIRPORT_WEATHER)
+  {
+    paintLayer->invalidateStaticCache();
     update();
+  }
+}
+
+void MapPaintWidget::airspacesUpdated()
+{
+  paintLayer->invalidateStaticCache();
+  update();
+}
+
+void MapPaintWidget::tracksUpdated()
+{
+  paintLayer->invalidateStaticCache();
+  update();
 }
 
 void MapPaintWidget::windUpdated()
 {
   if(paintLayer->getShownMapObjectDisplayTypes() | map::WIND_BARBS ||
      paintLayer->getShownMapObjectDisplayTypes() | map::WIND_BARBS_ROUTE)
+  {
+    paintLayer->invalidateStaticCache();
     update();
+  }
 }
 
 map::MapWeatherSource MapPaintWidget::getMapWeatherSource() const
@@ -397,6 +432,11 @@ ApronGeometryCache *MapPaintWidget::getApronGeometryCache()
   return apronGeometryCache;
 }
 
+AirportDiagramCache *MapPaintWidget::getAirportDiagramCache()
+{
+  return airportDiagramCache;
+}
+
 QString MapPaintWidget::getMapCopyright() const
 {
   static const QString OSM("© OpenStreetMap contributors");
@@ -431,6 +471,7 @@ void MapPaintWidget::preDatabaseLoad()
   cancelDragAll();
   databaseLoadStatus = true;
   apronGeometryCache->clear();
+  airportDiagramCache->clear();
   paintLayer->preDatabaseLoad();
 }
 
@@ -790,6 +831,7 @@ void MapPaintWidget::routeChanged(bool geometryChanged)
     cancelDragAll();
     screenIndex->updateRouteScreenGeometry(getCurrentViewBoundingBox());
   }
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -802,6 +844,7 @@ void MapPaintWidget::routeAltitudeChanged(float altitudeFeet)
 
   qDebug() << Q_FUNC_INFO;
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -854,6 +897,7 @@ void MapPaintWidget::clearSearchHighlights()
 
   screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -861,6 +905,7 @@ void MapPaintWidget::clearAirspaceHighlights()
 {
   screenIndex->changeAirspaceHighlights(QList<map::MapAirspace>());
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -924,6 +969,7 @@ void MapPaintWidget::changeAirspaceHighlights(const QList<map::MapAirspace>& air
 {
   screenIndex->changeAirspaceHighlights(airspaces);
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -948,6 +994,7 @@ void MapPaintWidget::changeSearchHighlights(const map::MapResult& newHighlights,
     screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
   if(updateAirspace)
     screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -1085,6 +1132,30 @@ const QVector<atools::fs::sc::SimConnectAircraft>& MapPaintWidget::getAiAircraft
   return screenIndex->getAiAircraft();
 }
 
+float MapPaintWidget::getExtrapolationSeconds(bool online) const
+{
+  if(extrapolationUpdateMs <= 0)
+    return 0.f;
+
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  if(online)
+  {
+    const QDateTime& lastUpdate = NavApp::getOnlinedataController()->getPositionsUpdateTime();
+    if(!lastUpdate.isValid())
+      return 0.f;
+
+    return atools::minmax(0.f, MAX_EXTRAPOLATION_SECONDS_ONLINE, (now - lastUpdate.toMSecsSinceEpoch()) / 1000.f);
+  }
+  else
+  {
+    if(screenIndex->getSimDataTimestampMs() == 0L || getUserAircraft().isSimPaused())
+      return 0.f;
+
+    return atools::minmax(0.f, MAX_EXTRAPOLATION_SECONDS_SIM,
+                          (now - screenIndex->getSimDataTimestampMs()) / 1000.f);
+  }
+}
+
 void MapPaintWidget::resizeEvent(QResizeEvent *event)
 {
   if(!visibleWidget)
@@ -1172,6 +1243,7 @@ bool MapPaintWidget::loadKml(const QString& filename, bool center)
 void MapPaintWidget::onlineClientAndAtcUpdated()
 {
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  paintLayer->invalidateStaticCache();
   update();
 }
 
@@ -1179,5 +1251,6 @@ void MapPaintWidget::onlineNetworkChanged()
 {
   screenIndex->resetAirspaceOnlineScreenGeometry();
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  paintLayer->invalidateStaticCache();
   update();
 }
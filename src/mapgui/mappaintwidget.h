@@ -34,6 +34,7 @@ class MainWindow;
 class MapPaintLayer;
 class MapScreenIndex;
 class ApronGeometryCache;
+class AirportDiagramCache;
 
 namespace proc {
 struct MapProcedureLeg;
@@ -191,6 +192,17 @@ public:
   /* AI aircraft as shown on the map */
   const QVector<atools::fs::sc::SimConnectAircraft>& getAiAircraft() const;
 
+  /* Seconds since the last simulator data (online false) or online network update (online true) which are used
+   * to extrapolate AI and online aircraft positions between updates.
+   * 0 if extrapolation is disabled or simulator is paused. */
+  float getExtrapolationSeconds(bool online) const;
+
+  /* Interval for map redraws showing extrapolated aircraft positions. 0 if disabled. */
+  int getExtrapolationUpdateMs() const
+  {
+    return extrapolationUpdateMs;
+  }
+
   /* Get currently loaded KML file paths */
   const QStringList& getKmlFiles() const
   {
@@ -206,6 +218,12 @@ public:
   /* Redraw map to reflect weather changes */
   void weatherUpdated();
 
+  /* Redraw map after user airspaces were loaded or airspace sources were changed */
+  void airspacesUpdated();
+
+  /* Redraw map after tracks were downloaded or deleted */
+  void tracksUpdated();
+
   /* Redraw map to reflect wind barb changes */
   void windUpdated();
 
@@ -296,6 +314,7 @@ public:
   }
 
   ApronGeometryCache *getApronGeometryCache();
+  AirportDiagramCache *getAirportDiagramCache();
 
   /* true if real map display widget - false if hidden for online services or other applications */
   bool isVisibleWidget() const
@@ -405,6 +424,9 @@ protected:
   /* Caches complex X-Plane apron geometry as objects in screen coordinates for faster painting. */
   ApronGeometryCache *apronGeometryCache;
 
+  /* Caches projected runway, taxiway, apron and parking geometry relative to the airport position. */
+  AirportDiagramCache *airportDiagramCache;
+
   /* Keep the the overlays for the GUI widget from updating */
   bool ignoreOverlayUpdates = false;
 
@@ -441,6 +463,9 @@ protected:
   /* Zoom one step out to avoid blurred maps */
   bool avoidBlurredMap = false;
 
+  /* Dead reckoning for AI and online aircraft */
+  int extrapolationUpdateMs = 500;
+
   /* true if real window/widget */
   bool visibleWidget = false;
 
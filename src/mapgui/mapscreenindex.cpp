@@ -303,22 +303,30 @@ void MapScreenIndex::updateAirwayScreenGeometryInternal(QSet<int>& ids, const Ma
       if(paintLayer->getMapLayer()->isAirway() && (showJet || showVictor))
       {
         // Airways are visible on map - get them from the cache/database
-        QList<MapAirway> airways;
-        airwayQuery->getAirways(airways, curBox, paintLayer->getMapLayer(), false);
-
-        for(int i = 0; i < airways.size(); i++)
+        const QVector<map::MapAirwayLine> *lines = nullptr;
+        const QList<MapAirway> *airways = airwayQuery->getAirways(curBox, paintLayer->getMapLayer(), false, &lines);
+        if(airways != nullptr)
         {
-          const MapAirway& airway = airways.at(i);
-          if(ids.contains(airway.id))
-            continue;
+          for(const map::MapAirwayLine& line : *lines)
+          {
+            const MapAirway& first = airways->at(line.indexes.first());
+            if((first.type == map::AIRWAY_VICTOR && !showVictor) || (first.type == map::AIRWAY_JET && !showJet))
+              // Not visible by map setting
+              continue;
 
-          if((airway.type == map::AIRWAY_VICTOR && !showVictor) ||
-             (airway.type == map::AIRWAY_JET && !showJet))
-            // Not visible by map setting
-            continue;
+            if(!lineIntersects(line, curBox))
+              continue;
 
-          updateLineScreenGeometry(airwayLines, airway.id, Line(airway.from, airway.to), curBox, conv);
-          ids.insert(airway.id);
+            for(int i : line.indexes)
+            {
+              const MapAirway& airway = airways->at(i);
+              if(ids.contains(airway.id))
+                continue;
+
+              updateLineScreenGeometry(airwayLines, airway.id, Line(airway.from, airway.to), curBox, conv);
+              ids.insert(airway.id);
+            }
+          }
         }
       }
 
@@ -326,21 +334,25 @@ void MapScreenIndex::updateAirwayScreenGeometryInternal(QSet<int>& ids, const Ma
       if(paintLayer->getMapLayer()->isTrack() && showTrack)
       {
         // Airways are visible on map - get them from the cache/database
-        QList<MapAirway> tracks;
-        airwayQuery->getTracks(tracks, curBox, paintLayer->getMapLayer(), false);
-
-        for(int i = 0; i < tracks.size(); i++)
+        const QVector<map::MapAirwayLine> *lines = nullptr;
+        const QList<MapAirway> *tracks = airwayQuery->getTracks(curBox, paintLayer->getMapLayer(), false, &lines);
+        if(tracks != nullptr)
         {
-          const MapAirway& track = tracks.at(i);
-          if(ids.contains(track.id))
-            continue;
+          for(const map::MapAirwayLine& line : *lines)
+          {
+            if(!lineIntersects(line, curBox))
+              continue;
 
-          if(track.isTrack() && !showTrack)
-            // Not visible by map setting
-            continue;
+            for(int i : line.indexes)
+            {
+              const MapAirway& track = tracks->at(i);
+              if(ids.contains(track.id))
+                continue;
 
-          updateLineScreenGeometry(airwayLines, track.id, Line(track.from, track.to), curBox, conv);
-          ids.insert(track.id);
+              updateLineScreenGeometry(airwayLines, track.id, Line(track.from, track.to), curBox, conv);
+              ids.insert(track.id);
+            }
+          }
         }
       }
     }
@@ -361,6 +373,13 @@ void MapScreenIndex::updateAirwayScreenGeometryInternal(QSet<int>& ids, const Ma
   }
 }
 
+bool MapScreenIndex::lineIntersects(const map::MapAirwayLine& line, const Marble::GeoDataLatLonBox& curBox)
+{
+  const Rect& bnd = line.bounding;
+  return Marble::GeoDataLatLonBox(bnd.getNorth(), bnd.getSouth(), bnd.getEast(), bnd.getWest(),
+                                  Marble::GeoDataCoordinates::Degree).intersects(curBox);
+}
+
 void MapScreenIndex::updateLineScreenGeometry(QList<std::pair<int, QLine> >& index,
                                               int id, const atools::geo::Line& line,
                                               const Marble::GeoDataLatLonBox& curBox,
@@ -513,6 +532,10 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapResu
   // Check for AI / multiplayer aircraft from simulator ==============================
   int x, y;
 
+  // Use the same extrapolated positions as the painter
+  float secondsSim = mapPaintWidget->getExtrapolationSeconds(false /* online */);
+  float secondsOnline = mapPaintWidget->getExtrapolationSeconds(true /* online */);
+
   // Add boats ======================================
   result.aiAircraft.clear();
   if(NavApp::isConnected())
@@ -523,7 +546,7 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapResu
       {
         if(obj.isAnyBoat() && (obj.getModelRadiusCorrected() * 2 > layer::LARGE_SHIP_SIZE || mapLayer->isAiShipSmall()))
         {
-          if(conv.wToS(obj.getPosition(), x, y))
+          if(conv.wToS(mapfunc::extrapolatedPosition(obj, secondsSim), x, y))
             if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
               insertSortedByDistance(conv, result.aiAircraft, nullptr, xs, ys, map::MapAiAircraft(obj));
         }
@@ -540,7 +563,7 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapResu
       {
         if(!obj.isAnyBoat() && mapfunc::aircraftVisible(obj, mapLayer))
         {
-          if(conv.wToS(obj.getPosition(), x, y))
+          if(conv.wToS(mapfunc::extrapolatedPosition(obj, obj.isOnline() ? secondsOnline : secondsSim), x, y))
           {
             if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
             {
@@ -562,7 +585,7 @@ void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapResu
     {
       if(mapfunc::aircraftVisible(obj, mapLayer))
       {
-        if(conv.wToS(obj.getPosition(), x, y))
+        if(conv.wToS(mapfunc::extrapolatedPosition(obj, secondsOnline), x, y))
           if((atools::geo::manhattanDistance(x, y, xs, ys)) < maxDistance)
             insertSortedByDistance(conv, result.onlineAircraft, &result.onlineAircraftIds, xs, ys,
                                    map::MapOnlineAircraft(obj));
@@ -21,6 +21,8 @@
 #include "fs/sc/simconnectdata.h"
 #include "common/mapflags.h"
 
+#include <QDateTime>
+
 namespace atools {
 namespace geo {
 class Line;
@@ -41,6 +43,7 @@ struct MapWaypoint;
 struct MapIls;
 struct MapUserpointRoute;
 struct MapAirway;
+struct MapAirwayLine;
 struct MapParking;
 struct MapHelipad;
 struct MapAirspace;
@@ -217,6 +220,13 @@ public:
   void updateSimData(const atools::fs::sc::SimConnectData& data)
   {
     simData = data;
+    simDataTimestampMs = QDateTime::currentMSecsSinceEpoch();
+  }
+
+  /* Milliseconds since epoch when the last simulator data was received */
+  qint64 getSimDataTimestampMs() const
+  {
+    return simDataTimestampMs;
   }
 
   bool isUserAircraftValid() const
@@ -290,6 +300,9 @@ private:
                                             const Marble::GeoDataLatLonBox& curBox, bool highlights);
   void updateAirwayScreenGeometryInternal(QSet<int>& ids, const Marble::GeoDataLatLonBox& curBox, bool highlight);
 
+  /* true if bounding rectangle of merged airway line intersects the box */
+  static bool lineIntersects(const map::MapAirwayLine& line, const Marble::GeoDataLatLonBox& curBox);
+
   void updateLineScreenGeometry(QList<std::pair<int, QLine> >& index, int id, const atools::geo::Line& line,
                                 const Marble::GeoDataLatLonBox& curBox,
                                 const CoordinateConverter& conv);
@@ -301,6 +314,7 @@ private:
   int getNearestIndex(int xs, int ys, int maxDistance, const QList<TYPE>& typeList) const;
 
   atools::fs::sc::SimConnectData simData, lastSimData;
+  qint64 simDataTimestampMs = 0L;
   MapPaintWidget *mapPaintWidget;
   MapQuery *mapQuery;
   AirwayTrackQuery *airwayQuery;
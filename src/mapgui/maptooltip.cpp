@@ -32,6 +32,7 @@
 
 #include <QPalette>
 #include <QToolTip>
+#include <QElapsedTimer>
 
 using namespace map;
 using atools::util::HtmlBuilder;
@@ -45,6 +46,7 @@ MapTooltip::MapTooltip(MainWindow *parentWindow)
   : mainWindow(parentWindow), mapQuery(NavApp::getMapQuery()), weather(NavApp::getWeatherReporter())
 {
   qDebug() << Q_FUNC_INFO;
+  fragmentCache.setMaxCost(FRAGMENT_CACHE_SIZE);
 }
 
 MapTooltip::~MapTooltip()
@@ -52,7 +54,13 @@ MapTooltip::~MapTooltip()
   qDebug() << Q_FUNC_INFO;
 }
 
-QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Route& route, bool airportDiagram)
+void MapTooltip::clearCache()
+{
+  fragmentCache.clear();
+}
+
+QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Route& route, bool airportDiagram,
+                                 bool *incomplete)
 {
   optsd::DisplayTooltipOptions opts = OptionData::instance().getDisplayTooltipOptions();
 
@@ -60,30 +68,74 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Ro
   qDebug() << Q_FUNC_INFO << mapSearchResult;
 #endif
 
-  HtmlBuilder html(false);
   HtmlInfoBuilder info(mainWindow, false);
-  int numEntries = 0;
+
+  // Bearing and distance to user are inserted after all fragments are collected
+  info.setBearingPlaceholders(true);
+
+  QVector<Fragment> fragments;
+  int numLines = 0;
+  bool more = false, deferred = false;
+  QElapsedTimer timer;
+  timer.start();
 
   // Append HTML text for all objects found in order of importance (airports first, etc.)
   // Objects are separated by a horizontal ruler
-  // If max number of entries or lines is exceeded return the html
+  // Remaining objects are ignored if max number of entries or lines is exceeded
+
+  // Add fragment for dynamic objects which is built on each call
+  auto addFragment = [&](const FragmentFunctionType& func) -> void
+                     {
+                       if(more || deferred)
+                         return;
+
+                       if(numLines > MAX_LINES)
+                         more = true;
+                       else
+                       {
+                         fragments.append(buildFragment(func));
+                         numLines += fragments.last().lines;
+                       }
+                     };
+
+  // Add fragment for database objects from cache or build and cache it if time allows
+  auto addCachedFragment = [&](const FragmentKey& key, const FragmentFunctionType& func) -> void
+                           {
+                             if(more || deferred)
+                               return;
+
+                             if(numLines > MAX_LINES)
+                               more = true;
+                             else
+                             {
+                               Fragment *fragment = fragmentCache.object(key);
+                               if(fragment == nullptr)
+                               {
+                                 if(timer.elapsed() > MAX_BUILD_TIME_MS)
+                                 {
+                                   // Too slow - continue with next call
+                                   deferred = true;
+                                   return;
+                                 }
+
+                                 fragment = new Fragment(buildFragment(func));
+                                 fragmentCache.insert(key, fragment);
+                               }
+                               fragments.append(*fragment);
+                               numLines += fragment->lines;
+                             }
+                           };
 
   // User Aircraft ===========================================================================
   if(opts.testFlag(optsd::TOOLTIP_AIRCRAFT_USER))
   {
     if(mapSearchResult.userAircraft.getPosition().isValid())
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.aircraftText(mapSearchResult.userAircraft.getAircraft(), html);
-      info.aircraftProgressText(mapSearchResult.userAircraft.getAircraft(), html, route,
-                                false /* show more/less switch */, false /* true if less info mode */);
-
-      numEntries++;
+      addFragment([&](HtmlBuilder& html) {
+        info.aircraftText(mapSearchResult.userAircraft.getAircraft(), html);
+        info.aircraftProgressText(mapSearchResult.userAircraft.getAircraft(), html, route,
+                                  false /* show more/less switch */, false /* true if less info mode */);
+      });
     }
   }
 
@@ -92,33 +144,21 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Ro
     // Online Aircraft ===========================================================================
     for(const map::MapOnlineAircraft& aircraft : mapSearchResult.onlineAircraft)
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.aircraftText(aircraft.getAircraft(), html);
-      info.aircraftProgressText(aircraft.getAircraft(), html, Route(),
-                                false /* show more/less switch */, false /* true if less info mode */);
-
-      numEntries++;
+      addFragment([&](HtmlBuilder& html) {
+        info.aircraftText(aircraft.getAircraft(), html);
+        info.aircraftProgressText(aircraft.getAircraft(), html, Route(),
+                                  false /* show more/less switch */, false /* true if less info mode */);
+      });
     }
 
     // AI Aircraft ===========================================================================
     for(const map::MapAiAircraft& aircraft : mapSearchResult.aiAircraft)
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.aircraftText(aircraft.getAircraft(), html);
-      info.aircraftProgressText(aircraft.getAircraft(), html, Route(),
-                                false /* show more/less switch */, false /* true if less info mode */);
-
-      numEntries++;
+      addFragment([&](HtmlBuilder& html) {
+        info.aircraftText(aircraft.getAircraft(), html);
+        info.aircraftProgressText(aircraft.getAircraft(), html, Route(),
+                                  false /* show more/less switch */, false /* true if less info mode */);
+      });
     }
   }
 
@@ -126,275 +166,137 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Ro
   if(opts.testFlag(optsd::TOOLTIP_NAVAID))
   {
     for(const proc::MapProcedurePoint& ap : mapSearchResult.procPoints)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.procedurePointText(ap, html, &route);
-
-      numEntries++;
-    }
+      addFragment([&](HtmlBuilder& html) {
+        info.procedurePointText(ap, html, &route);
+      });
   }
 
   // Holds ===========================================================================
   for(const Hold& entry : mapSearchResult.holds)
-  {
-    if(checkText(html))
-      return html.getHtml();
-
-    if(!html.isEmpty())
-      html.textBar(TEXT_BAR_LENGTH);
-
-    info.holdText(entry, html);
-
-    numEntries++;
-  }
+    addFragment([&](HtmlBuilder& html) {
+      info.holdText(entry, html);
+    });
 
   // Traffic pattern ===========================================================================
   for(const TrafficPattern& entry : mapSearchResult.trafficPatterns)
-  {
-    if(checkText(html))
-      return html.getHtml();
-
-    if(!html.isEmpty())
-      html.textBar(TEXT_BAR_LENGTH);
-
-    info.trafficPatternText(entry, html);
-
-    numEntries++;
-  }
+    addFragment([&](HtmlBuilder& html) {
+      info.trafficPatternText(entry, html);
+    });
 
   // Range rings ===========================================================================
   for(const RangeMarker& entry : mapSearchResult.rangeMarkers)
-  {
-    if(checkText(html))
-      return html.getHtml();
-
-    if(!html.isEmpty())
-      html.textBar(TEXT_BAR_LENGTH);
-
-    info.rangeMarkerText(entry, html);
-
-    numEntries++;
-  }
+    addFragment([&](HtmlBuilder& html) {
+      info.rangeMarkerText(entry, html);
+    });
 
   // Logbook entries ===========================================================================
   if(opts.testFlag(optsd::TOOLTIP_NAVAID))
   {
     for(const MapLogbookEntry& entry : mapSearchResult.logbookEntries)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.logEntryText(entry, html);
-
-      numEntries++;
-    }
+      addFragment([&](HtmlBuilder& html) {
+        info.logEntryText(entry, html);
+      });
   }
 
   // Userpoints ===========================================================================
   for(const MapUserpoint& up : mapSearchResult.userpoints)
-  {
-    if(checkText(html))
-      return html.getHtml();
-
-    if(!html.isEmpty())
-      html.textBar(TEXT_BAR_LENGTH);
-
-    info.userpointText(up, html);
-
-    numEntries++;
-  }
+    addFragment([&](HtmlBuilder& html) {
+      info.userpointText(up, html);
+    });
 
   // Airports ===========================================================================
   if(opts.testFlag(optsd::TOOLTIP_AIRPORT))
   {
     for(const MapAirport& airport : mapSearchResult.airports)
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
+      addCachedFragment({map::AIRPORT, airport.id, airport.routeIndex}, [&](HtmlBuilder& html) {
+        map::WeatherContext currentWeatherContext;
 
-      map::WeatherContext currentWeatherContext;
-
-      mainWindow->buildWeatherContextForTooltip(currentWeatherContext, airport);
-      info.airportText(airport, currentWeatherContext, html, &route);
-
-      numEntries++;
+        mainWindow->buildWeatherContextForTooltip(currentWeatherContext, airport);
+        info.airportText(airport, currentWeatherContext, html, &route);
+      });
     }
   }
 
   // Navaids ===========================================================================
   if(opts.testFlag(optsd::TOOLTIP_NAVAID))
   {
-
     for(const MapVor& vor : mapSearchResult.vors)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.vorText(vor, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::VOR, vor.id, vor.routeIndex}, [&](HtmlBuilder& html) {
+        info.vorText(vor, html);
+      });
 
     for(const MapNdb& ndb : mapSearchResult.ndbs)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.ndbText(ndb, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::NDB, ndb.id, ndb.routeIndex}, [&](HtmlBuilder& html) {
+        info.ndbText(ndb, html);
+      });
 
     for(const MapWaypoint& wp : mapSearchResult.waypoints)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.waypointText(wp, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::WAYPOINT, wp.id, wp.routeIndex}, [&](HtmlBuilder& html) {
+        info.waypointText(wp, html);
+      });
 
     for(const MapMarker& m : mapSearchResult.markers)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.markerText(m, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::MARKER, m.id, -1}, [&](HtmlBuilder& html) {
+        info.markerText(m, html);
+      });
 
     for(const MapIls& ils : mapSearchResult.ils)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.ilsText(ils, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::ILS, ils.id, -1}, [&](HtmlBuilder& html) {
+        info.ilsText(ils, html);
+      });
   }
 
   // Airport stuff ===========================================================================
   if(airportDiagram && opts.testFlag(optsd::TOOLTIP_AIRPORT))
   {
     for(const MapAirport& ap : mapSearchResult.towers)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
+      addFragment([&](HtmlBuilder& html) {
+        info.towerText(ap, html);
+      });
 
-      info.towerText(ap, html);
-
-      numEntries++;
-    }
     for(const MapParking& p : mapSearchResult.parkings)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
+      addFragment([&](HtmlBuilder& html) {
+        info.parkingText(p, html);
+      });
 
-      info.parkingText(p, html);
-
-      numEntries++;
-    }
     for(const MapHelipad& p : mapSearchResult.helipads)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.helipadText(p, html);
-
-      numEntries++;
-    }
+      addFragment([&](HtmlBuilder& html) {
+        info.helipadText(p, html);
+      });
   }
 
   if(opts.testFlag(optsd::TOOLTIP_NAVAID))
   {
     for(const MapUserpointRoute& up : mapSearchResult.userpointsRoute)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.userpointTextRoute(up, html);
-
-      numEntries++;
-    }
+      addFragment([&](HtmlBuilder& html) {
+        info.userpointTextRoute(up, html);
+      });
 
     for(const MapAirway& airway : mapSearchResult.airways)
-    {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.airwayText(airway, html);
-
-      numEntries++;
-    }
+      addCachedFragment({map::AIRWAY, airway.id, -1}, [&](HtmlBuilder& html) {
+        info.airwayText(airway, html);
+      });
   }
 
   // High altitude winds ===========================================================================
-  if(opts.testFlag(optsd::TOOLTIP_WIND) && mapSearchResult.windPos.isValid())
+  if(opts.testFlag(optsd::TOOLTIP_WIND) && mapSearchResult.windPos.isValid() && !more && !deferred)
   {
     WindReporter *windReporter = NavApp::getWindReporter();
     atools::grib::WindPosVector winds = windReporter->getWindStackForPos(mapSearchResult.windPos);
     if(!winds.isEmpty())
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      info.windText(winds, html, windReporter->getAltitude(), windReporter->getSourceText());
+      addFragment([&](HtmlBuilder& html) {
+        info.windText(winds, html, windReporter->getAltitude(), windReporter->getSourceText());
 
 #ifdef DEBUG_INFORMATION
-      html.hr().small(QString("Pos(%1, %2), alt(%3)").
-                      arg(mapSearchResult.windPos.getLonX()).arg(mapSearchResult.windPos.getLatY()).
-                      arg(windReporter->getAltitude(), 0, 'f', 2)).br();
+        html.hr().small(QString("Pos(%1, %2), alt(%3)").
+                        arg(mapSearchResult.windPos.getLonX()).arg(mapSearchResult.windPos.getLatY()).
+                        arg(windReporter->getAltitude(), 0, 'f', 2)).br();
 
-      html.small(windReporter->getDebug(mapSearchResult.windPos));
+        html.small(windReporter->getDebug(mapSearchResult.windPos));
 #endif
-      numEntries++;
+      });
     }
   }
 
@@ -406,38 +308,74 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const Ro
 
     for(const MapAirspace& airspace : res.airspaces)
     {
-      if(checkText(html))
-        return html.getHtml();
-
-      if(!html.isEmpty())
-        html.textBar(TEXT_BAR_LENGTH);
-
-      atools::sql::SqlRecord onlineRec;
       if(airspace.isOnline())
-        onlineRec = NavApp::getAirspaceController()->getOnlineAirspaceRecordById(airspace.id);
-
-      info.airspaceText(airspace, onlineRec, html);
-
-      numEntries++;
+      {
+        // Online centers change with each download - do not cache
+        addFragment([&](HtmlBuilder& html) {
+          info.airspaceText(airspace, NavApp::getAirspaceController()->getOnlineAirspaceRecordById(airspace.id), html);
+        });
+      }
+      else
+        addCachedFragment({map::AIRSPACE, airspace.id, static_cast<int>(airspace.src)}, [&](HtmlBuilder& html) {
+          info.airspaceText(airspace, atools::sql::SqlRecord(), html);
+        });
     }
   }
 
-  QString str = html.getHtml();
+  // Join fragments separated by text bars ===========================================================
+  QString textBar = HtmlBuilder(false).textBar(TEXT_BAR_LENGTH).getHtml();
+  QString str;
+  for(const Fragment& fragment : fragments)
+  {
+    if(!str.isEmpty())
+      str.append(textBar);
+    str.append(fragment.html);
+  }
+
+  if(more)
+    str.append(textBar + HtmlBuilder(false).b(tr("More ...")).getHtml());
+  else if(deferred)
+    str.append(textBar + HtmlBuilder(false).b(tr("Loading ...")).getHtml());
+
+  // Fill in current bearing and distance to user aircraft
+  info.replaceBearingPlaceholders(str);
+
   if(str.endsWith("<br/>"))
     str.chop(5);
 
+  if(incomplete != nullptr)
+    *incomplete = deferred;
+
 #ifdef DEBUG_INFORMATION_TOOLTIP
 
-  qDebug().noquote().nospace() << Q_FUNC_INFO << html.getHtml();
+  qDebug().noquote().nospace() << Q_FUNC_INFO << str;
 
 #endif
 
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "fragments" << fragments.size() << "cached" << fragmentCache.size()
+           << "deferred" << deferred << timer.elapsed() << "ms";
+#endif
+
   return str;
+}
 
+MapTooltip::Fragment MapTooltip::buildFragment(const FragmentFunctionType& func)
+{
+  HtmlBuilder html(false);
+  func(html);
+
+  // Approximate number of lines by counting table rows and line breaks plus title
+  QString str = html.getHtml();
+  return {str, 1 + str.count("<tr") + str.count("<br")};
+}
+
+uint qHash(const MapTooltip::FragmentKey& key)
+{
+  return static_cast<uint>(key.id) ^ static_cast<uint>(key.type) ^ (static_cast<uint>(key.extra) << 24);
 }
 
-/* Check if the result HTML has more than the allowed number of lines and add a "more" text */
-bool MapTooltip::checkText(HtmlBuilder& html)
+bool MapTooltip::FragmentKey::operator==(const MapTooltip::FragmentKey& other) const
 {
-  return html.checklengthTextBar(MAX_LINES, tr("More ..."), TEXT_BAR_LENGTH);
+  return type == other.type && id == other.id && extra == other.extra;
 }
@@ -18,8 +18,13 @@
 #ifndef LITTLENAVMAP_MAPTOOLTIP_H
 #define LITTLENAVMAP_MAPTOOLTIP_H
 
+#include "common/mapflags.h"
+
 #include <QColor>
 #include <QApplication>
+#include <QCache>
+
+#include <functional>
 
 namespace map {
 struct MapResult;
@@ -44,11 +49,16 @@ struct MapProcedurePoint;
 
 /*
  * Builds a HTML tooltip for map display with a maximum length of 20 lines.
+ *
+ * HTML fragments for database objects like airports or navaids are cached. Bearing and distance to the
+ * user aircraft are inserted on each call. Aircraft and other dynamic objects are always built new.
  */
 class MapTooltip
 {
   Q_DECLARE_TR_FUNCTIONS(MapTooltip)
 
+  struct FragmentKey;
+
 public:
   MapTooltip(MainWindow *parentWindow);
   virtual ~MapTooltip();
@@ -60,16 +70,50 @@ public:
    * @param route Needed to access route objects
    * @param airportDiagram set to true if the tooltip should also cover objects that are
    * displayed in airport diagrams.
+   * @param incomplete Set to true if building of uncached fragments was stopped since it took too long.
+   * Call again later to get the rest.
    * @return HTML code of the tooltip
    */
   QString buildTooltip(const map::MapResult& mapSearchResult, const Route& route,
-                       bool airportDiagram);
+                       bool airportDiagram, bool *incomplete = nullptr);
+
+  /* Remove all cached HTML fragments. Call after changes in database, flight plan, weather, options or style. */
+  void clearCache();
 
 private:
-  bool checkText(atools::util::HtmlBuilder& html);
+  friend uint qHash(const MapTooltip::FragmentKey& key);
+
+  /* HTML of one object in the tooltip */
+  struct Fragment
+  {
+    QString html;
+    int lines;
+  };
+
+  /* Key for cached fragments. extra is the flight plan index or the airspace source. */
+  struct FragmentKey
+  {
+    bool operator==(const MapTooltip::FragmentKey& other) const;
+
+    map::MapType type;
+    int id, extra;
+  };
+
+  typedef std::function<void(atools::util::HtmlBuilder& html)> FragmentFunctionType;
+
+  /* Build fragment using function and count lines */
+  static Fragment buildFragment(const FragmentFunctionType& func);
 
   static Q_DECL_CONSTEXPR int MAX_LINES = 20;
 
+  /* Number of cached objects */
+  static Q_DECL_CONSTEXPR int FRAGMENT_CACHE_SIZE = 500;
+
+  /* Stop building uncached fragments if this time is exceeded and continue in next call */
+  static Q_DECL_CONSTEXPR int MAX_BUILD_TIME_MS = 30;
+
+  QCache<FragmentKey, Fragment> fragmentCache;
+
   MainWindow *mainWindow = nullptr;
   MapQuery *mapQuery;
   WeatherReporter *weather;
@@ -45,6 +45,7 @@
 #include "mappainter/mappaintlayer.h"
 #include "navapp.h"
 #include "online/onlinedatacontroller.h"
+#include "query/airportquery.h"
 #include "route/routecontroller.h"
 #include "route/routealtitude.h"
 #include "settings/settings.h"
@@ -56,6 +57,8 @@
 #include <QToolTip>
 #include <QClipboard>
 
+#include <algorithm>
+
 #include <marble/AbstractFloatItem.h>
 #include <marble/MarbleWidgetInputHandler.h>
 #include <marble/MarbleModel.h>
@@ -137,6 +140,13 @@ MapWidget::MapWidget(MainWindow *parent)
   elevationDisplayTimer.setSingleShot(true);
   connect(&elevationDisplayTimer, &QTimer::timeout, this, &MapWidget::elevationDisplayTimerTimeout);
 
+  if(getExtrapolationUpdateMs() > 0)
+  {
+    extrapolationTimer.setInterval(getExtrapolationUpdateMs());
+    connect(&extrapolationTimer, &QTimer::timeout, this, &MapWidget::extrapolationTimerTimeout);
+    extrapolationTimer.start();
+  }
+
   jumpBack = new JumpBack(this);
   connect(jumpBack, &JumpBack::jumpBack, this, &MapWidget::jumpBackToAircraftTimeout);
 
@@ -163,6 +173,7 @@ MapWidget::MapWidget(MainWindow *parent)
 MapWidget::~MapWidget()
 {
   elevationDisplayTimer.stop();
+  extrapolationTimer.stop();
   takeoffLandingTimer.stop();
   fuelOnOffTimer.stop();
 
@@ -357,6 +368,9 @@ void MapWidget::takeoffLandingTimeout()
   {
     // On ground after status has changed
     qDebug() << Q_FUNC_INFO << "Landing detected takeoffLandingDistanceNm" << takeoffLandingDistanceNm;
+
+    // Aircraft has to line up again for the next takeoff
+    linedUpRunwayEndId = linedUpAirportId = -1;
     emit aircraftLanding(aircraft,
                          static_cast<float>(takeoffLandingDistanceNm),
                          static_cast<float>(takeoffLandingAverageTasKts));
@@ -487,15 +501,27 @@ void MapWidget::showTooltip(bool update)
     return;
 
   // Build a new tooltip HTML for weather changes or aircraft updates
+  bool incomplete = false;
   QString text = mapTooltip->buildTooltip(mapSearchResultTooltip, NavApp::getRouteConst(),
-                                          paintLayer->getMapLayer()->isAirportDiagram());
+                                          paintLayer->getMapLayer()->isAirportDiagram(), &incomplete);
 
   if(!text.isEmpty() && !tooltipPos.isNull())
+  {
     QToolTip::showText(tooltipPos, text /*, nullptr, QRect(), 3600 * 1000*/);
+
+    if(incomplete)
+      // Build remaining objects after processing pending events
+      QTimer::singleShot(0, this, &MapWidget::updateTooltip);
+  }
   else
     hideTooltip();
 }
 
+void MapWidget::clearTooltipCache()
+{
+  mapTooltip->clearCache();
+}
+
 /* Stop all line drag and drop if the map loses focus */
 void MapWidget::focusOutEvent(QFocusEvent *)
 {
@@ -1195,6 +1221,45 @@ void MapWidget::elevationDisplayTimerTimeout()
   }
 }
 
+void MapWidget::extrapolationTimerTimeout()
+{
+  if(databaseLoadStatus || contextMenuActive || mouseState != mw::NONE || viewContext() == Marble::Animation)
+    return;
+
+  map::MapTypes shown = paintLayer->getShownMapObjects();
+  if(!(shown & map::AIRCRAFT_AI || shown & map::AIRCRAFT_AI_SHIP || shown & map::AIRCRAFT_ONLINE))
+    return;
+
+  // Simulator data updates redraw anyway
+  if(QDateTime::currentMSecsSinceEpoch() - lastSimUpdateMs < extrapolationTimer.interval())
+    return;
+
+  // Redraw only if there is any moving aircraft in the view
+  const Marble::GeoDataLatLonBox& box = getCurrentViewBoundingBox();
+  auto moving = [&box](const atools::fs::sc::SimConnectAircraft& ac) -> bool {
+                  return ac.getGroundSpeedKts() > 1.f && ac.getGroundSpeedKts() < atools::fs::sc::SC_INVALID_FLOAT &&
+                         box.contains(Marble::GeoDataCoordinates(ac.getPosition().getLonX(), ac.getPosition().getLatY(),
+                                                                 0, Marble::GeoDataCoordinates::Degree));
+                };
+
+  bool redraw = false;
+  if(shown & map::AIRCRAFT_AI || shown & map::AIRCRAFT_AI_SHIP)
+    redraw = std::any_of(getAiAircraft().constBegin(), getAiAircraft().constEnd(), moving);
+
+  if(!redraw && shown & map::AIRCRAFT_ONLINE)
+  {
+    const QList<atools::fs::sc::SimConnectAircraft> *online = NavApp::getOnlinedataController()->getAircraftFromCache();
+    redraw = std::any_of(online->constBegin(), online->constEnd(), moving);
+  }
+
+  if(redraw)
+  {
+    // Not scrolled or zoomed - static layers can be taken from cache
+    paintLayer->setDynamicUpdateOnly();
+    update();
+  }
+}
+
 bool MapWidget::pointVisible(const QPoint& point)
 {
   qreal lon, lat;
@@ -2028,6 +2093,32 @@ void MapWidget::simDataCalcTakeoffLanding(const atools::fs::sc::SimConnectUserAi
   }
 }
 
+void MapWidget::simDataCalcLinedUp(const atools::fs::sc::SimConnectUserAircraft& aircraft)
+{
+  int runwayEndId = -1, airportId = -1;
+
+  // Lookup uses the in-memory runway index of the airport query and does not access the database
+  if(aircraft.isOnGround() && !aircraft.isSimPaused() && !aircraft.isSimReplay())
+    runwayEndId = NavApp::getAirportQuerySim()->getRunwayEndIdLinedUp(airportId, aircraft.getPosition(),
+                                                                      aircraft.getHeadingDegTrue());
+
+  if(runwayEndId != currentLinedUpRunwayEndId)
+  {
+    currentLinedUpRunwayEndId = runwayEndId;
+
+    if(runwayEndId != -1)
+    {
+      linedUpRunwayEndId = runwayEndId;
+      linedUpAirportId = airportId;
+
+      map::MapRunwayEnd runwayEnd = NavApp::getAirportQuerySim()->getRunwayEndById(runwayEndId);
+      map::MapAirport airport = NavApp::getAirportQuerySim()->getAirportById(airportId);
+      qDebug() << Q_FUNC_INFO << "Lined up on runway" << runwayEnd.name << "at" << airport.ident;
+      mainWindow->setStatusMessage(tr("Lined up on runway %1 at %2.").arg(runwayEnd.name).arg(airport.ident));
+    }
+  }
+}
+
 void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
   const atools::fs::sc::SimConnectUserAircraft& aircraft = simulatorData.getUserAircraftConst();
@@ -2044,10 +2135,7 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   simDataCalcTakeoffLanding(aircraft, last);
   simDataCalcFuelOnOff(aircraft, last);
 
-  // map::MapRunwayEnd runwayEnd;
-  // map::MapAirport airport;
-  // NavApp::getAirportQuerySim()->getBestRunwayEndForPosAndCourse(runwayEnd, airport,
-  // aircraft.getPosition(), aircraft.getTrackDegTrue());
+  simDataCalcLinedUp(aircraft);
 
   // Create screen coordinates =============================
   CoordinateConverter conv(viewport());
@@ -2262,8 +2350,11 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
         setUpdatesEnabled(true);
 
       if((dataHasChanged || aiVisible) && !contextMenuActive)
-        // Not scrolled or zoomed but needs a redraw
+      {
+        // Not scrolled or zoomed but needs a redraw - static layers can be taken from cache
+        paintLayer->setDynamicUpdateOnly();
         update();
+      }
     }
   }
   else if(paintLayer->getShownMapObjects() & map::AIRCRAFT_TRACK)
@@ -2274,7 +2365,10 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
       getScreenIndex()->updateLastSimData(simulatorData);
 
       if(!contextMenuActive)
+      {
+        paintLayer->setDynamicUpdateOnly();
         update();
+      }
     }
   }
 }
@@ -2451,6 +2545,7 @@ void MapWidget::optionsChanged()
 {
   screenSearchDistance = OptionData::instance().getMapClickSensitivity();
   screenSearchDistanceTooltip = OptionData::instance().getMapTooltipSensitivity();
+  mapTooltip->clearCache();
   MapPaintWidget::optionsChanged();
 }
 
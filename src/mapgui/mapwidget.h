@@ -109,6 +109,9 @@ public:
   void showTooltip(bool update);
   void updateTooltip();
 
+  /* Remove cached tooltip HTML after changes in database, flight plan, weather or style */
+  void clearTooltipCache();
+
   /* The main window show event was triggered after program startup. */
   void mainWindowShown();
 
@@ -127,6 +130,14 @@ public:
   /* New data from simconnect has arrived. Update aircraft position and track. */
   void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
 
+  /* Get runway end id of the last runway the user aircraft was lined up on before takeoff.
+   * Returns -1 if none was detected since the last landing. */
+  int getLinedUpRunwayEndId(int& airportId) const
+  {
+    airportId = linedUpAirportId;
+    return linedUpRunwayEndId;
+  }
+
   /* Update sun shading from UI elements */
   void updateSunShadingOption();
 
@@ -299,6 +310,9 @@ private:
   /* Display elevation at mouse cursor after a short timeout */
   void elevationDisplayTimerTimeout();
 
+  /* Redraw AI and online aircraft at extrapolated positions between data updates */
+  void extrapolationTimerTimeout();
+
   /* Start a line measurement after context menu selection or click+modifier */
   void addMeasurement(const atools::geo::Pos& pos, const map::MapResult& result);
   void addMeasurement(const atools::geo::Pos& pos, const map::MapAirport *airport, const map::MapVor *vor,
@@ -316,6 +330,9 @@ private:
   void simDataCalcFuelOnOff(const atools::fs::sc::SimConnectUserAircraft& aircraft,
                             const atools::fs::sc::SimConnectUserAircraft& last);
 
+  /* Detect aircraft lining up on a runway */
+  void simDataCalcLinedUp(const atools::fs::sc::SimConnectUserAircraft& aircraft);
+
   /* Center aircraft again after scrolling or zooming */
   void jumpBackToAircraftTimeout(const QVariantList& values);
 
@@ -418,6 +435,9 @@ private:
   /* Delay display of elevation display to avoid lagging mouse movements */
   QTimer elevationDisplayTimer;
 
+  /* Periodic redraw for dead reckoning of AI and online aircraft */
+  QTimer extrapolationTimer;
+
   /* Delay takeoff and landing messages to avoid false recognition of bumpy landings */
   QTimer takeoffLandingTimer, fuelOnOffTimer;
 
@@ -433,6 +453,12 @@ private:
   /* Last sample from average value calculation */
   qint64 takeoffLastSampleTimeMs = 0L;
 
+  /* Runway end the aircraft is currently lined up on or -1 */
+  int currentLinedUpRunwayEndId = -1;
+
+  /* Last runway end and airport the aircraft was lined up on. Reset on landing. */
+  int linedUpRunwayEndId = -1, linedUpAirportId = -1;
+
   JumpBack *jumpBack;
 
   /* Sum up mouse wheel or trackpad movement before zooming */
@@ -26,6 +26,8 @@
 #include "common/maptypes.h"
 #include "mapgui/maplayer.h"
 #include "common/aircrafttrack.h"
+#include "common/constants.h"
+#include "settings/settings.h"
 
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
@@ -91,6 +93,8 @@ MapPainter::MapPainter(MapPaintWidget *parentMapWidget, MapScale *mapScale, Pain
   waypointQuery = NavApp::getWaypointTrackQuery();
   airportQuery = NavApp::getAirportQuerySim();
   symbolPainter = new SymbolPainter();
+  symbolPainter->setSpritesEnabled(atools::settings::Settings::instance().
+                                   getAndStoreValue(lnm::OPTIONS_MAP_SYMBOL_SPRITES, true).toBool());
 }
 
 MapPainter::~MapPainter()
@@ -99,13 +99,17 @@ void MapPainterAircraft::render()
       return ai1.distanceLateralMeter > ai2.distanceLateralMeter;
     });
 
+    // Time since last update for dead reckoning
+    float secondsSim = mapPaintWidget->getExtrapolationSeconds(false /* online */);
+    float secondsOnline = mapPaintWidget->getExtrapolationSeconds(true /* online */);
+
     int num = aiSorted.size();
     for(const AiDistType& adt : aiSorted)
     {
       const SimConnectAircraft& ac = *adt.aircraft;
       if(mapfunc::aircraftVisible(ac, context->mapLayer))
       {
-        paintAiVehicle(ac, --num < NUM_CLOSEST_AI_LABELS &&
+        paintAiVehicle(ac, ac.isOnline() ? secondsOnline : secondsSim, --num < NUM_CLOSEST_AI_LABELS &&
                        adt.distanceLateralMeter < DIST_METER_CLOSEST_AI_LABELS &&
                        adt.distanceVerticalFt < DIST_FT_CLOSEST_AI_LABELS);
       }
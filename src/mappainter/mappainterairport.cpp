@@ -31,6 +31,7 @@
 #include "route/routecontroller.h"
 #include "util/paintercontextsaver.h"
 #include "mapgui/aprongeometrycache.h"
+#include "mapgui/airportdiagramcache.h"
 #include "atools.h"
 #include "navapp.h"
 
@@ -179,26 +180,26 @@ void MapPainterAirport::drawAirportDiagramBackground(const map::MapAirport& airp
                        scale->getPixelIntForMeter(AIRPORT_DIAGRAM_BACKGROUND_METER),
                        Qt::SolidLine, Qt::RoundCap));
 
+  // Get projected geometry relative to refPoint
+  QPointF refPoint;
+  const AirportDiagram *diagram = airportDiagram(airport, refPoint);
+  QPoint refPointInt = refPoint.toPoint();
+
   if(context->flags2.testFlag(opts2::MAP_AIRPORT_RUNWAYS))
   {
     // Get all runways for this airport
     const QList<MapRunway> *runways = airportQuery->getRunways(airport.id);
 
-    // Calculate all runway screen coordinates
-    QList<QPoint> runwayCenters;
-    QList<QRect> runwayRects, runwayOutlineRects;
-    runwayCoords(runways, &runwayCenters, &runwayRects, nullptr, &runwayOutlineRects, false /* overview */);
-
     // Draw white background ---------------------------------
     // For runways
-    for(int i = 0; i < runwayCenters.size(); i++)
+    for(int i = 0; i < diagram->runwayCenters.size(); i++)
     {
       if(runways->at(i).surface != "W")
       {
-        painter->translate(runwayCenters.at(i));
+        painter->translate(refPointInt + diagram->runwayCenters.at(i));
         painter->rotate(runways->at(i).heading);
 
-        const QRect backRect = runwayOutlineRects.at(i);
+        const QRect backRect = diagram->runwayOutlineRects.at(i);
         painter->drawRect(backRect);
         painter->resetTransform();
       }
@@ -208,36 +209,92 @@ void MapPainterAirport::drawAirportDiagramBackground(const map::MapAirport& airp
   if(context->mapLayerEffective->isAirportDiagram() && context->flags2.testFlag(opts2::MAP_AIRPORT_DIAGRAM))
   {
     // For taxipaths
-    const QList<MapTaxiPath> *taxipaths = airportQuery->getTaxiPaths(airport.id);
-    for(const MapTaxiPath& taxipath : *taxipaths)
-    {
-      bool visible;
-      QPoint start = wToS(taxipath.start, DEFAULT_WTOS_SIZE, &visible);
-      QPoint end = wToS(taxipath.end, DEFAULT_WTOS_SIZE, &visible);
-      painter->drawLine(start, end);
-    }
+    for(const QLineF& line : diagram->taxiLines)
+      painter->drawLine(line.p1() + refPoint, line.p2() + refPoint);
 
     // For aprons
     const QList<MapApron> *aprons = airportQuery->getAprons(airport.id);
-    for(const MapApron& apron : *aprons)
+    for(int i = 0; i < aprons->size(); i++)
     {
+      const MapApron& apron = aprons->at(i);
+
       // FSX/P3D geometry
       if(!apron.vertices.isEmpty())
-        drawFsApron(apron);
+        drawFsApron(diagram->aprons.at(i), refPoint);
       if(!apron.geometry.boundary.isEmpty())
         drawXplaneApron(apron, true /* draw fast */);
     }
   }
 }
 
-/* Draw simple FSX/P3D aprons */
-void MapPainterAirport::drawFsApron(const map::MapApron& apron)
+const AirportDiagram *MapPainterAirport::airportDiagram(const map::MapAirport& airport, QPointF& refPoint)
 {
-  QVector<QPoint> apronPoints;
+  // All cached coordinates are relative to the airport position
   bool visible;
-  for(const Pos& pos : apron.vertices)
-    apronPoints.append(wToS(pos, DEFAULT_WTOS_SIZE, &visible));
-  context->painter->QPainter::drawPolygon(apronPoints.data(), apronPoints.size());
+  refPoint = wToSF(airport.position, DEFAULT_WTOS_SIZE, &visible);
+
+  bool detail = context->mapLayerEffective->isAirportDiagram();
+  int projection = static_cast<int>(context->viewport->projection());
+  AirportDiagramCache *cache = mapPaintWidget->getAirportDiagramCache();
+
+  // Use cached diagram if it has all needed details
+  const AirportDiagram *diagram = cache->getDiagram(airport.id, context->zoomDistanceMeter, projection);
+  if(diagram != nullptr && (diagram->detail || !detail))
+    return diagram;
+
+  AirportDiagram *newDiagram = new AirportDiagram;
+  newDiagram->detail = detail;
+
+  // Runways ------------------------------------------------
+  runwayCoords(airportQuery->getRunways(airport.id), &newDiagram->runwayCenters, &newDiagram->runwayRects, nullptr,
+               &newDiagram->runwayOutlineRects, false /* overview */);
+
+  QPoint refPointInt = refPoint.toPoint();
+  for(QPoint& center : newDiagram->runwayCenters)
+    center -= refPointInt;
+
+  if(detail)
+  {
+    // Taxiways ------------------------------------------------
+    // Do not do any clipping here
+    for(const MapTaxiPath& taxipath : *airportQuery->getTaxiPaths(airport.id))
+    {
+      newDiagram->taxiLines.append(QLineF(wToSF(taxipath.start, DEFAULT_WTOS_SIZE, &visible) - refPoint,
+                                          wToSF(taxipath.end, DEFAULT_WTOS_SIZE, &visible) - refPoint));
+
+      if(taxipath.width == 0)
+        // Special X-Plane case - width is not given for path
+        newDiagram->taxiThickness.append(0);
+      else
+        newDiagram->taxiThickness.append(std::max(2, scale->getPixelIntForFeet(taxipath.width)));
+    }
+
+    // FSX/P3D aprons ------------------------------------------------
+    // X-Plane aprons are cached in ApronGeometryCache
+    for(const MapApron& apron : *airportQuery->getAprons(airport.id))
+    {
+      QPolygonF polygon;
+      for(const Pos& pos : apron.vertices)
+        polygon.append(wToSF(pos, DEFAULT_WTOS_SIZE, &visible) - refPoint);
+      newDiagram->aprons.append(polygon);
+    }
+
+    // Parking and helipads ------------------------------------------------
+    for(const MapParking& parking : *airportQuery->getParkingsForAirport(airport.id))
+      newDiagram->parkings.append(wToSF(parking.position, DEFAULT_WTOS_SIZE, &visible) - refPoint);
+
+    for(const MapHelipad& helipad : *airportQuery->getHelipads(airport.id))
+      newDiagram->helipads.append(wToSF(helipad.position, DEFAULT_WTOS_SIZE, &visible) - refPoint);
+  }
+
+  cache->insert(airport.id, context->zoomDistanceMeter, projection, newDiagram);
+  return newDiagram;
+}
+
+/* Draw simple FSX/P3D aprons */
+void MapPainterAirport::drawFsApron(const QPolygonF& apron, const QPointF& refPoint)
+{
+  context->painter->QPainter::drawPolygon(apron.translated(refPoint));
 }
 
 void MapPainterAirport::drawXplaneApron(const map::MapApron& apron, bool fast)
@@ -260,8 +317,12 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
   painter->setBackgroundMode(Qt::OpaqueMode);
   painter->setFont(context->defaultFont);
 
+  // Get projected geometry relative to refPoint
+  QPointF refPoint;
+  const AirportDiagram *diagram = airportDiagram(airport, refPoint);
+
   QList<QPoint> runwayCenters;
-  QList<QRect> runwayRects, runwayOutlineRects;
+  const QList<QRect>& runwayRects = diagram->runwayRects;
 
   const QList<MapRunway> *runways = nullptr;
   if(context->flags2.testFlag(opts2::MAP_AIRPORT_RUNWAYS))
@@ -269,8 +330,10 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
     // Get all runways for this airport
     runways = airportQuery->getRunways(airport.id);
 
-    // Calculate all runway screen coordinates
-    runwayCoords(runways, &runwayCenters, &runwayRects, nullptr, &runwayOutlineRects, false /* overview */);
+    // Move cached runway centers into place
+    QPoint refPointInt = refPoint.toPoint();
+    for(const QPoint& center : diagram->runwayCenters)
+      runwayCenters.append(refPointInt + center);
 
     if(!fast && context->flags2 & opts2::MAP_AIRPORT_DIAGRAM && context->mapLayerEffective->isAirportDiagram())
     {
@@ -299,8 +362,10 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
       painter->setBackground(Qt::transparent);
       const QList<MapApron> *aprons = airportQuery->getAprons(airport.id);
 
-      for(const MapApron& apron : *aprons)
+      for(int i = 0; i < aprons->size(); i++)
       {
+        const MapApron& apron = aprons->at(i);
+
         // Draw aprons a bit darker so we can see the taxiways
         QColor col = mapcolors::colorForSurface(apron.surface);
         col = col.darker(110);
@@ -315,7 +380,7 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
 
         // FSX/P3D geometry
         if(!apron.vertices.isEmpty())
-          drawFsApron(apron);
+          drawFsApron(diagram->aprons.at(i), refPoint);
 
         // X-Plane geometry
         if(!apron.geometry.boundary.isEmpty())
@@ -324,23 +389,15 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
 
       // Draw taxiways ---------------------------------
       painter->setBackgroundMode(Qt::OpaqueMode);
-      QVector<QPoint> startPts, endPts;
-      QVector<int> pathThickness;
+      QVector<QPointF> startPts, endPts;
+      const QVector<int>& pathThickness = diagram->taxiThickness;
 
-      // Collect coordinates first
+      // Move cached coordinates into place
       const QList<MapTaxiPath> *taxipaths = airportQuery->getTaxiPaths(airport.id);
-      for(const MapTaxiPath& taxipath : *taxipaths)
+      for(const QLineF& line : diagram->taxiLines)
       {
-        bool visible;
-        // Do not do any clipping here
-        startPts.append(wToS(taxipath.start, DEFAULT_WTOS_SIZE, &visible));
-        endPts.append(wToS(taxipath.end, DEFAULT_WTOS_SIZE, &visible));
-
-        if(taxipath.width == 0)
-          // Special X-Plane case - width is not given for path
-          pathThickness.append(0);
-        else
-          pathThickness.append(std::max(2, scale->getPixelIntForFeet(taxipath.width)));
+        startPts.append(line.p1() + refPoint);
+        endPts.append(line.p2() + refPoint);
       }
 
       // Draw closed and other taxi paths first to have real taxiways on top
@@ -353,8 +410,8 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
         {
           QColor col = mapcolors::colorForSurface(taxipath.surface);
 
-          const QPoint& start = startPts.at(i);
-          const QPoint& end = endPts.at(i);
+          const QPointF& start = startPts.at(i);
+          const QPointF& end = endPts.at(i);
 
           if(taxipath.closed)
           {
@@ -593,15 +650,21 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
   QMargins margins(size, size, size, size);
   QMargins marginsSmall(30, 30, 30, 30);
 
+  // Screen rectangles for visibility checks of cached coordinates
+  QRectF screenRect(0., 0., context->viewport->width(), context->viewport->height());
+  QRectF screenRectBuf = screenRect.marginsAdded(margins), screenRectBufSmall = screenRect.marginsAdded(marginsSmall);
+
   if(context->flags2 & opts2::MAP_AIRPORT_DIAGRAM && context->mapLayerEffective->isAirportDiagram())
   {
     // Draw parking --------------------------------
     const QList<MapParking> *parkings = airportQuery->getParkingsForAirport(airport.id);
-    for(const MapParking& parking : *parkings)
+    for(int i = 0; i < parkings->size(); i++)
     {
-      float x, y;
-      if(wToSBuf(parking.position, x, y, margins))
+      const MapParking& parking = parkings->at(i);
+      QPointF pt = diagram->parkings.at(i) + refPoint;
+      if(screenRectBuf.contains(pt))
       {
+        float x = static_cast<float>(pt.x()), y = static_cast<float>(pt.y());
         // Calculate approximate screen width and height
         int w = scale->getPixelIntForFeet(parking.radius, 90);
         int h = scale->getPixelIntForFeet(parking.radius, 0);
@@ -629,11 +692,13 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
     const QList<MapHelipad> *helipads = airportQuery->getHelipads(airport.id);
     if(!helipads->isEmpty())
     {
-      for(const MapHelipad& helipad : *helipads)
+      for(int i = 0; i < helipads->size(); i++)
       {
-        float x, y;
-        if(wToSBuf(helipad.position, x, y, margins))
+        const MapHelipad& helipad = helipads->at(i);
+        QPointF pt = diagram->helipads.at(i) + refPoint;
+        if(screenRectBuf.contains(pt))
         {
+          float x = static_cast<float>(pt.x()), y = static_cast<float>(pt.y());
           int w = scale->getPixelIntForFeet(helipad.width, 90) / 2;
           int h = scale->getPixelIntForFeet(helipad.length, 0) / 2;
           symbolPainter->drawHelipadSymbol(painter, helipad, x, y, w, h, fast);
@@ -672,13 +737,15 @@ void MapPainterAirport::drawAirportDiagram(const map::MapAirport& airport)
     QFontMetrics metrics = painter->fontMetrics();
     if(!fast && context->mapLayerEffective->isAirportDiagramDetail())
     {
-      for(const MapParking& parking : *parkings)
+      for(int i = 0; i < parkings->size(); i++)
       {
+        const MapParking& parking = parkings->at(i);
         if(context->mapLayerEffective->isAirportDiagramDetail2() || parking.radius > 40)
         {
-          float x, y;
-          if(wToSBuf(parking.position, x, y, marginsSmall))
+          QPointF pt = diagram->parkings.at(i) + refPoint;
+          if(screenRectBufSmall.contains(pt))
           {
+            float x = static_cast<float>(pt.x()), y = static_cast<float>(pt.y());
             // Use different text pen for better readability depending on background
             painter->setPen(QPen(mapcolors::colorTextForParkingType(parking.type), 2, Qt::SolidLine, Qt::FlatCap));
 
@@ -34,6 +34,7 @@ struct MapRunway;
 }
 
 struct PaintAirportType;
+struct AirportDiagram;
 
 /*
  * Draws airport symbols, runway overview and complete airport diagram. Airport details are also drawn for
@@ -60,7 +61,11 @@ private:
   void drawAirportSymbolOverview(const map::MapAirport& ap, float x, float y);
   void runwayCoords(const QList<map::MapRunway> *runways, QList<QPoint> *centers, QList<QRect> *rects,
                     QList<QRect> *innerRects, QList<QRect> *outlineRects, bool overview);
-  void drawFsApron(const map::MapApron& apron);
+  void drawFsApron(const QPolygonF& apron, const QPointF& refPoint);
+
+  /* Get projected runway, taxiway, apron and parking geometry from the cache or create it.
+   * refPoint is set to the screen position of the airport which has to be added to all coordinates. */
+  const AirportDiagram *airportDiagram(const map::MapAirport& airport, QPointF& refPoint);
   void drawXplaneApron(const map::MapApron& apron, bool fast);
 
 };
@@ -26,8 +26,8 @@
 #include "navapp.h"
 #include "atools.h"
 #include "fs/common/morareader.h"
+#include "geo/linestring.h"
 
-#include <QElapsedTimer>
 
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
@@ -36,6 +36,10 @@ using namespace Marble;
 using namespace atools::geo;
 using map::MapIls;
 
+/* Grid dimensions. Rows are indexed by top latitude -89 to 90 and columns by left longitude -180 to 179. */
+static const int MORA_COLUMNS = 360;
+static const int MORA_ROWS = 180;
+
 MapPainterAltitude::MapPainterAltitude(MapPaintWidget *mapWidget, MapScale *mapScale, PaintContext *paintContext)
   : MapPainter(mapWidget, mapScale, paintContext)
 {
@@ -45,17 +49,134 @@ MapPainterAltitude::~MapPainterAltitude()
 {
 }
 
-void MapPainterAltitude::render()
+void MapPainterAltitude::clearMoraCache()
+{
+  moraValues.clear();
+  horizontalRuns.clear();
+  verticalRuns.clear();
+  labelWidths.clear();
+}
+
+void MapPainterAltitude::buildMoraCache(atools::fs::common::MoraReader *moraReader)
 {
   using atools::fs::common::MoraReader;
 
+  clearMoraCache();
+
+  // Copy all values to avoid the reader calls for each frame ====================
+  moraValues.fill(-1, MORA_COLUMNS * MORA_ROWS);
+  for(int laty = -89; laty <= 90; laty++)
+  {
+    for(int lonx = -180; lonx <= 179; lonx++)
+    {
+      int moraFt100 = moraReader->getMoraFt(lonx, laty);
+      if(moraFt100 > 10 && moraFt100 != MoraReader::OCEAN && moraFt100 != MoraReader::UNKNOWN &&
+         moraFt100 != MoraReader::ERROR)
+        moraValues[(laty + 89) * MORA_COLUMNS + lonx + 180] = static_cast<qint16>(moraFt100);
+    }
+  }
+
+  // Horizontal edges on each latitude - edge is needed if the cell above or below has a value ============
+  // Cell with top at laty covers latitudes laty - 1 to laty
+  for(int laty = -90; laty <= 90; laty++)
+  {
+    int from = -1000;
+    for(int lonx = -180; lonx <= 180; lonx++)
+    {
+      bool edge = lonx < 180 && (moraValue(lonx, laty) != -1 || moraValue(lonx, laty + 1) != -1);
+      if(edge && from == -1000)
+        from = lonx;
+      else if(!edge && from != -1000)
+      {
+        horizontalRuns.append({laty, from, lonx});
+        from = -1000;
+      }
+    }
+  }
+
+  // Vertical edges on each longitude - edge is needed if the cell left or right has a value ============
+  for(int lonx = -180; lonx <= 180; lonx++)
+  {
+    int from = -1000;
+    for(int laty = -89; laty <= 91; laty++)
+    {
+      bool edge = laty <= 90 && (moraValue(lonx, laty) != -1 || moraValue(lonx - 1, laty) != -1);
+      if(edge && from == -1000)
+        from = laty - 1;
+      else if(!edge && from != -1000)
+      {
+        verticalRuns.append({lonx, from, laty - 1});
+        from = -1000;
+      }
+    }
+  }
+}
+
+int MapPainterAltitude::moraValue(int lonx, int laty) const
+{
+  if(lonx < -180 || lonx > 179 || laty < -89 || laty > 90 || moraValues.isEmpty())
+    return -1;
+  else
+    return moraValues.at((laty + 89) * MORA_COLUMNS + lonx + 180);
+}
+
+void MapPainterAltitude::drawRuns(const QVector<MoraRun>& runs, bool horizontal, int fixedMin, int fixedMax,
+                                  int fromMin, int toMax)
+{
+  for(const MoraRun& run : runs)
+  {
+    if(run.fixed < fixedMin || run.fixed > fixedMax)
+      continue;
+
+    int from = std::max(run.from, fromMin), to = std::min(run.to, toMax);
+    if(from >= to)
+      continue;
+
+    LineString line;
+    for(int i = from; i <= to; i++)
+      line.append(horizontal ? Pos(static_cast<float>(i), static_cast<float>(run.fixed)) :
+                  Pos(static_cast<float>(run.fixed), static_cast<float>(i)));
+    drawLineString(context->painter, line);
+  }
+}
+
+qreal MapPainterAltitude::labelWidth(int moraFt100, const QFont& font, const QFontMetricsF& fontmetrics)
+{
+  if(font != labelFont)
+  {
+    labelWidths.clear();
+    labelFont = font;
+  }
+
+  auto it = labelWidths.constFind(moraFt100);
+  if(it != labelWidths.constEnd())
+    return it.value();
+
+  qreal width = fontmetrics.width(QString::number(moraFt100 / 10));
+  labelWidths.insert(moraFt100, width);
+  return width;
+}
+
+void MapPainterAltitude::prepareMoraCache()
+{
+  if(moraValues.isEmpty() && context->objectDisplayTypes.testFlag(map::MINIMUM_ALTITUDE) &&
+     context->mapLayer->isMinimumAltitude())
+  {
+    atools::fs::common::MoraReader *moraReader = NavApp::getMoraReader();
+    if(moraReader->isDataAvailable())
+      buildMoraCache(moraReader);
+  }
+}
+
+void MapPainterAltitude::render()
+{
   if(!context->objectDisplayTypes.testFlag(map::MINIMUM_ALTITUDE))
     return;
 
   if(context->mapLayer->isMinimumAltitude())
   {
-    MoraReader *moraReader = NavApp::getMoraReader();
-    if(moraReader->isDataAvailable())
+    // Filled by prepareMoraCache() in the GUI thread
+    if(!moraValues.isEmpty())
     {
       atools::util::PainterContextSaver paintContextSaver(context->painter);
 
@@ -82,6 +203,16 @@ void MapPainterAltitude::render()
         ranges.append(std::make_pair(-180, east));
       }
 
+      // Draw merged grid edges - cells with top laty from south to north + 1 ======================
+      for(const std::pair<int, int>& range : ranges)
+      {
+        drawRuns(horizontalRuns, true /* horizontal */, south - 1, north + 1, range.first, range.second + 1);
+        drawRuns(verticalRuns, false /* horizontal */, range.first, range.second + 1, south - 1, north + 1);
+      }
+
+      if(context->drawFast)
+        return;
+
       // Altitude values
       QVector<int> altitudes;
       // Minimum rectangle width on screen in pixel
@@ -89,7 +220,7 @@ void MapPainterAltitude::render()
       // Center points for rectangles for text placement
       QVector<GeoDataCoordinates> centers;
 
-      // Draw rectangles and collect other values for text placement ================================
+      // Collect values for text placement ================================
       for(int laty = south; laty <= north + 1; laty++)
       {
         // Iterate over anti-meridian split
@@ -97,38 +228,26 @@ void MapPainterAltitude::render()
         {
           for(int lonx = range.first; lonx <= range.second; lonx++)
           {
-            int moraFt100 = moraReader->getMoraFt(lonx, laty);
-            if(moraFt100 > 10 && moraFt100 != MoraReader::OCEAN && moraFt100 != MoraReader::UNKNOWN &&
-               moraFt100 != MoraReader::ERROR)
+            int moraFt100 = moraValue(lonx, laty);
+            if(moraFt100 != -1)
             {
-              // Build rectangle
-              float lonxF = static_cast<float>(lonx);
-              float latyF = static_cast<float>(laty);
-              drawLine(context->painter, Line(lonxF, latyF, lonxF + 1.f, latyF));
-              drawLine(context->painter, Line(lonxF + 1.f, latyF, lonxF + 1, latyF - 1.f));
-              drawLine(context->painter, Line(lonxF + 1.f, latyF - 1, lonxF, latyF - 1.f));
-              drawLine(context->painter, Line(lonxF, latyF - 1.f, lonxF, latyF));
-
-              if(!context->drawFast)
-              {
-                // Calculate rectangle screen width
-                bool visibleDummy;
-                QPointF leftPt = wToSF(GeoDataCoordinates(lonx, laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
-                QPointF rightPt =
-                  wToSF(GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
-
-                minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
-
-                centers.append(GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG));
-                altitudes.append(moraFt100);
-              }
+              // Calculate rectangle screen width
+              bool visibleDummy;
+              QPointF leftPt = wToSF(GeoDataCoordinates(lonx, laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
+              QPointF rightPt =
+                wToSF(GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
+
+              minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
+
+              centers.append(GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG));
+              altitudes.append(moraFt100);
             }
           } // for(int lonx = range.first; lonx <= range.second; lonx++)
         } // for(const std::pair<int, int>& range : ranges)
       } // for(int laty = south; laty <= north + 1; laty++)
 
       // Draw texts =================================================================
-      if(!context->drawFast && minWidth > 20.f)
+      if(minWidth > 20.f)
       {
         // Adjust minmum and maximum font height based on rectangle width
         minWidth = std::max(minWidth * 0.6f, 25.f);
@@ -157,11 +276,10 @@ void MapPainterAltitude::render()
 
             if(!hidden)
             {
-              QString numTxt = QString::number(altitudes.at(i) / 10);
-              qreal w = fontmetrics.width(numTxt);
+              qreal w = labelWidth(altitudes.at(i), font, fontmetrics);
               pt += QPointF(-w * 0.7, fontmetrics.height() / 2. - fontmetrics.descent());
 
-              context->painter->drawText(pt, numTxt);
+              context->painter->drawText(pt, QString::number(altitudes.at(i) / 10));
               baseline.append(QPointF(pt.x() + w, pt.y()));
             }
             else
@@ -185,7 +303,7 @@ void MapPainterAltitude::render()
             }
           }
         } // if(fontmetrics.height() > ...)
-      } // if(!context->drawFast)
-    } // if(moraReader->isDataAvailable())
+      } // if(minWidth > 20.f)
+    } // if(!moraValues.isEmpty())
   } // if(context->mapLayer->isMinimumAltitude())
 }
@@ -20,8 +20,19 @@
 
 #include "mappainter/mappainter.h"
 
+#include <QFont>
+#include <QHash>
+
 class SymbolPainter;
 
+namespace atools {
+namespace fs {
+namespace common {
+class MoraReader;
+}
+}
+}
+
 /*
  * Draws MORA (minimum off route altitude) data and grid on the map
  */
@@ -32,8 +43,43 @@ public:
   MapPainterAltitude(MapPaintWidget *mapPaintWidget, MapScale *mapScale, PaintContext *paintContext);
   virtual ~MapPainterAltitude() override;
 
+  /* Uses only the cached grid and can run in a worker thread. prepareMoraCache() has to be called before. */
   virtual void render() override;
 
+  /* Fetch the MORA grid and build the cache if empty and the grid is to be shown. Waits for the grid to be
+   * loaded. Has to be called in the GUI thread. */
+  void prepareMoraCache();
+
+  /* Drop grid geometry and labels. Has to be called after MORA data was reloaded. */
+  void clearMoraCache();
+
+private:
+  /* Consecutive grid edges on one grid line merged into one run.
+   * fixed is the latitude for horizontal and longitude for vertical runs. */
+  struct MoraRun
+  {
+    int fixed, from, to;
+  };
+
+  /* Copy grid values and build merged edges once per data load */
+  void buildMoraCache(atools::fs::common::MoraReader *moraReader);
+
+  /* Value in 100 ft for cell having the top left corner at lonx/laty or -1 if no value */
+  int moraValue(int lonx, int laty) const;
+
+  /* Draw runs clipped to the given range. Points are added at each degree to keep the original geometry. */
+  void drawRuns(const QVector<MoraRun>& runs, bool horizontal, int fixedMin, int fixedMax, int fromMin, int toMax);
+
+  /* Width of the big thousands number label. Cached for the current font size. */
+  qreal labelWidth(int moraFt100, const QFont& font, const QFontMetricsF& fontmetrics);
+
+  /* One value per degree cell. Cells with ocean, unknown or error are -1. */
+  QVector<qint16> moraValues;
+  QVector<MoraRun> horizontalRuns, verticalRuns;
+
+  /* Label width by MORA value for labelFont */
+  QHash<int, qreal> labelWidths;
+  QFont labelFont;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERALTITUDE_H
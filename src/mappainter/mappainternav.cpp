@@ -63,9 +63,10 @@ void MapPainterNav::render()
   if(drawAirway && !context->isOverflow())
   {
     // Draw airway lines
-    QList<MapAirway> airways;
-    airwayQuery->getAirways(airways, curBox, context->mapLayer, context->lazyUpdate);
-    paintAirways(&airways, context->drawFast);
+    const QVector<MapAirwayLine> *lines = nullptr;
+    const QList<MapAirway> *airways = airwayQuery->getAirways(curBox, context->mapLayer, context->lazyUpdate, &lines);
+    if(airways != nullptr)
+      paintAirways(airways, lines, context->drawFast);
   }
 
   // Tracks -------------------------------------------------
@@ -73,9 +74,10 @@ void MapPainterNav::render()
   if(drawTrack && !context->isOverflow())
   {
     // Draw track lines
-    QList<MapAirway> tracks;
-    airwayQuery->getTracks(tracks, curBox, context->mapLayer, context->lazyUpdate);
-    paintAirways(&tracks, context->drawFast);
+    const QVector<MapAirwayLine> *lines = nullptr;
+    const QList<MapAirway> *tracks = airwayQuery->getTracks(curBox, context->mapLayer, context->lazyUpdate, &lines);
+    if(tracks != nullptr)
+      paintAirways(tracks, lines, context->drawFast);
   }
 
   context->szFont(context->textSizeNavaid);
@@ -116,7 +118,7 @@ void MapPainterNav::render()
 }
 
 /* Draw airways and texts */
-void MapPainterNav::paintAirways(const QList<MapAirway> *airways, bool fast)
+void MapPainterNav::paintAirways(const QList<MapAirway> *airways, const QVector<MapAirwayLine> *airwayLines, bool fast)
 {
   QFontMetrics metrics = context->painter->fontMetrics();
 
@@ -154,113 +156,155 @@ void MapPainterNav::paintAirways(const QList<MapAirway> *airways, bool fast)
   QPolygonF arrowTrack = buildArrow(static_cast<float>(linewidthTrack * 2.5));
   Marble::GeoPainter *painter = context->painter;
 
-  for(int i = 0; i < airways->size(); i++)
+  const GeoDataLatLonAltBox& viewBox = context->viewport->viewLatLonAltBox();
+
+  // Add text for the segment at index i to the text index
+  auto addText = [&](int i, const QString& text) -> void
+                 {
+                   const MapAirway& airway = airways->at(i);
+                   QString firstCoordStr = airway.from.toString(3, false /*altitude*/);
+                   QString toCoordStr = airway.to.toString(3, false /*altitude*/);
+
+                   // Create string key for index by using the coordinates
+                   QString lineTextKey = firstCoordStr + "|" + toCoordStr;
+
+                   bool reversed = false;
+
+                   // Does it already exist in the map?
+                   int index = lines.value(lineTextKey, -1);
+                   if(index == -1)
+                   {
+                     // Try with reversed coordinates
+                     index = lines.value(toCoordStr + "|" + firstCoordStr, -1);
+                     reversed = index != -1;
+                   }
+
+                   if(index != -1)
+                   {
+                     // Index already found - add the new text to the present one
+                     textlist[index].texts.append(text);
+                     textlist[index].airwayIndexByText.append(i);
+                     textlist[index].positionReversed.append(reversed);
+                   }
+                   else
+                   {
+                     // Neither with forward nor reversed coordinates found - insert a new entry
+                     textlist.append(Place(text, i, reversed));
+                     lines.insert(lineTextKey, textlist.size() - 1);
+                   }
+                 };
+
+  // Segments of one line have the same name, fragment and type
+  for(const MapAirwayLine& airwayLine : *airwayLines)
   {
-    const MapAirway& airway = airways->at(i);
-    bool isTrack = airway.isTrack();
+    const MapAirway& first = airways->at(airwayLine.indexes.first());
+    bool isTrack = first.isTrack();
 
     bool ident = (!isTrack && context->mapLayer->isAirwayIdent()) || (isTrack && context->mapLayer->isTrackIdent());
     bool info = (!isTrack && context->mapLayer->isAirwayInfo()) || (isTrack && context->mapLayer->isTrackInfo());
 
-    if(airway.type == map::AIRWAY_JET && !context->objectTypes.testFlag(map::AIRWAYJ))
+    if(first.type == map::AIRWAY_JET && !context->objectTypes.testFlag(map::AIRWAYJ))
       continue;
-    if(airway.type == map::AIRWAY_VICTOR && !context->objectTypes.testFlag(map::AIRWAYV))
+    if(first.type == map::AIRWAY_VICTOR && !context->objectTypes.testFlag(map::AIRWAYV))
       continue;
     if(isTrack && !context->objectTypes.testFlag(map::TRACK))
       continue;
 
-    painter->setPen(QPen(mapcolors::colorForAirwayTrack(airway), isTrack ? linewidthTrack : linewidthAirway));
+    // Check bounding rect of the whole line for visibility
+    const Rect& bnd = airwayLine.bounding;
+    Marble::GeoDataLatLonBox linebox(bnd.getNorth(), bnd.getSouth(), bnd.getEast(), bnd.getWest(),
+                                     Marble::GeoDataCoordinates::Degree);
+    if(!linebox.intersects(viewBox))
+      continue;
+
+    if(context->objCount())
+      return;
+
+    painter->setPen(QPen(mapcolors::colorForAirwayTrack(first), isTrack ? linewidthTrack : linewidthAirway));
     painter->setBrush(painter->pen().color());
 
-    // Get start and end point of airway segment in screen coordinates
-    int x1, y1, x2, y2;
-    bool visible1 = wToS(airway.from, x1, y1);
-    bool visible2 = wToS(airway.to, x2, y2);
+    // Draw all segments at once
+    drawLineString(painter, airwayLine.line);
 
-    if(!visible1 && !visible2)
-    {
-      // Check bounding rect for visibility
-      const Rect& bnd = airway.bounding;
-      Marble::GeoDataLatLonBox airwaybox(bnd.getNorth(), bnd.getSouth(), bnd.getEast(), bnd.getWest(),
-                                         Marble::GeoDataCoordinates::Degree);
-      visible1 = airwaybox.intersects(context->viewport->viewLatLonAltBox());
-    }
+    if(fast)
+      continue;
+
+    // Text of the current run of segments having the same text and direction and the best segment to place it
+    QString runText;
+    map::MapAirwayDirection runDirection = map::DIR_BOTH;
+    int runIndex = -1, runLength = -1;
 
-    // Draw line if both points are visible or line intersects screen coordinates
-    if(visible1 || visible2)
+    for(int i : airwayLine.indexes)
     {
-      if(context->objCount())
-        return;
+      const MapAirway& airway = airways->at(i);
 
-      drawLine(painter, Line(airway.from, airway.to));
+      // Get start and end point of airway segment in screen coordinates
+      int x1, y1, x2, y2;
+      bool visible1 = wToS(airway.from, x1, y1);
+      bool visible2 = wToS(airway.to, x2, y2);
 
-      if(!fast)
+      if(!visible1 && !visible2)
       {
-        if(airway.direction != map::DIR_BOTH && !ident)
-        {
-          Line arrLine = airway.direction != map::DIR_FORWARD ?
-                         Line(airway.from, airway.to) : Line(airway.to, airway.from);
-          paintArrowAlongLine(painter, arrLine, isTrack ? arrowTrack : arrowAirway, 0.5f);
-        }
+        // Check bounding rect for visibility
+        const Rect& segbnd = airway.bounding;
+        Marble::GeoDataLatLonBox airwaybox(segbnd.getNorth(), segbnd.getSouth(), segbnd.getEast(), segbnd.getWest(),
+                                           Marble::GeoDataCoordinates::Degree);
+        if(!airwaybox.intersects(viewBox))
+          continue;
+      }
 
-        // Build text index
-        QString text;
-        if(ident)
-          text += airway.name;
+      if(airway.direction != map::DIR_BOTH && !ident)
+      {
+        Line arrLine = airway.direction != map::DIR_FORWARD ?
+                       Line(airway.from, airway.to) : Line(airway.to, airway.from);
+        paintArrowAlongLine(painter, arrLine, isTrack ? arrowTrack : arrowAirway, 0.5f);
+      }
 
-        if(info)
-        {
-          text += QString(tr(" / "));
+      // Build text
+      QString text;
+      if(ident)
+        text += airway.name;
 
-          if(isTrack)
-            text += map::airwayTrackTypeToString(airway.type);
-          else
-            text += map::airwayTrackTypeToShortString(airway.type);
+      if(info)
+      {
+        text += QString(tr(" / "));
 
-          QString altTxt = map::airwayAltTextShort(airway);
+        if(isTrack)
+          text += map::airwayTrackTypeToString(airway.type);
+        else
+          text += map::airwayTrackTypeToShortString(airway.type);
 
-          if(!altTxt.isEmpty())
-            text += QString(tr(" / ")) + altTxt;
-        }
+        QString altTxt = map::airwayAltTextShort(airway);
 
-        if(!text.isEmpty())
-        {
-          QString firstCoordStr = airway.from.toString(3, false /*altitude*/);
-          QString toCoordStr = airway.to.toString(3, false /*altitude*/);
-
-          // Create string key for index by using the coordinates
-          QString lineTextKey = firstCoordStr + "|" + toCoordStr;
-
-          bool reversed = false;
-
-          // Does it already exist in the map?
-          int index = lines.value(lineTextKey, -1);
-          if(index == -1)
-          {
-            // Try with reversed coordinates
-            index = lines.value(toCoordStr + "|" + firstCoordStr, -1);
-            reversed = index != -1;
-          }
-
-          // if(reversed)
-          // qDebug() << text << reversed;
-
-          if(index != -1)
-          {
-            // Index already found - add the new text to the present one
-            textlist[index].texts.append(text);
-            textlist[index].airwayIndexByText.append(i);
-            textlist[index].positionReversed.append(reversed);
-          }
-          else if(!text.isEmpty())
-          {
-            // Neither with forward nor reversed coordinates found - insert a new entry
-            textlist.append(Place(text, i, reversed));
-            lines.insert(lineTextKey, textlist.size() - 1);
-          }
-        }
+        if(!altTxt.isEmpty())
+          text += QString(tr(" / ")) + altTxt;
+      }
+
+      if(text.isEmpty())
+        continue;
+
+      if(text != runText || airway.direction != runDirection)
+      {
+        // New run of segments with different text - place text for the last one
+        if(runIndex != -1)
+          addText(runIndex, runText);
+        runText = text;
+        runDirection = airway.direction;
+        runIndex = -1;
+        runLength = -1;
+      }
+
+      // Place text on the longest segment where both ends are visible
+      int length = visible1 && visible2 ? qAbs(x2 - x1) + qAbs(y2 - y1) : 0;
+      if(length > runLength)
+      {
+        runIndex = i;
+        runLength = length;
       }
     }
+
+    if(runIndex != -1)
+      addText(runIndex, runText);
   }
 
   TextPlacement textPlacement(painter, this, QRect());
@@ -43,7 +43,7 @@ private:
   void paintNdbs(const QList<map::MapNdb> *ndbs, bool drawFast);
   void paintVors(const QList<map::MapVor> *vors, bool drawFast);
   void paintWaypoints(const QList<map::MapWaypoint> *waypoints, bool drawWaypoint);
-  void paintAirways(const QList<map::MapAirway> *airways, bool fast);
+  void paintAirways(const QList<map::MapAirway> *airways, const QVector<map::MapAirwayLine> *airwayLines, bool fast);
 
 };
 
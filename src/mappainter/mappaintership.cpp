@@ -50,11 +50,12 @@ void MapPainterShip::render()
       atools::util::PainterContextSaver saver(context->painter);
       Q_UNUSED(saver);
 
+      float extrapolationSeconds = mapPaintWidget->getExtrapolationSeconds(false /* online */);
       for(const SimConnectAircraft& ac : mapPaintWidget->getAiAircraft())
       {
         if(ac.isAnyBoat() &&
            (ac.getModelRadiusCorrected() * 2 > layer::LARGE_SHIP_SIZE || context->mapLayer->isAiShipSmall()))
-          paintAiVehicle(ac, false /* force label */);
+          paintAiVehicle(ac, extrapolationSeconds, false /* force label */);
       }
     }
   }
@@ -50,12 +50,12 @@ MapPainterVehicle::~MapPainterVehicle()
 
 }
 
-void MapPainterVehicle::paintAiVehicle(const SimConnectAircraft& vehicle, bool forceLabel)
+void MapPainterVehicle::paintAiVehicle(const SimConnectAircraft& vehicle, float extrapolationSeconds, bool forceLabel)
 {
   if(vehicle.isUser())
     return;
 
-  const Pos& pos = vehicle.getPosition();
+  Pos pos = mapfunc::extrapolatedPosition(vehicle, extrapolationSeconds);
 
   if(!pos.isValid())
     return;
@@ -57,7 +57,8 @@ protected:
   void paintAircraftTrack();
 
   void paintUserAircraft(const atools::fs::sc::SimConnectUserAircraft& userAircraft, float x, float y);
-  void paintAiVehicle(const atools::fs::sc::SimConnectAircraft& vehicle, bool forceLabel);
+  /* Draw AI, multiplayer or online vehicle at the position extrapolated for the given time */
+  void paintAiVehicle(const atools::fs::sc::SimConnectAircraft& vehicle, float extrapolationSeconds, bool forceLabel);
 
   void paintTextLabelUser(float x, float y, int size, const atools::fs::sc::SimConnectUserAircraft& aircraft);
   void paintTextLabelAi(float x, float y, int size, const atools::fs::sc::SimConnectAircraft& aircraft,
@@ -18,6 +18,8 @@
 #include "mappainter/mappainterwind.h"
 
 #include "common/symbolpainter.h"
+#include "common/constants.h"
+#include "settings/settings.h"
 #include "mapgui/maplayer.h"
 #include "query/mapquery.h"
 #include "util/paintercontextsaver.h"
@@ -33,6 +35,8 @@ using namespace atools::geo;
 MapPainterWind::MapPainterWind(MapPaintWidget *mapWidget, MapScale *mapScale, PaintContext *paintContext)
   : MapPainter(mapWidget, mapScale, paintContext)
 {
+  if(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_SYMBOL_SPRITES_DEBUG, false).toBool())
+    symbolPainter->benchmarkSprites();
 }
 
 MapPainterWind::~MapPainterWind()
@@ -40,38 +44,53 @@ MapPainterWind::~MapPainterWind()
 }
 
 void MapPainterWind::render()
+{
+  atools::grib::WindPosList windPositions;
+  if(fetchWindPositions(windPositions))
+    renderWindPositions(windPositions);
+}
+
+bool MapPainterWind::fetchWindPositions(atools::grib::WindPosList& windPositions) const
 {
   bool drawWeather = context->objectDisplayTypes.testFlag(map::WIND_BARBS) && context->mapLayer->isWindBarbs();
 
   if(!drawWeather)
-    return;
-
-  atools::util::PainterContextSaver saver(context->painter);
-  Q_UNUSED(saver);
+    return false;
 
+  // Updates the cache of the reporter - not thread safe
   const atools::grib::WindPosList *windForRect =
     NavApp::getWindReporter()->getWindForRect(context->viewport->viewLatLonAltBox(),
                                               context->mapLayer, context->lazyUpdate);
 
-  if(windForRect != nullptr)
-  {
-    atools::geo::Rect rect = context->viewportRect;
+  if(windForRect == nullptr)
+    return false;
+
+  // Implicitly shared copy
+  windPositions = *windForRect;
+  return true;
+}
+
+void MapPainterWind::renderWindPositions(const atools::grib::WindPosList& windPositions)
+{
+  atools::util::PainterContextSaver saver(context->painter);
+  Q_UNUSED(saver);
+
+  atools::geo::Rect rect = context->viewportRect;
 
-    // Inflate for half a grid cell size to avoid disappearing symbols at map border
-    rect.inflate(0.5f, 0.5f);
+  // Inflate for half a grid cell size to avoid disappearing symbols at map border
+  rect.inflate(0.5f, 0.5f);
+
+  for(const atools::grib::WindPos& windPos : windPositions)
+  {
+    if(!windPos.wind.isValid())
+      continue;
 
-    for(const atools::grib::WindPos& windPos : *windForRect)
+    if(rect.contains(windPos.pos))
     {
-      if(!windPos.wind.isValid())
-        continue;
-
-      if(rect.contains(windPos.pos))
-      {
-        bool isVisible, isHidden;
-        QPoint pos = wToS(windPos.pos, DEFAULT_WTOS_SIZE, &isVisible, &isHidden);
-        if(!pos.isNull() && /*isVisible && */ !isHidden)
-          drawWindBarb(windPos.wind.speed, windPos.wind.dir, pos.x(), pos.y());
-      }
+      bool isVisible, isHidden;
+      QPoint pos = wToS(windPos.pos, DEFAULT_WTOS_SIZE, &isVisible, &isHidden);
+      if(!pos.isNull() && /*isVisible && */ !isHidden)
+        drawWindBarb(windPos.wind.speed, windPos.wind.dir, pos.x(), pos.y());
     }
   }
 }
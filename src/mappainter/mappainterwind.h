@@ -20,6 +20,13 @@
 
 #include "mappainter/mappainter.h"
 
+namespace atools {
+namespace grib {
+struct WindPos;
+typedef QList<WindPos> WindPosList;
+}
+}
+
 /*
  * Draws the wind barb grid layer.
  */
@@ -32,8 +39,16 @@ public:
   MapPainterWind(MapPaintWidget *mapPaintWidget, MapScale *mapScale, PaintContext *paintContext);
   virtual ~MapPainterWind() override;
 
+  /* Fetch wind positions and draw them. Has to be called in the GUI thread. */
   virtual void render() override;
 
+  /* Get a copy of the wind positions for the current view from the wind reporter.
+   * Has to be called in the GUI thread. Returns false if nothing is to be drawn. */
+  bool fetchWindPositions(atools::grib::WindPosList& windPositions) const;
+
+  /* Draw wind positions fetched before. Does not access the wind reporter and can be called in a worker thread. */
+  void renderWindPositions(const atools::grib::WindPosList& windPositions);
+
 private:
   void drawWindBarb(float speed, float direction, float x, float y);
 
@@ -20,6 +20,8 @@
 #include "navapp.h"
 #include "mappainter/mappainterweather.h"
 #include "mappainter/mappainterwind.h"
+#include "weather/windreporter.h"
+#include "grib/windquery.h"
 #include "connect/connectclient.h"
 #include "common/mapcolors.h"
 #include "mapgui/mapwidget.h"
@@ -41,10 +43,15 @@
 #include "route/route.h"
 #include "geo/calculations.h"
 #include "options/optiondata.h"
+#include "atools.h"
+#include "common/constants.h"
+#include "settings/settings.h"
 
 #include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using namespace Marble;
 using namespace atools::geo;
@@ -68,11 +75,15 @@ MapPaintLayer::MapPaintLayer(MapPaintWidget *widget, MapQuery *mapQueries)
   mapPainterTrack = new MapPainterTrack(mapWidget, mapScale, &context);
   mapPainterShip = new MapPainterShip(mapWidget, mapScale, &context);
   mapPainterUser = new MapPainterUser(mapWidget, mapScale, &context);
-  mapPainterAltitude = new MapPainterAltitude(mapWidget, mapScale, &context);
+  mapPainterAltitude = new MapPainterAltitude(mapWidget, mapScale, &contextAltitude);
   mapPainterWeather = new MapPainterWeather(mapWidget, mapScale, &context);
-  mapPainterWind = new MapPainterWind(mapWidget, mapScale, &context);
+  mapPainterWind = new MapPainterWind(mapWidget, mapScale, &contextWind);
   mapPainterTop = new MapPainterTop(mapWidget, mapScale, &context);
 
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  parallelPaint = settings.getAndStoreValue(lnm::OPTIONS_MAP_PARALLEL_PAINT, true).toBool();
+  paintDebug = settings.getAndStoreValue(lnm::OPTIONS_MAP_PAINT_DEBUG, false).toBool();
+
   // Default for visible object types
   objectTypes = map::MapTypes(map::AIRPORT | map::VOR | map::NDB | map::AP_ILS | map::MARKER | map::WAYPOINT);
   objectDisplayTypes = map::DISPLAY_TYPE_NONE;
@@ -119,6 +130,17 @@ void MapPaintLayer::preDatabaseLoad()
 void MapPaintLayer::postDatabaseLoad()
 {
   databaseLoadStatus = false;
+
+  // MORA data is reloaded with the database
+  mapPainterAltitude->clearMoraCache();
+  invalidateStaticCache();
+}
+
+void MapPaintLayer::invalidateStaticCache()
+{
+  staticCacheValid = false;
+  staticCacheBelow = QImage();
+  staticCacheAbove = QImage();
 }
 
 void MapPaintLayer::setShowMapObjects(map::MapTypes type, bool show)
@@ -493,6 +515,10 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
        !(viewport->projection() == Marble::Mercator && // Do not draw if Mercator wraps around whole planet
          viewport->viewLatLonAltBox().width(GeoDataCoordinates::Degree) >= 359.))
     {
+      QElapsedTimer frameTimer;
+      frameTimer.start();
+      frameTimes.clear();
+
       updateLayers();
 
 #ifdef DEBUG_INFORMATION_PAINT
@@ -621,70 +647,427 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
       // =========================================================================
       // Draw ====================================
 
-      // Altitude below all others
-      mapPainterAltitude->render();
+      // Altitude, ships, airspaces, navaids, airports, user points and wind - either directly or from cache
+      renderStatic(painter, viewport);
 
-      // Ship below other navaids and airports
-      mapPainterShip->render();
+      // if(!context.isOverflow()) always paint route even if number of objets is too large
+      renderTimed(mapPainterRoute, "route");
 
-      if(mapWidget->distance() < layer::DISTANCE_CUT_OFF_LIMIT)
-      {
-        if(!context.isOverflow())
-          mapPainterAirspace->render();
+      renderTimed(mapPainterWeather, "weather");
 
-        if(context.mapLayerEffective->isAirportDiagram())
-        {
-          // Put ILS below and navaids on top of airport diagram
-          mapPainterIls->render();
+      renderTimed(mapPainterTrack, "track");
 
-          if(!context.isOverflow())
-            mapPainterAirport->render();
+      // if(!context.isOverflow())
+      renderTimed(mapPainterMark, "mark");
 
-          if(!context.isOverflow())
-            mapPainterNav->render();
-        }
-        else
-        {
-          // Airports on top of all
-          if(!context.isOverflow())
-            mapPainterIls->render();
+      renderTimed(mapPainterAircraft, "aircraft");
 
-          if(!context.isOverflow())
-            mapPainterNav->render();
+      renderTimed(mapPainterTop, "top");
 
-          if(!context.isOverflow())
-            mapPainterAirport->render();
-        }
+      if(context.isOverflow())
+        overflow = PaintContext::MAX_OBJECT_COUNT;
+      else
+        overflow = 0;
+
+      if(paintDebug)
+      {
+        // Print time for each layer in milliseconds - threads overlap with GUI thread layers
+        QStringList times;
+        for(const std::pair<QString, qint64>& time : frameTimes)
+          times.append(time.first + " " + QString::number(time.second / 1000000., 'f', 2));
+        qDebug().noquote() << Q_FUNC_INFO << "frame" << QString::number(frameTimer.nsecsElapsed() / 1000000., 'f', 2)
+                           << "ms:" << times.join(", ");
       }
+    }
+
+    // Next paint event will draw all layers again if not requested otherwise
+    dynamicUpdateOnly = false;
+
+    if(!mapWidget->isPrinting() && mapWidget->isVisibleWidget())
+      // Dim the map by drawing a semi-transparent black rectangle - but not for printing or web services
+      mapcolors::darkenPainterRect(*painter);
+  }
+  return true;
+}
+
+void MapPaintLayer::renderTimed(MapPainter *painter, const char *name)
+{
+  if(paintDebug)
+  {
+    QElapsedTimer timer;
+    timer.start();
+    painter->render();
+    frameTimes.append(std::make_pair(QString(name), timer.nsecsElapsed()));
+  }
+  else
+    painter->render();
+}
+
+void MapPaintLayer::renderStaticBelowShips()
+{
+  // Altitude below all others
+  contextAltitude = context;
+  mapPainterAltitude->prepareMoraCache();
+  renderTimed(mapPainterAltitude, "altitude");
+}
+
+void MapPaintLayer::renderStaticDatabase()
+{
+  if(mapWidget->distance() < layer::DISTANCE_CUT_OFF_LIMIT)
+  {
+    if(!context.isOverflow())
+      renderTimed(mapPainterAirspace, "airspace");
+
+    if(context.mapLayerEffective->isAirportDiagram())
+    {
+      // Put ILS below and navaids on top of airport diagram
+      renderTimed(mapPainterIls, "ils");
 
       if(!context.isOverflow())
-        mapPainterUser->render();
+        renderTimed(mapPainterAirport, "airport");
 
-      mapPainterWind->render();
+      if(!context.isOverflow())
+        renderTimed(mapPainterNav, "nav");
+    }
+    else
+    {
+      // Airports on top of all
+      if(!context.isOverflow())
+        renderTimed(mapPainterIls, "ils");
 
-      // if(!context.isOverflow()) always paint route even if number of objets is too large
-      mapPainterRoute->render();
+      if(!context.isOverflow())
+        renderTimed(mapPainterNav, "nav");
 
-      mapPainterWeather->render();
+      if(!context.isOverflow())
+        renderTimed(mapPainterAirport, "airport");
+    }
+  }
 
-      mapPainterTrack->render();
+  if(!context.isOverflow())
+    renderTimed(mapPainterUser, "user");
+}
 
-      // if(!context.isOverflow())
-      mapPainterMark->render();
+void MapPaintLayer::renderStaticAboveShips()
+{
+  renderStaticDatabase();
 
-      mapPainterAircraft->render();
+  contextWind = context;
+  renderTimed(mapPainterWind, "wind");
+}
 
-      mapPainterTop->render();
+void MapPaintLayer::renderStatic(GeoPainter *painter, ViewportParams *viewport)
+{
+  // Cache only a still map on screen - scrolling changes the viewport anyway and printing uses other sizes
+  bool cacheable = context.viewContext == Marble::Still && !context.drawFast && !mapWidget->isPrinting() &&
+                   mapWidget->isVisibleWidget();
 
-      if(context.isOverflow())
-        overflow = PaintContext::MAX_OBJECT_COUNT;
-      else
-        overflow = 0;
+  if(!cacheable)
+  {
+    invalidateStaticCache();
+    lastFrameKey = StaticCacheKey();
+    renderStaticDirect();
+    return;
+  }
+
+  // Compare the state the cache was built with to catch changes which requested a repaint without invalidating
+  // and were merged into a dynamic update
+  StaticCacheKey key = currentStaticCacheKey(painter, viewport);
+  if(!dynamicUpdateOnly || !staticCacheValid || key != staticCacheKey)
+  {
+    // Something else than aircraft positions has changed or no cache yet
+    if(!key.isSameViewport(lastFrameKey))
+    {
+      // Viewport is changing from frame to frame like when following the aircraft
+      // Filling the cache would not pay off - paint directly
+      invalidateStaticCache();
+      lastFrameKey = key;
+      renderStaticDirect();
+      return;
     }
 
-    if(!mapWidget->isPrinting() && mapWidget->isVisibleWidget())
-      // Dim the map by drawing a semi-transparent black rectangle - but not for printing or web services
-      mapcolors::darkenPainterRect(*painter);
+    updateStaticCache(painter, viewport);
+    staticCacheKey = key;
   }
-  return true;
+#ifdef DEBUG_INFORMATION_PAINT
+  else
+    qDebug() << Q_FUNC_INFO << "using cached static layers";
+#endif
+  lastFrameKey = key;
+
+  if(!staticCacheBelow.isNull())
+    painter->drawImage(QPointF(0., 0.), staticCacheBelow);
+
+  // Ship below other navaids and airports
+  renderTimed(mapPainterShip, "ship");
+
+  if(!staticCacheAbove.isNull())
+    painter->drawImage(QPointF(0., 0.), staticCacheAbove);
+
+  // Keep overflow state of the static layers for the dynamic ones
+  context.objectCount = std::max(context.objectCount, staticCacheObjectCount);
+}
+
+void MapPaintLayer::renderStaticDirect()
+{
+  renderStaticBelowShips();
+
+  // Ship below other navaids and airports
+  renderTimed(mapPainterShip, "ship");
+
+  renderStaticAboveShips();
+}
+
+/* Parameters for a layer painted on a worker thread */
+struct LayerJob
+{
+  MapPainter *mapPainter;
+  PaintContext *context; /* Snapshot of the paint context used only by this job */
+  Marble::ViewportParams *viewport; /* Copy of the map viewport used only by this job */
+  QSize size;
+  qreal pixelRatio;
+  QPainter::RenderHints renderHints;
+  Marble::MapQuality mapQuality;
+
+  /* Wind painter and the wind positions fetched in the GUI thread. Null for all other layers. */
+  MapPainterWind *windPainter;
+  atools::grib::WindPosList windPositions;
+};
+
+/* Image and painting time in nanoseconds */
+struct LayerImage
+{
+  QImage image;
+  qint64 elapsedNs = 0;
+};
+
+/* Create a transparent image for a layer */
+static QImage newLayerImage(const QSize& size, qreal pixelRatio)
+{
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(pixelRatio);
+  image.fill(Qt::transparent);
+  return image;
+}
+
+/* Called in worker thread. Paints into an own image using the context snapshot of the job. */
+static LayerImage renderLayerImageThread(LayerJob job)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  LayerImage result;
+  result.image = newLayerImage(job.size, job.pixelRatio);
+  {
+    GeoPainter imagePainter(&result.image, job.viewport, job.mapQuality);
+    imagePainter.setRenderHints(job.renderHints);
+    imagePainter.setFont(job.context->defaultFont);
+
+    job.context->painter = &imagePainter;
+    if(job.windPainter != nullptr)
+      // Wind reporter is not thread safe - use only the copy of the positions
+      job.windPainter->renderWindPositions(job.windPositions);
+    else
+      job.mapPainter->render();
+    job.context->painter = nullptr;
+  }
+
+  result.elapsedNs = timer.nsecsElapsed();
+  return result;
+}
+
+/* Draw image on top of the target image */
+static void compositeLayerImage(QImage& target, const QImage& image)
+{
+  if(!image.isNull())
+  {
+    QPainter painter(&target);
+    painter.drawImage(QPointF(0., 0.), image);
+  }
+}
+
+void MapPaintLayer::updateStaticCache(GeoPainter *painter, ViewportParams *viewport)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  int objectCount = context.objectCount;
+
+  // Use a separate image below ships only if these are shown since it doubles memory usage
+  bool separateBelow = objectTypes.testFlag(map::AIRCRAFT_AI_SHIP);
+
+  if(parallelPaint)
+  {
+    // Altitude grid and wind barbs do not use the database and are painted on worker threads =============
+    qreal pixelRatio = painter->device()->devicePixelRatioF();
+    QSize size(static_cast<int>(std::ceil(viewport->width() * pixelRatio)),
+               static_cast<int>(std::ceil(viewport->height() * pixelRatio)));
+
+    // Each job gets an own copy of the viewport since it is read by the GUI thread in the meantime
+    ViewportParams altitudeViewport(viewport->projection(), viewport->centerLongitude(),
+                                    viewport->centerLatitude(), viewport->radius(), viewport->size());
+    ViewportParams windViewport(viewport->projection(), viewport->centerLongitude(),
+                                viewport->centerLatitude(), viewport->radius(), viewport->size());
+
+    // MORA grid and wind positions have to be fetched here since the MORA reader, wind reporter and
+    // wind query can only be used in the GUI thread
+    contextAltitude = context;
+    contextAltitude.viewport = &altitudeViewport;
+    mapPainterAltitude->prepareMoraCache();
+    LayerJob altitudeJob = {mapPainterAltitude, &contextAltitude, &altitudeViewport, size, pixelRatio,
+                            painter->renderHints(), painter->mapQuality(), nullptr, atools::grib::WindPosList()};
+
+    // List stays empty if nothing is to be drawn
+    contextWind = context;
+    contextWind.viewport = &windViewport;
+    atools::grib::WindPosList windPositions;
+    mapPainterWind->fetchWindPositions(windPositions);
+    LayerJob windJob = {mapPainterWind, &contextWind, &windViewport, size, pixelRatio, painter->renderHints(),
+                        painter->mapQuality(), mapPainterWind, windPositions};
+
+    // Painters use the copies for coordinate conversion until the jobs are done
+    const ViewportParams *altitudePainterViewport = mapPainterAltitude->getViewport(),
+                         *windPainterViewport = mapPainterWind->getViewport();
+    mapPainterAltitude->setViewport(&altitudeViewport);
+    mapPainterWind->setViewport(&windViewport);
+    QFuture<LayerImage> altitudeFuture = QtConcurrent::run(renderLayerImageThread, altitudeJob);
+    QFuture<LayerImage> windFuture = QtConcurrent::run(renderLayerImageThread, windJob);
+
+    // Airspaces, navaids, airports and userpoints in the meantime on the GUI thread since they use the database
+    QImage databaseImage = newLayerImage(size, pixelRatio);
+    {
+      GeoPainter imagePainter(&databaseImage, viewport, painter->mapQuality());
+      imagePainter.setRenderHints(painter->renderHints());
+      imagePainter.setFont(context.defaultFont);
+
+      context.painter = &imagePainter;
+      renderStaticDatabase();
+      context.painter = painter;
+    }
+
+    LayerImage altitude = altitudeFuture.result();
+    LayerImage wind = windFuture.result();
+
+    mapPainterAltitude->setViewport(altitudePainterViewport);
+    mapPainterWind->setViewport(windPainterViewport);
+    contextAltitude.viewport = contextWind.viewport = viewport;
+
+    if(paintDebug)
+    {
+      frameTimes.append(std::make_pair(QString("altitude thread"), altitude.elapsedNs));
+      frameTimes.append(std::make_pair(QString("wind thread"), wind.elapsedNs));
+    }
+
+    // Composite in layer order altitude, database layers and wind ==============
+    if(separateBelow)
+    {
+      staticCacheBelow = altitude.image;
+      staticCacheAbove = databaseImage;
+    }
+    else
+    {
+      staticCacheBelow = QImage();
+      staticCacheAbove = altitude.image;
+      compositeLayerImage(staticCacheAbove, databaseImage);
+    }
+    compositeLayerImage(staticCacheAbove, wind.image);
+  }
+  else if(separateBelow)
+  {
+    staticCacheBelow = renderStaticImage(painter, viewport, true /* below ships */);
+    staticCacheAbove = renderStaticImage(painter, viewport, false /* below ships */);
+  }
+  else
+  {
+    staticCacheBelow = QImage();
+    staticCacheAbove = renderStaticImage(painter, viewport, false /* below ships */);
+  }
+
+  staticCacheObjectCount = context.objectCount;
+  context.objectCount = objectCount;
+  staticCacheValid = true;
+
+#ifdef DEBUG_INFORMATION_PAINT
+  qDebug() << Q_FUNC_INFO << "static layers rendered in" << timer.elapsed() << "ms"
+           << "objects" << staticCacheObjectCount;
+#endif
+}
+
+QImage MapPaintLayer::renderStaticImage(GeoPainter *painter, ViewportParams *viewport, bool belowShips)
+{
+  qreal pixelRatio = painter->device()->devicePixelRatioF();
+  QImage image = newLayerImage(QSize(static_cast<int>(std::ceil(viewport->width() * pixelRatio)),
+                                     static_cast<int>(std::ceil(viewport->height() * pixelRatio))), pixelRatio);
+
+  {
+    // Paint into image using the same viewport, quality and settings as the map
+    GeoPainter imagePainter(&image, viewport, painter->mapQuality());
+    imagePainter.setRenderHints(painter->renderHints());
+    imagePainter.setFont(context.defaultFont);
+
+    context.painter = &imagePainter;
+
+    if(belowShips)
+      renderStaticBelowShips();
+    else
+    {
+      if(staticCacheBelow.isNull())
+        // Altitude is not separated - paint it here below all others
+        renderStaticBelowShips();
+      renderStaticAboveShips();
+    }
+
+    context.painter = painter;
+  }
+  return image;
+}
+
+MapPaintLayer::StaticCacheKey MapPaintLayer::currentStaticCacheKey(GeoPainter *painter,
+                                                                   ViewportParams *viewport) const
+{
+  StaticCacheKey key;
+  key.projection = viewport->projection();
+  key.width = viewport->width();
+  key.height = viewport->height();
+  key.centerLon = viewport->centerLongitude();
+  key.centerLat = viewport->centerLatitude();
+  key.radius = viewport->radius();
+  key.devicePixelRatio = painter->device()->devicePixelRatioF();
+  key.objectTypes = context.objectTypes;
+  key.objectDisplayTypes = context.objectDisplayTypes;
+  key.airspaceFilter = context.airspaceFilterByLayer;
+  key.mapLayer = context.mapLayer;
+  key.mapLayerEffective = context.mapLayerEffective;
+  key.userPointTypes = context.userPointTypes;
+  key.userPointTypeUnknown = context.userPointTypeUnknown;
+  key.userdataVersion = NavApp::getUserdataController()->getDataVersion();
+
+  key.dispOpts = context.dispOpts;
+  key.flags = context.flags;
+  key.flags2 = context.flags2;
+  key.weatherSource = context.weatherSource;
+  key.defaultFont = context.defaultFont;
+  key.sizes = {context.symbolSizeNavaid, context.textSizeNavaid, context.textSizeAirway, context.thicknessAirway,
+               context.symbolSizeAirport, context.symbolSizeAirportWeather, context.symbolSizeWindBarbs,
+               context.textSizeAirport, context.textSizeMora, context.transparencyMora};
+  key.routeIdMap = context.routeIdMap;
+  return key;
+}
+
+bool MapPaintLayer::StaticCacheKey::isSameViewport(const StaticCacheKey& other) const
+{
+  return projection == other.projection && width == other.width && height == other.height &&
+         atools::almostEqual(centerLon, other.centerLon) && atools::almostEqual(centerLat, other.centerLat) &&
+         atools::almostEqual(radius, other.radius) && atools::almostEqual(devicePixelRatio, other.devicePixelRatio);
+}
+
+bool MapPaintLayer::StaticCacheKey::operator==(const StaticCacheKey& other) const
+{
+  return isSameViewport(other) &&
+         objectTypes == other.objectTypes && objectDisplayTypes == other.objectDisplayTypes &&
+         airspaceFilter.types == other.airspaceFilter.types && airspaceFilter.flags == other.airspaceFilter.flags &&
+         mapLayer == other.mapLayer && mapLayerEffective == other.mapLayerEffective &&
+         userPointTypes == other.userPointTypes && userPointTypeUnknown == other.userPointTypeUnknown &&
+         userdataVersion == other.userdataVersion && dispOpts == other.dispOpts && flags == other.flags &&
+         flags2 == other.flags2 && weatherSource == other.weatherSource && defaultFont == other.defaultFont &&
+         sizes == other.sizes && routeIdMap == other.routeIdMap;
 }
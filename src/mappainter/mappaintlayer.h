@@ -20,6 +20,7 @@
 
 #include "mappainter/mappainter.h"
 
+#include <QImage>
 #include <QPen>
 
 #include <marble/LayerInterface.h>
@@ -144,10 +145,82 @@ public:
     sunShading = value;
   }
 
+  /* Drop the offscreen images of the static layers. Has to be called on all changes of data which
+   * affect airports, weather, navaids, tracks, airspaces, user points, wind or MORA and are not covered
+   * by the cache key. Cache is dropped anyway if viewport, layer, object types or display settings differ. */
+  void invalidateStaticCache();
+
+  /* Mark the next paint event as caused only by moving user or AI aircraft. Static layers are drawn from the
+   * offscreen cache in this case if the viewport and layer settings are unchanged. Reset after each paint. */
+  void setDynamicUpdateOnly()
+  {
+    dynamicUpdateOnly = true;
+  }
+
 private:
+  /* Values which define the content of the static layer cache. Cache is only used if all are equal. */
+  struct StaticCacheKey
+  {
+    int projection = -1, width = 0, height = 0;
+    qreal centerLon = 0., centerLat = 0., radius = 0., devicePixelRatio = 1.;
+    map::MapTypes objectTypes = map::NONE;
+    map::MapObjectDisplayTypes objectDisplayTypes = map::DISPLAY_TYPE_NONE;
+    map::MapAirspaceFilter airspaceFilter;
+    const MapLayer *mapLayer = nullptr, *mapLayerEffective = nullptr;
+    QStringList userPointTypes;
+    bool userPointTypeUnknown = false;
+    quint32 userdataVersion = 0;
+
+    /* Display options, fonts and symbol sizes from the paint context */
+    optsd::DisplayOptions dispOpts;
+    opts::Flags flags;
+    opts2::Flags2 flags2;
+    map::MapWeatherSource weatherSource;
+    QFont defaultFont;
+    QVector<float> sizes;
+
+    /* Route navaids are highlighted by the airport and navaid painters */
+    QSet<map::MapObjectRef> routeIdMap;
+
+    /* Compare only projection, size, center, zoom and pixel ratio */
+    bool isSameViewport(const StaticCacheKey& other) const;
+
+    bool operator==(const StaticCacheKey& other) const;
+
+    bool operator!=(const StaticCacheKey& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
   void initMapLayerSettings();
   void updateLayers();
 
+  /* Call render of painter and collect the time if paint debugging is enabled */
+  void renderTimed(MapPainter *painter, const char *name);
+
+  /* Static layers which are drawn below ships or above */
+  void renderStaticBelowShips();
+  void renderStaticAboveShips();
+
+  /* Airspaces, navaids, airports and userpoints which all need the database and have to run in the GUI thread */
+  void renderStaticDatabase();
+
+  /* Draw static layers either directly, from cache or by updating the cache */
+  void renderStatic(Marble::GeoPainter *painter, Marble::ViewportParams *viewport);
+
+  /* Draw static layers directly on the map without cache */
+  void renderStaticDirect();
+
+  /* Render static layers into the offscreen images */
+  void updateStaticCache(Marble::GeoPainter *painter, Marble::ViewportParams *viewport);
+
+  /* Paint one cached layer into an image of viewport size */
+  QImage renderStaticImage(Marble::GeoPainter *painter, Marble::ViewportParams *viewport, bool belowShips);
+
+  StaticCacheKey currentStaticCacheKey(Marble::GeoPainter *painter, Marble::ViewportParams *viewport) const;
+
   /* Implemented from LayerInterface: We  draw above all but below user tools */
   virtual QStringList renderPosition() const override
   {
@@ -172,6 +245,9 @@ private:
 
   PaintContext context;
 
+  /* Snapshots of context for painters which can run in worker threads */
+  PaintContext contextAltitude, contextWind;
+
   /* All painters */
   MapPainterAirport *mapPainterAirport;
   MapPainterAirspace *mapPainterAirspace;
@@ -197,6 +273,24 @@ private:
   const MapLayer *mapLayer = nullptr, *mapLayerEffective = nullptr;
   int overflow = 0;
 
+  /* Offscreen images for static layers. Below is only used if ships are shown */
+  QImage staticCacheBelow, staticCacheAbove;
+  StaticCacheKey staticCacheKey;
+  bool staticCacheValid = false, dynamicUpdateOnly = false;
+
+  /* State of the previous frame. Cache is filled only if the viewport did not change since then. */
+  StaticCacheKey lastFrameKey;
+
+  /* Object count of static layers when cache was filled to keep overflow state */
+  int staticCacheObjectCount = 0;
+
+  /* Paint altitude and wind layers in worker threads when filling the cache */
+  bool parallelPaint = true;
+
+  /* Print paint time per layer for each frame */
+  bool paintDebug = false;
+  QVector<std::pair<QString, qint64> > frameTimes;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTLAYER_H
@@ -24,6 +24,7 @@
 #include "query/waypointtrackquery.h"
 #include "query/airportquery.h"
 #include "db/databasemanager.h"
+#include "db/databasepool.h"
 #include "fs/db/databasemeta.h"
 #include "mapgui/mapwidget.h"
 #include "gui/mainwindow.h"
@@ -48,6 +49,8 @@
 #include "mapgui/mapmarkhandler.h"
 #include "routestring/routestringwriter.h"
 #include "track/trackcontroller.h"
+#include "common/startuptrace.h"
+#include "sql/sqldatabase.h"
 
 #include "query/waypointquery.h"
 #include "ui_mainwindow.h"
@@ -56,6 +59,7 @@
 
 #include <QIcon>
 #include <QSplashScreen>
+#include <QtConcurrent/QtConcurrentRun>
 
 AirportQuery *NavApp::airportQuerySim = nullptr;
 AirportQuery *NavApp::airportQueryNav = nullptr;
@@ -67,6 +71,7 @@ ConnectClient *NavApp::connectClient = nullptr;
 DatabaseManager *NavApp::databaseManager = nullptr;
 MainWindow *NavApp::mainWindow = nullptr;
 ElevationProvider *NavApp::elevationProvider = nullptr;
+QFuture<void> NavApp::moraFuture;
 atools::fs::db::DatabaseMeta *NavApp::databaseMetaSim = nullptr;
 atools::fs::db::DatabaseMeta *NavApp::databaseMetaNav = nullptr;
 QSplashScreen *NavApp::splashScreen = nullptr;
@@ -119,8 +124,10 @@ void NavApp::init(MainWindow *mainWindowParam)
   qDebug() << Q_FUNC_INFO;
 
   NavApp::mainWindow = mainWindowParam;
+  startuptrace::begin("Open databases");
   databaseManager = new DatabaseManager(mainWindow);
   databaseManager->openAllDatabases(); // Only readonly databases
+  startuptrace::end("Open databases");
 
   userdataController = new UserdataController(databaseManager->getUserdataManager(), mainWindow);
   logdataController = new LogdataController(databaseManager->getLogdataManager(), mainWindow);
@@ -129,11 +136,14 @@ void NavApp::init(MainWindow *mainWindowParam)
   databaseMetaSim = new atools::fs::db::DatabaseMeta(getDatabaseSim());
   databaseMetaNav = new atools::fs::db::DatabaseMeta(getDatabaseNav());
 
+  startuptrace::begin("Magnetic declination");
   magDecReader = new atools::fs::common::MagDecReader();
   readMagDecFromDatabase();
+  startuptrace::end("Magnetic declination");
 
+  // MORA grid is not needed before the map is painted - read in background
   moraReader = new atools::fs::common::MoraReader(databaseManager->getDatabaseMora());
-  moraReader->readFromTable();
+  startReadMora();
 
   vehicleIcons = new VehicleIcons();
 
@@ -152,6 +162,7 @@ void NavApp::init(MainWindow *mainWindowParam)
 
   aircraftPerfController = new AircraftPerfController(mainWindow);
 
+  startuptrace::begin("Query initialization");
   mapQuery = new MapQuery(databaseManager->getDatabaseSim(), databaseManager->getDatabaseNav(),
                           databaseManager->getDatabaseUser());
   mapQuery->initQueries();
@@ -175,6 +186,7 @@ void NavApp::init(MainWindow *mainWindowParam)
 
   procedureQuery = new ProcedureQuery(databaseManager->getDatabaseNav());
   procedureQuery->initQueries();
+  startuptrace::end("Query initialization");
 
   connectClient = new ConnectClient(mainWindow);
 
@@ -262,6 +274,9 @@ void NavApp::deInit()
   delete procedureQuery;
   procedureQuery = nullptr;
 
+  // Background thread uses its own connection on the MORA database file
+  waitForMora();
+
   qDebug() << Q_FUNC_INFO << "delete databaseManager";
   delete databaseManager;
   databaseManager = nullptr;
@@ -313,6 +328,7 @@ void NavApp::preDatabaseLoad()
   procedureQuery->deInitQueries();
   airspaceController->preDatabaseLoad();
   trackController->preDatabaseLoad();
+  waitForMora();
   logdataController->preDatabaseLoad();
 
   delete databaseMetaSim;
@@ -368,7 +384,7 @@ void NavApp::postDatabaseLoad()
 
   readMagDecFromDatabase();
 
-  moraReader->readFromTable(*getDatabaseMora());
+  startReadMora();
 
   airportQuerySim->initQueries();
   airportQueryNav->initQueries();
@@ -759,9 +775,45 @@ StyleHandler *NavApp::getStyleHandler()
 
 atools::fs::common::MoraReader *NavApp::getMoraReader()
 {
+  waitForMora();
   return moraReader;
 }
 
+void NavApp::startReadMora()
+{
+  waitForMora();
+  moraFuture = QtConcurrent::run(&NavApp::readMoraThread, getDatabaseMora()->databaseName());
+}
+
+void NavApp::readMoraThread(const QString& filename)
+{
+  startuptrace::Phase trace("MORA grid");
+  DatabasePool *pool = databaseManager->getDatabasePool();
+
+  try
+  {
+    // Connections cannot be shared between threads - get a separate one on the same file
+    moraReader->readFromTable(*pool->getDatabase(filename));
+  }
+  catch(atools::Exception& e)
+  {
+    // Not fatal - MORA is not shown on the map
+    qWarning() << Q_FUNC_INFO << "Error reading MORA grid" << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Unknown error reading MORA grid";
+  }
+
+  // Close connection of this thread to release the file
+  pool->release();
+}
+
+void NavApp::waitForMora()
+{
+  moraFuture.waitForFinished();
+}
+
 atools::sql::SqlDatabase *NavApp::getDatabaseUser()
 {
   return databaseManager->getDatabaseUser();
@@ -903,6 +955,11 @@ DatabaseManager *NavApp::getDatabaseManager()
   return databaseManager;
 }
 
+DatabasePool *NavApp::getDatabasePool()
+{
+  return databaseManager->getDatabasePool();
+}
+
 ConnectClient *NavApp::getConnectClient()
 {
   return connectClient;
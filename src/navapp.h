@@ -23,6 +23,8 @@
 #include "common/mapflags.h"
 #include "fs/fspaths.h"
 
+#include <QFuture>
+
 class AircraftPerfController;
 class AircraftTrack;
 class AirportQuery;
@@ -33,6 +35,7 @@ class AirspaceController;
 class AirspaceQuery;
 class ConnectClient;
 class DatabaseManager;
+class DatabasePool;
 class ElevationProvider;
 class InfoController;
 class InfoQuery;
@@ -264,6 +267,9 @@ public:
 
   static DatabaseManager *getDatabaseManager();
 
+  /* Per thread read only connections for background queries */
+  static DatabasePool *getDatabasePool();
+
   static ConnectClient *getConnectClient();
 
   /* Can be null while compiling database */
@@ -347,6 +353,11 @@ private:
   static void initApplication();
   static void readMagDecFromDatabase();
 
+  /* Read MORA grid in a background thread using a separate database connection */
+  static void startReadMora();
+  static void readMoraThread(const QString& filename);
+  static void waitForMora();
+
   /* Database query helpers and caches */
   static AirportQuery *airportQuerySim, *airportQueryNav;
   static MapQuery *mapQuery;
@@ -354,6 +365,9 @@ private:
   static ProcedureQuery *procedureQuery;
   static ElevationProvider *elevationProvider;
 
+  /* Background loading of the MORA grid. getMoraReader() waits for it to finish. */
+  static QFuture<void> moraFuture;
+
   /* Most important handlers */
   static ConnectClient *connectClient;
   static DatabaseManager *databaseManager;
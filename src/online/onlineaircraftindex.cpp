@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "online/onlineaircraftindex.h"
+
+#include "geo/rect.h"
+
+#include <algorithm>
+#include <cmath>
+
+using atools::fs::sc::SimConnectAircraft;
+using atools::geo::Pos;
+
+void OnlineAircraftIndex::build(const QVector<SimConnectAircraft>& aircraftList)
+{
+  clear();
+  aircraft = aircraftList;
+  callsigns.reserve(aircraft.size());
+
+  for(int i = 0; i < aircraft.size(); i++)
+  {
+    const SimConnectAircraft& ac = aircraft.at(i);
+
+    // Keep first one for duplicate callsigns
+    if(!ac.getAirplaneRegistration().isEmpty() && !callsigns.contains(ac.getAirplaneRegistration()))
+      callsigns.insert(ac.getAirplaneRegistration(), i);
+
+    const Pos& pos = ac.getPosition();
+    if(pos.isValid())
+      cells[cellKey(static_cast<int>(std::floor(pos.getLonX())), static_cast<int>(std::floor(pos.getLatY())))].
+      append(i);
+  }
+}
+
+void OnlineAircraftIndex::clear()
+{
+  aircraft.clear();
+  cells.clear();
+  callsigns.clear();
+}
+
+void OnlineAircraftIndex::getAircraft(QList<SimConnectAircraft>& result, const atools::geo::Rect& rect) const
+{
+  if(aircraft.isEmpty() || !rect.isValid())
+    return;
+
+  // Clamp cell range to avoid visiting the border cells twice
+  int west = std::max(static_cast<int>(std::floor(rect.getWest())), -180);
+  int east = std::min(static_cast<int>(std::floor(rect.getEast())), 179);
+  int south = std::max(static_cast<int>(std::floor(rect.getSouth())), -90);
+  int north = std::min(static_cast<int>(std::floor(rect.getNorth())), 89);
+
+  for(int latY = south; latY <= north; latY++)
+  {
+    for(int lonX = west; lonX <= east; lonX++)
+    {
+      auto it = cells.constFind(cellKey(lonX, latY));
+      if(it != cells.constEnd())
+      {
+        for(int index : it.value())
+        {
+          const SimConnectAircraft& ac = aircraft.at(index);
+          const Pos& pos = ac.getPosition();
+
+          // Cells at the border are only partially covered
+          if(pos.getLonX() >= rect.getWest() && pos.getLonX() <= rect.getEast() &&
+             pos.getLatY() >= rect.getSouth() && pos.getLatY() <= rect.getNorth())
+            result.append(ac);
+        }
+      }
+    }
+  }
+}
+
+const SimConnectAircraft *OnlineAircraftIndex::getAircraftByCallsign(const QString& callsign) const
+{
+  auto it = callsigns.constFind(callsign);
+  return it != callsigns.constEnd() ? &aircraft.at(it.value()) : nullptr;
+}
+
+Pos OnlineAircraftIndex::getPosition(const QString& callsign) const
+{
+  const SimConnectAircraft *ac = getAircraftByCallsign(callsign);
+  return ac != nullptr ? ac->getPosition() : Pos();
+}
+
+int OnlineAircraftIndex::cellKey(int lonX, int latY)
+{
+  // Coordinates at 180 east and 90 north go into the last cell
+  return std::min(std::max(latY + 90, 0), 179) * 360 + std::min(std::max(lonX + 180, 0), 359);
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ONLINEAIRCRAFTINDEX_H
+#define LNM_ONLINEAIRCRAFTINDEX_H
+
+#include "fs/sc/simconnectaircraft.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+}
+
+/*
+ * In-memory index of all online network aircraft (clients) from the last whazzup download.
+ *
+ * Aircraft are kept in a spatial hash of one degree cells and a hash by callsign. The index is rebuilt once per
+ * download and replaces the SQL queries on the client table for map display and shadow aircraft detection.
+ */
+class OnlineAircraftIndex
+{
+public:
+  /* Replace all aircraft and rebuild index */
+  void build(const QVector<atools::fs::sc::SimConnectAircraft>& aircraftList);
+  void clear();
+
+  /* Append all aircraft within the rectangle to result. Rectangle must not cross the anti-meridian. */
+  void getAircraft(QList<atools::fs::sc::SimConnectAircraft>& result, const atools::geo::Rect& rect) const;
+
+  /* Get aircraft by callsign or null if not found. First one is returned for duplicate callsigns. */
+  const atools::fs::sc::SimConnectAircraft *getAircraftByCallsign(const QString& callsign) const;
+
+  /* Position for callsign or invalid position if not found */
+  atools::geo::Pos getPosition(const QString& callsign) const;
+
+  int size() const
+  {
+    return aircraft.size();
+  }
+
+  bool isEmpty() const
+  {
+    return aircraft.isEmpty();
+  }
+
+private:
+  static int cellKey(int lonX, int latY);
+
+  QVector<atools::fs::sc::SimConnectAircraft> aircraft;
+
+  /* Cell key to indexes in aircraft */
+  QHash<int, QVector<int> > cells;
+
+  /* Callsign to index in aircraft */
+  QHash<QString, int> callsigns;
+};
+
+#endif // LNM_ONLINEAIRCRAFTINDEX_H
@@ -27,6 +27,7 @@
 #include "zip/gzip.h"
 #include "gui/dialog.h"
 #include "geo/calculations.h"
+#include "geo/rect.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
 #include "mapgui/maplayer.h"
@@ -34,10 +35,13 @@
 #include "navapp.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QApplication>
 
+#include <marble/GeoDataLatLonBox.h>
+
 // #define DEBUG_ONLINE_DOWNLOAD 1
 
 static const int MIN_SERVER_DOWNLOAD_INTERVAL_MIN = 15;
@@ -258,24 +262,18 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
   }
   else if(currentState == DOWNLOADING_WHAZZUP)
   {
-    QByteArray whazzupData;
-
-    if(whazzupGzipped)
+    bool recent;
     {
-      if(!atools::zip::gzipDecompress(data, whazzupData))
-        qWarning() << Q_FUNC_INFO << "Error unzipping data";
+      // Only the decoded text is alive while parsing - decompressed bytes are already released
+      QString whazzupText = decodeWhazzup(data, whazzupGzipped);
+      recent = manager->readFromWhazzup(whazzupText, convertFormat(OptionData::instance().getOnlineFormat()),
+                                        manager->getLastUpdateTimeFromWhazzup());
     }
-    else
-      whazzupData = data;
 
-    if(manager->readFromWhazzup(codec->toUnicode(whazzupData),
-                                convertFormat(OptionData::instance().getOnlineFormat()),
-                                manager->getLastUpdateTimeFromWhazzup()))
+    if(recent)
     {
-      // Get all callsigns and positions from online list to allow deduplication
-      clientCallsignAndPosMap.clear();
-      manager->getClientCallsignAndPosMap(clientCallsignAndPosMap);
-      qDebug() << Q_FUNC_INFO << clientCallsignAndPosMap.size();
+      // Load all clients into memory for map display and deduplication
+      buildAircraftIndex();
 
       QString whazzupVoiceUrlFromStatus = manager->getWhazzupVoiceUrlFromStatus();
       if(!whazzupVoiceUrlFromStatus.isEmpty() &&
@@ -335,6 +333,24 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
   }
 }
 
+QString OnlinedataController::decodeWhazzup(const QByteArray& data, bool gzipped) const
+{
+  QString text;
+  if(gzipped)
+  {
+    QByteArray whazzupData;
+    if(!atools::zip::gzipDecompress(data, whazzupData))
+      qWarning() << Q_FUNC_INFO << "Error unzipping data";
+
+    text = codec->toUnicode(whazzupData);
+  }
+  else
+    // Decode directly from the download buffer
+    text = codec->toUnicode(data);
+
+  return text;
+}
+
 void OnlinedataController::downloadFailed(const QString& error, int errorCode, QString url)
 {
   qWarning() << Q_FUNC_INFO << "Failed" << error << errorCode << url;
@@ -377,7 +393,7 @@ void OnlinedataController::stopAllProcesses()
   downloadTimer.stop();
   currentState = NONE;
   simulatorAiRegistrations.clear();
-  // clientCallsignAndPosMap.clear(); // Do not clear these until the download is finished
+  // aircraftIndex.clear(); // Do not clear these until the download is finished
 }
 
 void OnlinedataController::showMessageDialog()
@@ -420,7 +436,8 @@ void OnlinedataController::optionsChanged()
   manager->clearData();
   aircraftCache.clear();
   simulatorAiRegistrations.clear();
-  clientCallsignAndPosMap.clear();
+  aircraftIndex.clear();
+  positionsUpdateTime = QDateTime();
 
   updateAtcSizes();
 
@@ -535,22 +552,21 @@ const QList<atools::fs::sc::SimConnectAircraft> *OnlinedataController::getAircra
 
   if((aircraftCache.list.isEmpty() && !lazy))
   {
+    QList<SimConnectAircraft> aircraftList;
     for(const Marble::GeoDataLatLonBox& r :
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+      aircraftIndex.getAircraft(aircraftList, atools::geo::Rect(r.west(Marble::GeoDataCoordinates::Degree),
+                                                                r.north(Marble::GeoDataCoordinates::Degree),
+                                                                r.east(Marble::GeoDataCoordinates::Degree),
+                                                                r.south(Marble::GeoDataCoordinates::Degree)));
+
+    for(const SimConnectAircraft& aircraft : aircraftList)
     {
-      query::bindRect(r, aircraftByRectQuery);
-      aircraftByRectQuery->exec();
-      while(aircraftByRectQuery->next())
-      {
-        atools::fs::sc::SimConnectAircraft aircraft;
-        fillAircraftFromClient(aircraft, aircraftByRectQuery->record());
-
-        if(!curRegistrations.contains(aircraft.getAirplaneRegistration()) ||
-           aircraft.getPosition().distanceMeterTo(curRegistrations.value(aircraft.getAirplaneRegistration())) >
-           MIN_DISTANCE_DUPLICATE_M)
-          // Avoid duplicates with simulator aircraft that are close by
-          aircraftCache.list.append(aircraft);
-      }
+      if(!curRegistrations.contains(aircraft.getAirplaneRegistration()) ||
+         aircraft.getPosition().distanceMeterTo(curRegistrations.value(aircraft.getAirplaneRegistration())) >
+         MIN_DISTANCE_DUPLICATE_M)
+        // Avoid duplicates with simulator aircraft that are close by
+        aircraftCache.list.append(aircraft);
     }
     simulatorAiRegistrations = curRegistrations;
   }
@@ -563,11 +579,11 @@ bool OnlinedataController::getShadowAircraft(atools::fs::sc::SimConnectAircraft&
 {
   if(isShadowAircraft(simAircraft))
   {
-    atools::sql::SqlRecordVector clients = manager->getClientRecordsByCallsign(simAircraft.getAirplaneRegistration());
+    const SimConnectAircraft *client = aircraftIndex.getAircraftByCallsign(simAircraft.getAirplaneRegistration());
 
-    if(!clients.isEmpty())
+    if(client != nullptr)
     {
-      fillAircraftFromClient(onlineClient, clients.first());
+      onlineClient = *client;
 
       // Update to real simulator position including altitude for shadows
       onlineClient.getPosition() = simAircraft.getPosition();
@@ -581,7 +597,7 @@ bool OnlinedataController::getShadowAircraft(atools::fs::sc::SimConnectAircraft&
 
 bool OnlinedataController::isShadowAircraft(const atools::fs::sc::SimConnectAircraft& simAircraft)
 {
-  const atools::geo::Pos pos = clientCallsignAndPosMap.value(simAircraft.getAirplaneRegistration());
+  const atools::geo::Pos pos = aircraftIndex.getPosition(simAircraft.getAirplaneRegistration());
   return simAircraft.isOnlineShadow() ||
          (pos.isValid() && pos.distanceMeterTo(simAircraft.getPosition()) < MIN_DISTANCE_DUPLICATE_M);
 }
@@ -632,11 +648,6 @@ void OnlinedataController::initQueries()
   deInitQueries();
 
   manager->initQueries();
-
-  aircraftByRectQuery = new atools::sql::SqlQuery(getDatabase());
-  aircraftByRectQuery->prepare("select * from client "
-                               "where lonx between :leftx and :rightx and "
-                               "laty between :bottomy and :topy");
 }
 
 void OnlinedataController::deInitQueries()
@@ -644,9 +655,28 @@ void OnlinedataController::deInitQueries()
   aircraftCache.clear();
 
   manager->deInitQueries();
+}
+
+void OnlinedataController::buildAircraftIndex()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QVector<SimConnectAircraft> aircraftList;
+  aircraftList.reserve(manager->getNumClients());
+
+  atools::sql::SqlQuery query(getDatabase());
+  query.exec("select * from client");
+  while(query.next())
+  {
+    SimConnectAircraft aircraft;
+    fillAircraftFromClient(aircraft, query.record());
+    aircraftList.append(aircraft);
+  }
+  aircraftIndex.build(aircraftList);
+  positionsUpdateTime = QDateTime::currentDateTime();
 
-  delete aircraftByRectQuery;
-  aircraftByRectQuery = nullptr;
+  qDebug() << Q_FUNC_INFO << aircraftIndex.size() << "clients indexed in" << timer.elapsed() << "ms";
 }
 
 int OnlinedataController::getNumClients() const
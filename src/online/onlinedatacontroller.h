@@ -24,6 +24,7 @@
 
 #include "query/querytypes.h"
 #include "fs/online/onlinetypes.h"
+#include "online/onlineaircraftindex.h"
 
 class MapLayer;
 
@@ -91,6 +92,13 @@ public:
     return lastUpdateTime;
   }
 
+  /* Time when client positions were last reloaded from whazzup. Invalid if no positions are loaded.
+   * Not touched by status only or outdated downloads. */
+  const QDateTime& getPositionsUpdateTime() const
+  {
+    return positionsUpdateTime;
+  }
+
   bool hasData() const;
 
   /* VATSIM, IVAO or Custom (localized) */
@@ -100,7 +108,7 @@ public:
   QString getNetwork() const;
   bool isNetworkActive() const;
 
-  /* Get aircraft within bounding rectangle. Objects are cached. */
+  /* Get aircraft within bounding rectangle. Objects are cached and taken from the in-memory index. */
   const QList<atools::fs::sc::SimConnectAircraft> *getAircraft(const Marble::GeoDataLatLonBox& rect,
                                                                const MapLayer *mapLayer, bool lazy);
 
@@ -158,6 +166,12 @@ private:
   /* Show message from status.txt */
   void showMessageDialog();
 
+  /* Decompress if needed and decode whazzup data to text. Intermediate buffers are released before returning. */
+  QString decodeWhazzup(const QByteArray& data, bool gzipped) const;
+
+  /* Load all clients from the database into the in-memory index after a download */
+  void buildAircraftIndex();
+
   /* Tries to fetch geometry for atc centers from the user geometry database from cache */
   atools::geo::LineString *geometryCallback(const QString& callsign, atools::fs::online::fac::FacilityType type);
 
@@ -183,6 +197,9 @@ private:
   /*  Last update from whazzup */
   QDateTime lastUpdateTime;
 
+  /* Set when the aircraft index is rebuilt. Used for extrapolation of client positions. */
+  QDateTime positionsUpdateTime;
+
   /* Set after parsing status.txt to indicate compressed file */
   bool whazzupGzipped = false;
 
@@ -191,10 +208,10 @@ private:
   /* Simulator aircraft registrations and positions */
   QHash<QString, atools::geo::Pos> simulatorAiRegistrations;
 
-  QHash<QString, atools::geo::Pos> clientCallsignAndPosMap;
+  /* All online clients with spatial and callsign index. Rebuilt on each download. */
+  OnlineAircraftIndex aircraftIndex;
 
   query::SimpleRectCache<atools::fs::sc::SimConnectAircraft> aircraftCache;
-  atools::sql::SqlQuery *aircraftByRectQuery = nullptr;
 };
 
 #endif // LNM_ONLINECONTROLLER_H
@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "profile/elevationpyramid.h"
+
+#include <algorithm>
+#include <limits>
+
+void ElevationPyramid::append(float distanceNm, float elevationFt)
+{
+  if(minLevels.isEmpty())
+    minLevels.append(QVector<float>());
+
+  // Leg distances are summed up separately - do not allow to go back at leg boundaries
+  if(!distances.isEmpty() && distanceNm < distances.last())
+    distanceNm = distances.last();
+
+  distances.append(distanceNm);
+  minLevels.first().append(elevationFt);
+}
+
+void ElevationPyramid::finish()
+{
+  if(minLevels.isEmpty())
+    return;
+
+  // Remove all but the first level in case finish is called twice
+  minLevels.resize(1);
+  maxLevels.clear();
+  maxLevels.append(minLevels.first());
+
+  // Build levels until only one entry is left
+  while(minLevels.last().size() > 1)
+  {
+    const QVector<float>& lowerMin = minLevels.last();
+    const QVector<float>& lowerMax = maxLevels.last();
+    int size = (lowerMin.size() + 1) / 2;
+
+    QVector<float> levelMin(size), levelMax(size);
+    for(int i = 0; i < size; i++)
+    {
+      int i1 = i * 2, i2 = std::min(i * 2 + 1, lowerMin.size() - 1);
+      levelMin[i] = std::min(lowerMin.at(i1), lowerMin.at(i2));
+      levelMax[i] = std::max(lowerMax.at(i1), lowerMax.at(i2));
+    }
+    minLevels.append(levelMin);
+    maxLevels.append(levelMax);
+  }
+}
+
+void ElevationPyramid::clear()
+{
+  distances.clear();
+  minLevels.clear();
+  maxLevels.clear();
+}
+
+bool ElevationPyramid::getMinMax(float fromNm, float toNm, float& minFt, float& maxFt) const
+{
+  if(distances.isEmpty() || maxLevels.isEmpty())
+    return false;
+
+  int from = static_cast<int>(std::lower_bound(distances.constBegin(), distances.constEnd(), fromNm) -
+                              distances.constBegin());
+  int to = static_cast<int>(std::lower_bound(distances.constBegin(), distances.constEnd(), toNm) -
+                            distances.constBegin());
+
+  if(from >= to)
+    return false;
+
+  minMaxForIndex(from, to, minFt, maxFt);
+  return true;
+}
+
+float ElevationPyramid::getElevation(float distanceNm) const
+{
+  if(distances.isEmpty())
+    return 0.f;
+
+  const QVector<float>& elevations = minLevels.first();
+  int index = static_cast<int>(std::lower_bound(distances.constBegin(), distances.constEnd(), distanceNm) -
+                               distances.constBegin());
+
+  if(index <= 0)
+    return elevations.first();
+  else if(index >= distances.size())
+    return elevations.last();
+
+  float d1 = distances.at(index - 1), d2 = distances.at(index);
+  float e1 = elevations.at(index - 1), e2 = elevations.at(index);
+  if(d2 - d1 > 0.f)
+    return e1 + (e2 - e1) * (distanceNm - d1) / (d2 - d1);
+  else
+    return std::max(e1, e2);
+}
+
+void ElevationPyramid::minMaxForIndex(int from, int to, float& minFt, float& maxFt) const
+{
+  minFt = std::numeric_limits<float>::max();
+  maxFt = std::numeric_limits<float>::lowest();
+
+  while(from < to)
+  {
+    // Find the largest aligned block that starts at from and fits into the range
+    int level = 0;
+    while(level + 1 < minLevels.size() && (from & ((2 << level) - 1)) == 0 && from + (2 << level) <= to)
+      level++;
+
+    int index = from >> level;
+    minFt = std::min(minFt, minLevels.at(level).at(index));
+    maxFt = std::max(maxFt, maxLevels.at(level).at(index));
+    from += 1 << level;
+  }
+}
@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ELEVATIONPYRAMID_H
+#define LNM_ELEVATIONPYRAMID_H
+
+#include <QVector>
+
+/*
+ * Multi-resolution min/max pyramid over the elevation points of the whole flight plan.
+ *
+ * Level 0 contains the elevation of all points. Each following level contains the minimum and maximum of two
+ * adjacent entries of the level below. This allows to get the exact elevation envelope for any distance range,
+ * i.e. a pixel column in the profile, in logarithmic time independent of the zoom factor.
+ *
+ * Distances are along the flight plan in nautical miles from departure and elevations in feet.
+ */
+class ElevationPyramid
+{
+public:
+  /* Add a point. Distances have to be added in ascending order. Call finish() after adding all points. */
+  void append(float distanceNm, float elevationFt);
+
+  /* Build the upper levels. */
+  void finish();
+
+  void clear();
+
+  bool isEmpty() const
+  {
+    return distances.isEmpty();
+  }
+
+  int size() const
+  {
+    return distances.size();
+  }
+
+  /* Get minimum and maximum elevation for all points in the range from fromNm inclusive to toNm exclusive.
+   * Returns false if there are no points in this range. */
+  bool getMinMax(float fromNm, float toNm, float& minFt, float& maxFt) const;
+
+  /* Get linear interpolated elevation at the given distance. Clamps to first and last point. */
+  float getElevation(float distanceNm) const;
+
+private:
+  /* Get min and max for the index range from inclusive to exclusive */
+  void minMaxForIndex(int from, int to, float& minFt, float& maxFt) const;
+
+  QVector<float> distances;
+
+  /* Level 0 holds the raw elevations and is the same for min and max. It is filled in minLevels and
+   * copied to maxLevels by finish(). The copy is implicitly shared and does not use additional memory. */
+  QVector<QVector<float> > minLevels, maxLevels;
+};
+
+#endif // LNM_ELEVATIONPYRAMID_H
@@ -296,37 +296,65 @@ void ProfileWidget::updateScreenCoords()
 
   verticalScale = h / maxWindowAlt;
 
-  // Calculate the landmass polygon
+  // Calculate the waypoint lines
   waypointX.clear();
+  for(const ElevationLeg& leg : legList.elevationLegs)
+    waypointX.append(X0 + static_cast<int>(leg.distances.first() * horizontalScale));
+
+  // Destination point
+  waypointX.append(X0 + w);
+
+  // Landmass polygon is built for the visible region on demand in paintEvent()
+  landPolygon.clear();
+  landPolygonLeft = 0;
+  landPolygonRight = -1;
+}
+
+void ProfileWidget::updateLandPolygon(const QRect& visibleRect)
+{
+  int w = rect().width() - X0 * 2, h = rect().height() - Y0;
+
+  // Visible range limited to the profile drawing area
+  int left = std::max(X0, visibleRect.left()), right = std::min(X0 + w, visibleRect.right() + 1);
+  if(!landPolygon.isEmpty() && left >= landPolygonLeft && right <= landPolygonRight)
+    // Cached polygon covers the visible part
+    return;
+
+  const ElevationPyramid& pyramid = legList.pyramid;
   landPolygon.clear();
+  if(pyramid.isEmpty() || horizontalScale <= 0.f)
+    return;
+
+  // Add a margin of one visible width on each side to avoid rebuilding the polygon for small scroll distances
+  int margin = std::max(right - left, 1);
+  landPolygonLeft = std::max(X0, left - margin);
+  landPolygonRight = std::min(X0 + w, right + margin);
 
   // First point
-  landPolygon.append(QPoint(X0, h + Y0));
+  landPolygon.append(QPoint(landPolygonLeft, h + Y0));
 
-  for(const ElevationLeg& leg : legList.elevationLegs)
+  // Get the min/max elevation for each pixel column ==================================
+  float minFt, maxFt;
+  for(int x = landPolygonLeft; x <= landPolygonRight; x++)
   {
-    waypointX.append(X0 + static_cast<int>(leg.distances.first() * horizontalScale));
-
-    QPoint lastPt;
-    for(int i = 0; i < leg.elevation.size(); i++)
+    float fromNm = (x - X0) / horizontalScale, toNm = (x + 1 - X0) / horizontalScale;
+    if(pyramid.getMinMax(fromNm, toNm, minFt, maxFt))
     {
-      float alt = leg.elevation.at(i).getAltitude();
-      QPoint pt(X0 + static_cast<int>(leg.distances.at(i) * horizontalScale),
-                Y0 + static_cast<int>(h - alt *verticalScale));
-
-      if(lastPt.isNull() || i == leg.elevation.size() - 1 || (lastPt - pt).manhattanLength() > 2)
-      {
-        landPolygon.append(pt);
-        lastPt = pt;
-      }
+      // Column contains one or more points - add envelope which keeps peaks exact
+      int yMax = Y0 + static_cast<int>(h - maxFt * verticalScale);
+      int yMin = Y0 + static_cast<int>(h - minFt * verticalScale);
+      landPolygon.append(QPoint(x, yMin));
+      if(yMin != yMax)
+        landPolygon.append(QPoint(x, yMax));
     }
+    else
+      // Zoomed in - no points in this column - interpolate
+      landPolygon.append(QPoint(x, Y0 + static_cast<int>(h - pyramid.getElevation((fromNm + toNm) / 2.f) *
+                                                         verticalScale)));
   }
 
-  // Destination point
-  waypointX.append(X0 + w);
-
   // Last point closing polygon
-  landPolygon.append(QPoint(X0 + w, h + Y0));
+  landPolygon.append(QPoint(landPolygonRight, h + Y0));
 }
 
 QVector<std::pair<int, int> > ProfileWidget::calcScaleValues()
@@ -652,6 +680,7 @@ void ProfileWidget::paintEvent(QPaintEvent *)
   painter.fillRect(X0, 0, rect().width() - X0 * 2, rect().height(), mapcolors::profileSkyColor);
 
   // Draw the ground ======================================================
+  updateLandPolygon(visibleRegion().boundingRect());
   painter.setBrush(mapcolors::profileLandColor);
   painter.setPen(mapcolors::profileLandOutlinePen);
   painter.drawPolygon(landPolygon);
@@ -1364,6 +1393,7 @@ ProfileWidget::ElevationLegList ProfileWidget::fetchRouteElevationsThread(Elevat
   legs.totalDistance = 0.f;
   legs.maxElevationFt = 0.f;
   legs.elevationLegs.clear();
+  legs.pyramid.clear();
 
   if(legs.route.getSizeWithoutAlternates() <= 1)
     // Return empty result
@@ -1445,6 +1475,14 @@ ProfileWidget::ElevationLegList ProfileWidget::fetchRouteElevationsThread(Elevat
     legs.elevationLegs.append(leg);
   }
 
+  // Build min/max pyramid for painting
+  for(const ElevationLeg& leg : legs.elevationLegs)
+  {
+    for(int i = 0; i < leg.elevation.size(); i++)
+      legs.pyramid.append(leg.distances.at(i), leg.elevation.at(i).getAltitude());
+  }
+  legs.pyramid.finish();
+
   return legs;
 }
 
@@ -20,6 +20,7 @@
 
 #include "route/route.h"
 #include "fs/sc/simconnectdata.h"
+#include "profile/elevationpyramid.h"
 
 #include <QFutureWatcher>
 #include <QWidget>
@@ -171,6 +172,7 @@ private:
     float maxElevationFt = 0.f /* Maximum ground elevation for the route */,
           totalDistance = 0.f /* Total route distance in nautical miles */;
     int totalNumPoints = 0; /* Number of elevation points in whole flight plan */
+    ElevationPyramid pyramid; /* Min/max pyramid of all elevation points for fast painting */
   };
 
   /* Show position at x ordinate on profile on the map */
@@ -192,6 +194,10 @@ private:
   void updateTimeout();
   void updateThreadFinished();
   void updateScreenCoords();
+
+  /* Build the landmass polygon for the visible part of the widget only. Uses the min/max pyramid to get the exact
+   * elevation envelope for each pixel column. Does nothing if the cached polygon covers the range already. */
+  void updateLandPolygon(const QRect& visibleRect);
   void terminateThread();
   float calcGroundBuffer(float maxElevation);
 
@@ -286,7 +292,8 @@ private:
   bool widgetVisible = false, showAircraft = false, showAircraftTrack = false;
   QVector<int> waypointX; /* Flight plan waypoint screen coordinates - does contain the dummy
                            * from airport to runway but not missed legs */
-  QPolygon landPolygon; /* Green landmass polygon */
+  QPolygon landPolygon; /* Green landmass polygon. Covers only the visible part plus a margin. */
+  int landPolygonLeft = 0, landPolygonRight = -1; /* Widget x range covered by the landmass polygon */
   float minSafeAltitudeFt = 0.f, /* Red line */
         flightplanAltFt = 0.f, /* Cruise altitude */
         maxWindowAlt = 1.f; /* Maximum altitude at top of widget */
@@ -63,6 +63,13 @@ inline uint qHash(const NearestCacheKeyAirport& key)
 const static float MAX_HEADING_RUNWAY_DEVIATION = 20.f;
 const static float MAX_RUNWAY_DISTANCE_FT = 5000.f;
 
+/* Search radius for runway centers around the aircraft */
+const static float RUNWAY_SEARCH_RADIUS_NM = 5.f;
+
+/* Maximum deviation for lined up aircraft. Lateral distance is added to half of the runway width. */
+const static float MAX_HEADING_LINEUP_DEVIATION = 10.f;
+const static float MAX_LINEUP_DISTANCE_FT = 30.f;
+
 AirportQuery::AirportQuery(atools::sql::SqlDatabase *sqlDb, bool nav)
   : navdata(nav), db(sqlDb)
 {
@@ -632,17 +639,22 @@ map::MapResultIndex *AirportQuery::nearestAirportsProcInternal(const map::MapAir
 
   if(result == nullptr)
   {
-    map::MapResult res;
-    // Create a rectangle that roughly covers the requested region
-    ageo::Rect rect(airport.position, ageo::nmToMeter(distanceNm));
+    if(!procAirportNearestIndexValid)
+    {
+      procAirportNearestIndex.fill(db, "select airport_id, lonx, laty from airport where num_approach > 0");
+      procAirportNearestIndexValid = true;
+    }
 
-    bool xplane = NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11;
-    query::fetchObjectsForRect(rect, airportByRectAndProcQuery, [ =, &res](atools::sql::SqlQuery *query) -> void {
+    map::MapResult res;
+    QVector<int> ids;
+    procAirportNearestIndex.getRadius(ids, airport.position, ageo::nmToMeter(distanceNm));
+    for(int id : ids)
+    {
       map::MapAirport obj;
-      mapTypesFactory->fillAirport(query->record(), obj, true, navdata, xplane);
-      if(obj.ident != airport.ident)
+      getAirportById(obj, id);
+      if(obj.isValid() && obj.ident != airport.ident)
         res.airports.append(obj);
-    });
+    }
 
     result = new map::MapResultIndex;
     result->add(res);
@@ -658,87 +670,6 @@ map::MapResultIndex *AirportQuery::nearestAirportsProcInternal(const map::MapAir
   return result;
 }
 
-void AirportQuery::getBestRunwayEndAndAirport(map::MapRunwayEnd& runwayEnd, map::MapAirport& airport,
-                                              const QVector<map::MapRunway>& runways, const ageo::Pos& pos,
-                                              float heading, float maxRwDistance, float maxHeadingDeviation)
-{
-  if(!runways.isEmpty())
-  {
-    map::MapRunway runway;
-    ageo::LineDistance result;
-
-    // Loop through the list of distance ordered runways from getRunways
-    for(const map::MapRunway& rw : runways)
-    {
-      ageo::Line(rw.primaryPosition, rw.secondaryPosition).distanceMeterToLine(pos, result);
-      if(std::abs(result.distance) > ageo::feetToMeter(maxRwDistance))
-        continue;
-
-      map::MapRunwayEnd primaryEnd = getRunwayEndById(rw.primaryEndId);
-      map::MapRunwayEnd secondaryEnd = getRunwayEndById(rw.secondaryEndId);
-
-      // Check if either primary or secondary end matches by heading
-      if(ageo::angleInRange(heading,
-                            ageo::normalizeCourse(primaryEnd.heading - maxHeadingDeviation),
-                            ageo::normalizeCourse(primaryEnd.heading + maxHeadingDeviation)))
-      {
-        runwayEnd = primaryEnd;
-        runway = rw;
-        break;
-      }
-      else if(ageo::angleInRange(heading,
-                                 ageo::normalizeCourse(secondaryEnd.heading - maxHeadingDeviation),
-                                 ageo::normalizeCourse(secondaryEnd.heading + maxHeadingDeviation)))
-      {
-        runwayEnd = secondaryEnd;
-        runway = rw;
-        break;
-      }
-    }
-
-    if(runwayEnd.isValid())
-      getAirportById(airport, runway.airportId);
-    else
-    {
-      // No runway end found - get at least the nearest airport
-      getAirportById(airport, runways.first().airportId);
-      runwayEnd = map::MapRunwayEnd();
-    }
-  }
-}
-
-void AirportQuery::getRunways(QVector<map::MapRunway>& runways, const ageo::Rect& rect,
-                              const ageo::Pos& pos)
-{
-  SqlQuery query(db);
-  query.prepare("select * from runway where lonx between :leftx and :rightx and laty between :bottomy and :topy");
-
-  for(const ageo::Rect& r : rect.splitAtAntiMeridian())
-  {
-    query.bindValue(":leftx", r.getWest());
-    query.bindValue(":rightx", r.getEast());
-    query.bindValue(":bottomy", r.getSouth());
-    query.bindValue(":topy", r.getNorth());
-    query.exec();
-
-    while(query.next())
-    {
-      map::MapRunway runway;
-      mapTypesFactory->fillRunway(query.record(), runway, true /*overview*/);
-      runways.append(runway);
-    }
-  }
-
-  // Now sort the list of runways by distance to aircraft position and put the closest to the beginning of the list
-  std::sort(runways.begin(), runways.end(), [pos](const map::MapRunway& r1, const map::MapRunway& r2) -> bool
-  {
-    ageo::LineDistance result1, result2;
-    ageo::Line(r1.primaryPosition, r1.secondaryPosition).distanceMeterToLine(pos, result1);
-    ageo::Line(r2.primaryPosition, r2.secondaryPosition).distanceMeterToLine(pos, result2);
-    return std::abs(result1.distance) < std::abs(result2.distance);
-  });
-}
-
 const QList<map::MapTaxiPath> *AirportQuery::getTaxiPaths(int airportId)
 {
   if(taxipathCache.contains(airportId))
@@ -840,21 +771,35 @@ map::MapRunwayEnd AirportQuery::runwayEndByName(int airportId, const QString& ru
 bool AirportQuery::getBestRunwayEndForPosAndCourse(map::MapRunwayEnd& runwayEnd, map::MapAirport& airport,
                                                    const ageo::Pos& pos, float trackTrue)
 {
-  QVector<map::MapRunway> runways;
-
-  // Use inflated rectangle for query based on a radius or 5 NM
-  ageo::Rect rect(pos, ageo::nmToMeter(5.f));
+  updateRunwayIndex();
 
   // Get all runways nearby ordered by distance between pos and runway line
-  getRunways(runways, rect, pos);
+  QVector<int> indexes;
+  runwayIndex.getRunways(indexes, pos, ageo::nmToMeter(RUNWAY_SEARCH_RADIUS_NM));
 
-  // Get closest runway that matches heading
-  getBestRunwayEndAndAirport(runwayEnd, airport, runways, pos, trackTrue,
-                             MAX_RUNWAY_DISTANCE_FT, MAX_HEADING_RUNWAY_DEVIATION);
-
-  if(!runwayEnd.isValid())
-    getBestRunwayEndAndAirport(runwayEnd, airport, runways, pos, trackTrue,
-                               MAX_RUNWAY_DISTANCE_FT * 4.f, MAX_HEADING_RUNWAY_DEVIATION * 2.f);
+  if(!indexes.isEmpty())
+  {
+    // Get closest runway that matches heading
+    int airportId = -1;
+    int runwayEndId = runwayIndex.getRunwayEndId(airportId, indexes, pos, trackTrue,
+                                                 ageo::feetToMeter(MAX_RUNWAY_DISTANCE_FT),
+                                                 MAX_HEADING_RUNWAY_DEVIATION);
+
+    if(runwayEndId == -1)
+      runwayEndId = runwayIndex.getRunwayEndId(airportId, indexes, pos, trackTrue,
+                                               ageo::feetToMeter(MAX_RUNWAY_DISTANCE_FT * 4.f),
+                                               MAX_HEADING_RUNWAY_DEVIATION * 2.f);
+
+    if(runwayEndId != -1)
+      runwayEnd = getRunwayEndById(runwayEndId);
+    else
+    {
+      // No runway end found - get at least the nearest airport
+      airportId = runwayIndex.at(indexes.first()).airportId;
+      runwayEnd = map::MapRunwayEnd();
+    }
+    getAirportById(airport, airportId);
+  }
 
   if(!airport.isValid())
     qWarning() << Q_FUNC_INFO << "No runways or airports found for takeoff/landing";
@@ -863,6 +808,34 @@ bool AirportQuery::getBestRunwayEndForPosAndCourse(map::MapRunwayEnd& runwayEnd,
   return airport.isValid();
 }
 
+int AirportQuery::getRunwayEndIdLinedUp(int& airportId, const ageo::Pos& pos, float headingTrue)
+{
+  updateRunwayIndex();
+
+  QVector<int> indexes;
+  runwayIndex.getRunways(indexes, pos, ageo::nmToMeter(RUNWAY_SEARCH_RADIUS_NM));
+
+  // Check each runway separately since the allowed lateral distance depends on width
+  for(int idx : indexes)
+  {
+    float maxDistanceMeter = runwayIndex.at(idx).widthMeter / 2.f + ageo::feetToMeter(MAX_LINEUP_DISTANCE_FT);
+    int runwayEndId = runwayIndex.getRunwayEndId(airportId, {idx}, pos, headingTrue, maxDistanceMeter,
+                                                 MAX_HEADING_LINEUP_DEVIATION, true /* alongTrackOnly */);
+    if(runwayEndId != -1)
+      return runwayEndId;
+  }
+  return -1;
+}
+
+void AirportQuery::updateRunwayIndex()
+{
+  if(!runwayIndexValid)
+  {
+    runwayIndex.fill(db);
+    runwayIndexValid = true;
+  }
+}
+
 /* Compare runways to put betters ones (hard surface, longer) at the end of a list */
 bool AirportQuery::runwayCompare(const map::MapRunway& r1, const map::MapRunway& r2)
 {
@@ -988,10 +961,6 @@ void AirportQuery::initQueries()
   airportCoordsByIdentQuery = new SqlQuery(db);
   airportCoordsByIdentQuery->prepare("select lonx, laty from airport where ident = :ident ");
 
-  airportByRectAndProcQuery = new SqlQuery(db);
-  airportByRectAndProcQuery->prepare("select " + airportQueryBase.join(", ") + " from airport where " + whereRect +
-                                     " and num_approach > 0 " + whereLimit);
-
   runwayEndByIdQuery = new SqlQuery(db);
   runwayEndByIdQuery->prepare("select runway_end_id, end_type, name, heading, left_vasi_pitch, right_vasi_pitch, is_pattern, "
                               "left_vasi_type, right_vasi_type, "
@@ -1082,6 +1051,13 @@ void AirportQuery::deInitQueries()
   helipadCache.clear();
   airportIdentCache.clear();
   airportIdCache.clear();
+  nearestAirportCache.clear();
+
+  // Rebuild on next use
+  procAirportNearestIndex.clear();
+  procAirportNearestIndexValid = false;
+  runwayIndex.clear();
+  runwayIndexValid = false;
 
   delete runwayOverviewQuery;
   runwayOverviewQuery = nullptr;
@@ -1139,8 +1115,6 @@ void AirportQuery::deInitQueries()
   delete airportCoordsByIdentQuery;
   airportCoordsByIdentQuery = nullptr;
 
-  delete airportByRectAndProcQuery;
-  airportByRectAndProcQuery = nullptr;
 
   delete runwayEndByIdQuery;
   runwayEndByIdQuery = nullptr;
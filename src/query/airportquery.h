@@ -18,6 +18,9 @@
 #ifndef LITTLENAVMAP_AIRPORTQUERY_H
 #define LITTLENAVMAP_AIRPORTQUERY_H
 
+#include "query/nearestindex.h"
+#include "query/runwayindex.h"
+
 #include <QCache>
 
 namespace Marble {
@@ -134,9 +137,17 @@ public:
   QStringList getRunwayNames(int airportId);
   void getRunwayEndByNames(map::MapResult& result, const QString& runwayName, const QString& airportIdent);
   map::MapRunwayEnd getRunwayEndByName(int airportId, const QString& runway);
+
+  /* Get the runway end matching position and course. Falls back to wider tolerances if nothing was found.
+   * Only the nearest airport is returned if no runway end matches. Uses the in-memory runway index.
+   * Returns false if no airport was found. */
   bool getBestRunwayEndForPosAndCourse(map::MapRunwayEnd& runwayEnd, map::MapAirport& airport,
                                        const atools::geo::Pos& pos, float trackTrue);
 
+  /* Get id of the runway end if the aircraft is on a runway between the thresholds and its heading
+   * matches the runway end. Returns -1 if not lined up. Cheap enough to be called on each simulator update. */
+  int getRunwayEndIdLinedUp(int& airportId, const atools::geo::Pos& pos, float headingTrue);
+
   const QList<map::MapApron> *getAprons(int airportId);
 
   const QList<map::MapTaxiPath> *getTaxiPaths(int airportId);
@@ -151,15 +162,6 @@ public:
    * Uses distance * 4 and searches again if nothing was found.*/
   map::MapResultIndex *getNearestAirportsProc(const map::MapAirport& airport, float distanceNm);
 
-  /* Get a list of runways of all airports inside rectangle sorted by distance to pos */
-  void getRunways(QVector<map::MapRunway>& runways, const atools::geo::Rect& rect, const atools::geo::Pos& pos);
-
-  /* Get the best fitting runway end from the given list of runways according to heading.
-   *  Only the rearest airport is returned if no runway was found */
-  void getBestRunwayEndAndAirport(map::MapRunwayEnd& runwayEnd, map::MapAirport& airport,
-                                  const QVector<map::MapRunway>& runways, const atools::geo::Pos& pos, float heading,
-                                  float maxRwDistance, float maxHeadingDeviation);
-
   map::MapRunwayEnd getRunwayEndById(int id);
 
   /* Close all query objects thus disconnecting from the database */
@@ -185,6 +187,7 @@ private:
                                               bool lazy, bool overview);
 
   bool runwayCompare(const map::MapRunway& r1, const map::MapRunway& r2);
+  void updateRunwayIndex();
   bool hasQueryByAirportIdent(atools::sql::SqlQuery& query, const QString& ident) const;
   void startByNameAndPos(map::MapStart& start, int airportId, const QString& runwayEndName,
                          const atools::geo::Pos& position);
@@ -211,6 +214,14 @@ private:
   QCache<int, map::MapAirport> airportIdCache;
   QCache<NearestCacheKeyAirport, map::MapResultIndex> nearestAirportCache;
 
+  /* Positions of all airports having procedures. Built on first use after loading the database. */
+  NearestIndex procAirportNearestIndex;
+  bool procAirportNearestIndexValid = false;
+
+  /* All runways with end headings for takeoff, landing and line up detection. Built on first use. */
+  RunwayIndex runwayIndex;
+  bool runwayIndexValid = false;
+
   /* Database queries */
   atools::sql::SqlQuery *runwayOverviewQuery = nullptr, *apronQuery = nullptr,
                         *parkingQuery = nullptr, *startQuery = nullptr, *startByIdQuery = nullptr,
@@ -220,7 +231,7 @@ private:
                         *parkingNameQuery = nullptr;
 
   atools::sql::SqlQuery *airportByIdentQuery = nullptr, *airportByIcaoQuery = nullptr, *airportByPosQuery = nullptr,
-                        *airportCoordsByIdentQuery = nullptr, *airportByRectAndProcQuery = nullptr,
+                        *airportCoordsByIdentQuery = nullptr,
                         *runwayEndByIdQuery = nullptr, *runwayEndByNameQuery = nullptr, *airportByIdQuery = nullptr,
                         *airportAdminByIdQuery = nullptr, *airportProcByIdentQuery = nullptr,
                         *procArrivalByAirportIdentQuery = nullptr, *procDepartureByAirportIdentQuery = nullptr;
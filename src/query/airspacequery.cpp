@@ -17,6 +17,7 @@
 
 #include "query/airspacequery.h"
 
+#include "airspace/airspaceindex.h"
 #include "common/constants.h"
 #include "common/maptypesfactory.h"
 #include "mapgui/maplayer.h"
@@ -256,6 +257,38 @@ const LineString *AirspaceQuery::getAirspaceGeometryByName(int airspaceId)
   }
 }
 
+void AirspaceQuery::fillAirspaceIndex(AirspaceIndex& index, atools::sql::SqlQuery *query,
+                                      map::MapAirspaceSources source, bool hasFirUir)
+{
+  MapTypesFactory factory;
+  query->exec();
+  while(query->next())
+  {
+    if(hasFirUir)
+    {
+      // Skip deprecated centers like in getAirspaces()
+      QString name = query->valueStr("name");
+      if(name.contains("(FIR)") || name.contains("(UIR)") || name.contains("(FIR/UIR)"))
+        continue;
+    }
+
+    map::MapAirspace airspace;
+    factory.fillAirspace(query->record(), airspace, source);
+
+    LineString lines;
+    atools::fs::common::BinaryGeometry geometry(query->value("geometry").toByteArray());
+    geometry.swapGeometry(lines);
+
+    index.add(airspace, lines);
+  }
+  query->finish();
+}
+
+QString AirspaceQuery::getDatabaseFilename() const
+{
+  return db->databaseName();
+}
+
 LineString *AirspaceQuery::getAirspaceGeometryByFile(QString callsign)
 {
   if(airspaceGeoByFileQuery != nullptr)
@@ -449,6 +482,9 @@ void AirspaceQuery::initQueries()
   airspaceLinesByIdQuery = new SqlQuery(db);
   airspaceLinesByIdQuery->prepare("select geometry from " + table + " where " + id + " = :id");
 
+  airspaceAllGeometryQueryStr = "select " + airspaceQueryBase + ", geometry from " + table +
+                                " where geometry is not null";
+
   // Queries for online center boundary matches
   if(!(source & map::AIRSPACE_SRC_ONLINE))
   {
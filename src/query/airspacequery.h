@@ -35,6 +35,7 @@ class SqlRecord;
 
 class MapTypesFactory;
 class MapLayer;
+class AirspaceIndex;
 
 /*
  * Provides map related database queries around airspaces. Fill objects of the maptypes namespace and maintains a cache.
@@ -72,6 +73,26 @@ public:
   /* Tries to fetch online airspace geometry by  file name. */
   atools::geo::LineString *getAirspaceGeometryByFile(QString callsign);
 
+  /* Add all airspaces including geometry to the containment index using a query prepared with
+   * getAirspaceIndexQueryStr() on a separate connection. Does not call build(). Can be called in a worker thread. */
+  static void fillAirspaceIndex(AirspaceIndex& index, atools::sql::SqlQuery *query,
+                                map::MapAirspaceSources source, bool hasFirUir);
+
+  /* Statement for fillAirspaceIndex. Valid after initQueries. */
+  const QString& getAirspaceIndexQueryStr() const
+  {
+    return airspaceAllGeometryQueryStr;
+  }
+
+  /* File name of the database for opening separate connections */
+  QString getDatabaseFilename() const;
+
+  /* true if database contains new FIR/UIR types */
+  bool hasFirUirAirspaces() const
+  {
+    return hasFirUir;
+  }
+
   /* True if tables atc or boundary have content. Updated in clearCache and initQueries */
   bool hasAirspacesDatabase()
   {
@@ -114,6 +135,7 @@ private:
                         *airspaceByRectAboveAltQuery = nullptr, *airspaceByRectAtAltQuery = nullptr,
                         *airspaceLinesByIdQuery = nullptr, *airspaceGeoByNameQuery = nullptr,
                         *airspaceGeoByFileQuery = nullptr, *airspaceByIdQuery = nullptr, *airspaceInfoQuery = nullptr;
+  QString airspaceAllGeometryQueryStr;
 
   /* Source database definition */
   map::MapAirspaceSources source;
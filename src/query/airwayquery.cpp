@@ -24,6 +24,10 @@
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
 
+#include <QDebug>
+
+#include <numeric>
+
 using namespace Marble;
 using namespace atools::sql;
 using namespace atools::geo;
@@ -251,11 +255,60 @@ const QList<map::MapAirway> *AirwayQuery::getAirways(const GeoDataLatLonBox& rec
         ids.insert(airway.id);
       }
     }
+
+    buildAirwayLines();
   }
   airwayCache.validate(queryMaxRows);
   return &airwayCache.list;
 }
 
+void AirwayQuery::buildAirwayLines()
+{
+  airwayLines.clear();
+  const QList<map::MapAirway>& airways = airwayCache.list;
+
+  // Sort indexes by name, fragment and sequence to get the segments in order along the airway
+  QVector<int> indexes(airways.size());
+  std::iota(indexes.begin(), indexes.end(), 0);
+  std::sort(indexes.begin(), indexes.end(), [&airways](int index1, int index2) -> bool
+  {
+    const map::MapAirway& airway1 = airways.at(index1);
+    const map::MapAirway& airway2 = airways.at(index2);
+
+    if(airway1.name != airway2.name)
+      return airway1.name < airway2.name;
+    else if(airway1.fragment != airway2.fragment)
+      return airway1.fragment < airway2.fragment;
+    else
+      return airway1.sequence < airway2.sequence;
+  });
+
+  const map::MapAirway *last = nullptr;
+  for(int index : indexes)
+  {
+    const map::MapAirway& airway = airways.at(index);
+
+    // Start a new line if the segment is not connected to the last one or has a different color
+    if(last == nullptr || last->name != airway.name || last->fragment != airway.fragment ||
+       last->type != airway.type || last->toWaypointId != airway.fromWaypointId)
+    {
+      airwayLines.append(map::MapAirwayLine());
+      airwayLines.last().line.append(airway.from);
+      airwayLines.last().bounding = airway.bounding;
+    }
+
+    map::MapAirwayLine& line = airwayLines.last();
+    line.indexes.append(index);
+    line.line.append(airway.to);
+    line.bounding.extend(airway.bounding);
+    last = &airway;
+  }
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "segments" << airways.size() << "lines" << airwayLines.size();
+#endif
+}
+
 void AirwayQuery::initQueries()
 {
   airwayTable = trackDatabase ? "track" : "airway";
@@ -380,6 +433,7 @@ void AirwayQuery::deInitQueries()
 void AirwayQuery::clearCache()
 {
   airwayCache.clear();
+  airwayLines.clear();
   airwayByNameCache.clear();
   nearestNavaidCache.clear();
 }
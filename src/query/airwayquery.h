@@ -91,6 +91,12 @@ public:
    * if they have to be kept between event loop calls. */
   const QList<map::MapAirway> *getAirways(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy);
 
+  /* Airway segments from the last getAirways() call merged into lines. Contains indexes into the cached list. */
+  const QVector<map::MapAirwayLine>& getAirwayLines() const
+  {
+    return airwayLines;
+  }
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -102,11 +108,15 @@ public:
 private:
   map::MapWaypoint waypointById(int id);
 
+  /* Merge consecutive segments in airwayCache into airwayLines */
+  void buildAirwayLines();
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbNav;
 
   /* Simple bounding rectangle caches */
   query::SimpleRectCache<map::MapAirway> airwayCache;
+  QVector<map::MapAirwayLine> airwayLines;
 
   /* ID/object caches */
   QCache<query::NearestCacheKeyNavaid, map::MapResultIndex> nearestNavaidCache;
@@ -131,26 +131,30 @@ bool AirwayTrackQuery::hasAirwayForNameAndWaypoint(const QString& airwayName, co
   return !airways.isEmpty();
 }
 
-void AirwayTrackQuery::getAirways(QList<map::MapAirway>& airways, const GeoDataLatLonBox& rect,
-                                  const MapLayer *mapLayer, bool lazy)
+const QList<map::MapAirway> *AirwayTrackQuery::getAirways(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
+                                                          bool lazy, const QVector<map::MapAirwayLine> **lines)
 {
   if(mapLayer->isAirway())
   {
     const QList<map::MapAirway> *aw = airwayQuery->getAirways(rect, mapLayer, lazy);
-    if(aw != nullptr)
-      airways.append(*aw);
+    if(lines != nullptr)
+      *lines = &airwayQuery->getAirwayLines();
+    return aw;
   }
+  return nullptr;
 }
 
-void AirwayTrackQuery::getTracks(QList<map::MapAirway>& airways, const GeoDataLatLonBox& rect,
-                                 const MapLayer *mapLayer, bool lazy)
+const QList<map::MapAirway> *AirwayTrackQuery::getTracks(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
+                                                         bool lazy, const QVector<map::MapAirwayLine> **lines)
 {
   if(useTracks && mapLayer->isTrack())
   {
     const QList<map::MapAirway> *aw = trackQuery->getAirways(rect, mapLayer, lazy);
-    if(aw != nullptr)
-      airways.append(*aw);
+    if(lines != nullptr)
+      *lines = &trackQuery->getAirwayLines();
+    return aw;
   }
+  return nullptr;
 }
 
 void AirwayTrackQuery::initQueries()
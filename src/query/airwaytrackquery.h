@@ -97,11 +97,13 @@ public:
 
   /* Fill objects of the maptypes namespace and maintains a cache.
    * Objects from methods returning a pointer to a list might be deleted from the cache and should be copied
-   * if they have to be kept between event loop calls. */
-  void getAirways(QList<map::MapAirway>& airways, const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
-                  bool lazy);
-  void getTracks(QList<map::MapAirway>& airways, const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
-                 bool lazy);
+   * if they have to be kept between event loop calls.
+   * Returns null if airways or tracks are not shown for the layer.
+   * lines is set to the merged airway lines which refer to the returned list if not null. */
+  const QList<map::MapAirway> *getAirways(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy,
+                                          const QVector<map::MapAirwayLine> **lines = nullptr);
+  const QList<map::MapAirway> *getTracks(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy,
+                                         const QVector<map::MapAirwayLine> **lines = nullptr);
 
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
@@ -32,6 +32,11 @@
 #include "navapp.h"
 #include "settings/settings.h"
 #include "db/databasemanager.h"
+#include "sql/sqlutil.h"
+
+#include <QElapsedTimer>
+
+#include <cmath>
 
 using namespace Marble;
 using namespace atools::sql;
@@ -144,22 +149,95 @@ void MapQuery::getNdbForWaypoint(map::MapNdb& ndb, int waypointId)
 
 void MapQuery::getVorNearest(map::MapVor& vor, const atools::geo::Pos& pos)
 {
-  vorNearestQuery->bindValue(":lonx", pos.getLonX());
-  vorNearestQuery->bindValue(":laty", pos.getLatY());
-  vorNearestQuery->exec();
-  if(vorNearestQuery->next())
-    mapTypesFactory->fillVor(vorNearestQuery->record(), vor);
-  vorNearestQuery->finish();
+  updateNearestIndexes();
+  int id = vorNearestIndex.getNearestId(pos);
+  if(id != -1)
+    vor = getVorById(id);
 }
 
 void MapQuery::getNdbNearest(map::MapNdb& ndb, const atools::geo::Pos& pos)
 {
-  ndbNearestQuery->bindValue(":lonx", pos.getLonX());
-  ndbNearestQuery->bindValue(":laty", pos.getLatY());
-  ndbNearestQuery->exec();
-  if(ndbNearestQuery->next())
-    mapTypesFactory->fillNdb(ndbNearestQuery->record(), ndb);
-  ndbNearestQuery->finish();
+  updateNearestIndexes();
+  int id = ndbNearestIndex.getNearestId(pos);
+  if(id != -1)
+    ndb = getNdbById(id);
+}
+
+void MapQuery::updateNearestIndexes()
+{
+  if(nearestIndexesValid)
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  if(atools::sql::SqlUtil(dbNav).hasTable("vor"))
+    vorNearestIndex.fill(dbNav, "select vor_id, lonx, laty from vor");
+  if(atools::sql::SqlUtil(dbNav).hasTable("ndb"))
+    ndbNearestIndex.fill(dbNav, "select ndb_id, lonx, laty from ndb");
+  if(atools::sql::SqlUtil(dbSim).hasTable("ils"))
+    ilsNearestIndex.fill(dbSim, "select ils_id, lonx, laty from ils");
+  nearestIndexesValid = true;
+
+  qDebug() << Q_FUNC_INFO << "VOR" << vorNearestIndex.size() << "NDB" << ndbNearestIndex.size()
+           << "ILS" << ilsNearestIndex.size() << "built in" << timer.elapsed() << "ms";
+
+  if(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_NEAREST_DEBUG, false).toBool())
+    benchmarkNearest();
+}
+
+void MapQuery::benchmarkNearest()
+{
+  // Use VOR positions as query points
+  QVector<Pos> positions;
+  SqlQuery posQuery(dbNav);
+  posQuery.exec("select lonx, laty from vor limit 500");
+  while(posQuery.next())
+    positions.append(Pos(posQuery.valueFloat("lonx"), posQuery.valueFloat("laty")));
+
+  if(positions.isEmpty())
+    return;
+
+  const float distanceNm = 50.f;
+  QElapsedTimer timer;
+
+  // Rectangle query, filter and sort as used before ====================
+  timer.start();
+  int numRect = 0;
+  for(const Pos& pos : positions)
+  {
+    QList<map::MapNdb> ndbs;
+    query::fetchObjectsForRect(Rect(pos, nmToMeter(distanceNm)), ndbsByRectQuery,
+                               [ =, &ndbs](atools::sql::SqlQuery *rectQuery) -> void {
+      map::MapNdb obj;
+      mapTypesFactory->fillNdb(rectQuery->record(), obj);
+      ndbs.append(obj);
+    });
+    maptools::removeByDistance(ndbs, pos, nmToMeter(distanceNm));
+    maptools::sortByDistance(ndbs, pos);
+    numRect += ndbs.size();
+  }
+  qint64 rectUs = timer.nsecsElapsed() / 1000;
+
+  // kd-tree radius query and loading objects by id as in nearestNavaidsInternal() ====================
+  timer.restart();
+  int numIndex = 0;
+  for(const Pos& pos : positions)
+  {
+    QVector<int> ids;
+    ndbNearestIndex.getRadius(ids, pos, nmToMeter(distanceNm));
+
+    // Already sorted by distance
+    QList<map::MapNdb> ndbs;
+    for(int id : ids)
+      ndbs.append(getNdbById(id));
+    numIndex += ndbs.size();
+  }
+  qint64 indexUs = timer.nsecsElapsed() / 1000;
+
+  qDebug() << Q_FUNC_INFO << positions.size() << "NDB radius queries" << distanceNm << "NM"
+           << "rect query" << rectUs << "us" << numRect << "results"
+           << "index" << indexUs << "us" << numIndex << "results";
 }
 
 map::MapResultIndex *MapQuery::getNearestNavaids(const Pos& pos, float distanceNm, map::MapTypes type,
@@ -185,22 +263,23 @@ map::MapResultIndex *MapQuery::nearestNavaidsInternal(const Pos& pos, float dist
     // Create a rectangle that roughly covers the requested region
     atools::geo::Rect rect(pos, atools::geo::nmToMeter(distanceNm));
 
+    updateNearestIndexes();
+    QVector<int> ids;
+
     if(type & map::VOR)
     {
-      query::fetchObjectsForRect(rect, vorsByRectQuery, [ =, &res](atools::sql::SqlQuery *query) -> void {
-        map::MapVor obj;
-        mapTypesFactory->fillVor(query->record(), obj);
-        res.vors.append(obj);
-      });
+      vorNearestIndex.getRadius(ids, pos, atools::geo::nmToMeter(distanceNm));
+      for(int id : ids)
+        res.vors.append(getVorById(id));
+      ids.clear();
     }
 
     if(type & map::NDB)
     {
-      query::fetchObjectsForRect(rect, ndbsByRectQuery, [ =, &res](atools::sql::SqlQuery *query) -> void {
-        map::MapNdb obj;
-        mapTypesFactory->fillNdb(query->record(), obj);
-        res.ndbs.append(obj);
-      });
+      ndbNearestIndex.getRadius(ids, pos, atools::geo::nmToMeter(distanceNm));
+      for(int id : ids)
+        res.ndbs.append(getNdbById(id));
+      ids.clear();
     }
 
     if(type & map::WAYPOINT)
@@ -225,16 +304,11 @@ map::MapResultIndex *MapQuery::nearestNavaidsInternal(const Pos& pos, float dist
 
     if(type & map::ILS)
     {
-      QList<map::MapIls> ilsRes;
-
-      query::fetchObjectsForRect(rect, ilsByRectQuery, [ =, &ilsRes](atools::sql::SqlQuery *query) -> void {
-        map::MapIls obj;
-        mapTypesFactory->fillIls(query->record(), obj);
-        ilsRes.append(obj);
-      });
-      maptools::removeByDistance(ilsRes, pos, atools::geo::nmToMeter(maxIlsDist));
-      maptools::sortByDistance(ilsRes, pos);
-      res.ils.append(ilsRes.mid(0, maxIls));
+      // Already sorted by distance
+      ilsNearestIndex.getNearest(ids, pos, maxIls, atools::geo::nmToMeter(maxIlsDist));
+      for(int id : ids)
+        res.ils.append(getIlsById(id));
+      ids.clear();
     }
 
     result = new map::MapResultIndex;
@@ -553,9 +627,9 @@ void MapQuery::getNearestScreenObjects(const CoordinateConverter& conv, const Ma
   // No flag since visibility is defined by type
   if(mapLayer->isUserpoint())
   {
-    for(int i = userpointCache.list.size() - 1; i >= 0; i--)
+    for(int i = userpointsVisible.size() - 1; i >= 0; i--)
     {
-      const MapUserpoint& wp = userpointCache.list.at(i);
+      const MapUserpoint& wp = userpointsVisible.at(i);
       if(conv.wToS(wp.position, x, y))
         if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
           insertSortedByDistance(conv, result.userpoints, &result.userpointIds, xs, ys, wp);
@@ -710,10 +784,46 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
                                                            const QStringList& typesAll, bool unknownType,
                                                            float distance)
 {
-  // No caching here since points can change and the dataset is usually small
-  QList<map::MapUserpoint> retval;
-  userpointCache.clear();
+  quint32 version = NavApp::getUserdataController()->getDataVersion();
+
+  // Query with the next lower power of two of the view distance to avoid reloading on each zoom step
+  // Points are filtered by visible_from afterwards
+  float queryDistance = distance > 1.f ? std::pow(2.f, std::floor(std::log2(distance))) : 0.f;
+
+  // Check if query parameters or userpoints have changed - the rectangle is checked by the cache itself
+  bool sameParameters = version == userpointCacheVersion && unknownType == userpointCacheUnknownType &&
+                        atools::almostEqual(queryDistance, userpointCacheDistance) &&
+                        types == userpointCacheTypes && typesAll == userpointCacheTypesAll;
+
+  if(userpointCache.updateCache(rect, nullptr, queryRectInflationFactor, queryRectInflationIncrement,
+                                false /* lazy */,
+                                [sameParameters](const MapLayer *, const MapLayer *) -> bool
+  {
+    return sameParameters;
+  }))
+  {
+    // Rectangle not covered or parameters changed
+    userpointCacheVersion = version;
+    userpointCacheUnknownType = unknownType;
+    userpointCacheDistance = queryDistance;
+    userpointCacheTypes = types;
+    userpointCacheTypesAll = typesAll;
+    loadUserdataPoints(rect, types, typesAll, unknownType, queryDistance);
+  }
 
+  // Filter by visibility distance - result is used for map screen index too
+  userpointsVisible.clear();
+  for(const map::MapUserpoint& userpoint : userpointCache.list)
+  {
+    if(userpoint.visibleFrom > distance)
+      userpointsVisible.append(userpoint);
+  }
+  return userpointsVisible;
+}
+
+void MapQuery::loadUserdataPoints(const GeoDataLatLonBox& rect, const QStringList& types,
+                                  const QStringList& typesAll, bool unknownType, float distance)
+{
   // Display either unknown or any type
   if(unknownType || !types.isEmpty())
   {
@@ -750,15 +860,13 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
 
           map::MapUserpoint userPoint;
           mapTypesFactory->fillUserdataPoint(userdataPointByRectQuery->record(), userPoint);
-          retval.append(userPoint);
 
-          // Cache has to be kept for map screen index
           userpointCache.list.append(userPoint);
         }
       }
     }
   }
-  return retval;
+  userpointCache.validate(queryMaxRows);
 }
 
 const QList<map::MapMarker> *MapQuery::getMarkers(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
@@ -995,16 +1103,6 @@ void MapQuery::initQueries()
                                 " from ndb where ndb_id in "
                                 "(select nav_id from waypoint w where w.waypoint_id = :id)");
 
-  // Get nearest VOR
-  vorNearestQuery = new SqlQuery(dbNav);
-  vorNearestQuery->prepare(
-    "select " + vorQueryBase + " from vor order by (abs(lonx - :lonx) + abs(laty - :laty)) limit 1");
-
-  // Get nearest NDB
-  ndbNearestQuery = new SqlQuery(dbNav);
-  ndbNearestQuery->prepare(
-    "select " + ndbQueryBase + " from ndb order by (abs(lonx - :lonx) + abs(laty - :laty)) limit 1");
-
   ilsByIdQuery = new SqlQuery(dbSim);
   ilsByIdQuery->prepare("select " + ilsQueryBase + " from ils where ils_id = :id");
 
@@ -1056,11 +1154,20 @@ void MapQuery::initQueries()
 void MapQuery::deInitQueries()
 {
   airportCache.clear();
+  userpointCache.clear();
+  userpointsVisible.clear();
   vorCache.clear();
   ndbCache.clear();
   markerCache.clear();
   ilsCache.clear();
   runwayOverwiewCache.clear();
+  nearestNavaidCache.clear();
+
+  // Rebuild on next use
+  vorNearestIndex.clear();
+  ndbNearestIndex.clear();
+  ilsNearestIndex.clear();
+  nearestIndexesValid = false;
 
   delete airportByRectQuery;
   airportByRectQuery = nullptr;
@@ -1101,11 +1208,6 @@ void MapQuery::deInitQueries()
   delete ndbByWaypointIdQuery;
   ndbByWaypointIdQuery = nullptr;
 
-  delete vorNearestQuery;
-  vorNearestQuery = nullptr;
-  delete ndbNearestQuery;
-  ndbNearestQuery = nullptr;
-
   delete ilsByIdQuery;
   ilsByIdQuery = nullptr;
 
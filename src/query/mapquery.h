@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_MAPQUERY_H
 
 #include "query/querytypes.h"
+#include "query/nearestindex.h"
 
 #include <QCache>
 
@@ -163,7 +164,7 @@ public:
   /* Get a partially filled runway list for the overview */
   const QList<map::MapRunway> *getRunwaysForOverview(int airportId);
 
-  /* Similar to getAirports but no caching since user points can change */
+  /* Similar to getAirports. Cache is invalidated if the userpoint data version of the controller changes. */
   const QList<map::MapUserpoint> getUserdataPoints(const Marble::GeoDataLatLonBox& rect, const QStringList& types,
                                                    const QStringList& typesAll,
                                                    bool unknownType, float distance);
@@ -178,6 +179,12 @@ public:
   bool hasDepartureProcedures(const map::MapAirport& airport);
 
 private:
+  /* Build kd-trees for VOR, NDB and ILS if not done yet after loading the database */
+  void updateNearestIndexes();
+
+  /* Compare nearest queries using rectangle queries with the kd-tree and log the result */
+  void benchmarkNearest();
+
   map::MapResultIndex *nearestNavaidsInternal(const atools::geo::Pos& pos, float distanceNm,
                                                     map::MapTypes type, int maxIls, float maxIlsDist);
 
@@ -191,6 +198,10 @@ private:
                                               bool lazy, bool overview);
   QVector<map::MapIls> ilsByAirportAndRunway(const QString& airportIdent, const QString& runway);
 
+  /* Fill userpointCache from database */
+  void loadUserdataPoints(const Marble::GeoDataLatLonBox& rect, const QStringList& types,
+                          const QStringList& typesAll, bool unknownType, float distance);
+
   void runwayEndByNameFuzzy(QList<map::MapRunwayEnd>& runwayEnds, const QString& name, const map::MapAirport& airport,
                             bool navData);
 
@@ -200,6 +211,15 @@ private:
   /* Simple bounding rectangle caches */
   query::SimpleRectCache<map::MapAirport> airportCache;
   query::SimpleRectCache<map::MapUserpoint> userpointCache;
+
+  /* Points from userpointCache filtered by view distance. Used for map screen index. */
+  QList<map::MapUserpoint> userpointsVisible;
+
+  /* Parameters of the last query used to fill userpointCache */
+  QStringList userpointCacheTypes, userpointCacheTypesAll;
+  bool userpointCacheUnknownType = false;
+  float userpointCacheDistance = 0.f;
+  quint32 userpointCacheVersion = 0;
   query::SimpleRectCache<map::MapVor> vorCache;
   query::SimpleRectCache<map::MapNdb> ndbCache;
   query::SimpleRectCache<map::MapMarker> markerCache;
@@ -209,6 +229,10 @@ private:
   QCache<int, QList<map::MapRunway> > runwayOverwiewCache;
   QCache<query::NearestCacheKeyNavaid, map::MapResultIndex> nearestNavaidCache;
 
+  /* Positions of all navaids for nearest queries. Built on first use after loading the database. */
+  NearestIndex vorNearestIndex, ndbNearestIndex, ilsNearestIndex;
+  bool nearestIndexesValid = false;
+
   static int queryMaxRows;
 
   /* Database queries */
@@ -223,8 +247,7 @@ private:
 
   atools::sql::SqlQuery *vorByIdQuery = nullptr, *ndbByIdQuery = nullptr, *vorByWaypointIdQuery = nullptr,
                         *ndbByWaypointIdQuery = nullptr, *ilsByIdQuery = nullptr, *ilsQuerySimByName = nullptr,
-                        *vorNearestQuery = nullptr,
-                        *ndbNearestQuery = nullptr, *userdataPointByIdQuery = nullptr;
+                        *userdataPointByIdQuery = nullptr;
 };
 
 #endif // LITTLENAVMAP_MAPQUERY_H
@@ -0,0 +1,169 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/nearestindex.h"
+
+#include "geo/pos.h"
+#include "sql/sqlquery.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Mean earth radius used to convert great circle distances to chords
+static const double EARTH_RADIUS_METER = 6371000.;
+static const double PI = 3.14159265358979323846;
+
+void NearestIndex::fill(atools::sql::SqlDatabase *db, const QString& queryStr)
+{
+  clear();
+
+  atools::sql::SqlQuery query(db);
+  query.exec(queryStr);
+  while(query.next())
+    add(query.value(0).toInt(), atools::geo::Pos(query.value(1).toFloat(), query.value(2).toFloat()));
+
+  build();
+}
+
+void NearestIndex::add(int id, const atools::geo::Pos& pos)
+{
+  Point point;
+  toCartesian(pos, point.coords);
+  point.id = id;
+  points.append(point);
+}
+
+void NearestIndex::build()
+{
+  buildRecursive(0, points.size(), 0);
+}
+
+void NearestIndex::clear()
+{
+  points.clear();
+}
+
+void NearestIndex::buildRecursive(int begin, int end, int depth)
+{
+  if(end - begin <= 1)
+    return;
+
+  int axis = depth % 3;
+  int mid = begin + (end - begin) / 2;
+  std::nth_element(points.begin() + begin, points.begin() + mid, points.begin() + end,
+                   [axis](const Point& p1, const Point& p2) -> bool
+  {
+    return p1.coords[axis] < p2.coords[axis];
+  });
+
+  buildRecursive(begin, mid, depth + 1);
+  buildRecursive(mid + 1, end, depth + 1);
+}
+
+void NearestIndex::getNearest(QVector<int>& ids, const atools::geo::Pos& pos, int maxNum,
+                              float maxDistanceMeter) const
+{
+  if(points.isEmpty() || maxNum <= 0 || !pos.isValid())
+    return;
+
+  float query[3];
+  toCartesian(pos, query);
+  float maxDistSq = chordSqForDistance(maxDistanceMeter);
+
+  // Max heap of the best candidates found so far
+  QVector<Candidate> heap;
+  searchRecursive(0, points.size(), 0, query, maxNum, maxDistSq, heap);
+
+  std::sort_heap(heap.begin(), heap.end());
+  for(const Candidate& candidate : heap)
+    ids.append(candidate.id);
+}
+
+void NearestIndex::getRadius(QVector<int>& ids, const atools::geo::Pos& pos, float distanceMeter) const
+{
+  getNearest(ids, pos, std::numeric_limits<int>::max(), distanceMeter);
+}
+
+int NearestIndex::getNearestId(const atools::geo::Pos& pos, float maxDistanceMeter) const
+{
+  QVector<int> ids;
+  getNearest(ids, pos, 1, maxDistanceMeter);
+  return ids.isEmpty() ? -1 : ids.first();
+}
+
+void NearestIndex::searchRecursive(int begin, int end, int depth, const float query[3], int maxNum,
+                                   float& maxDistSq, QVector<Candidate>& heap) const
+{
+  if(begin >= end)
+    return;
+
+  int axis = depth % 3;
+  int mid = begin + (end - begin) / 2;
+  const Point& point = points.at(mid);
+
+  float dx = point.coords[0] - query[0], dy = point.coords[1] - query[1], dz = point.coords[2] - query[2];
+  float distSq = dx * dx + dy * dy + dz * dz;
+
+  if(distSq <= maxDistSq)
+  {
+    heap.append({distSq, point.id});
+    std::push_heap(heap.begin(), heap.end());
+
+    if(heap.size() > maxNum)
+    {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.removeLast();
+    }
+
+    // Shrink search radius to the farthest candidate once enough are found
+    if(heap.size() == maxNum)
+      maxDistSq = heap.first().distSq;
+  }
+
+  // Search the side containing the query point first
+  float diff = query[axis] - point.coords[axis];
+  if(diff < 0.f)
+  {
+    searchRecursive(begin, mid, depth + 1, query, maxNum, maxDistSq, heap);
+    if(diff * diff <= maxDistSq)
+      searchRecursive(mid + 1, end, depth + 1, query, maxNum, maxDistSq, heap);
+  }
+  else
+  {
+    searchRecursive(mid + 1, end, depth + 1, query, maxNum, maxDistSq, heap);
+    if(diff * diff <= maxDistSq)
+      searchRecursive(begin, mid, depth + 1, query, maxNum, maxDistSq, heap);
+  }
+}
+
+void NearestIndex::toCartesian(const atools::geo::Pos& pos, float coords[3])
+{
+  double lonx = pos.getLonX() * PI / 180., laty = pos.getLatY() * PI / 180.;
+  coords[0] = static_cast<float>(std::cos(laty) * std::cos(lonx));
+  coords[1] = static_cast<float>(std::cos(laty) * std::sin(lonx));
+  coords[2] = static_cast<float>(std::sin(laty));
+}
+
+float NearestIndex::chordSqForDistance(float distanceMeter)
+{
+  // Half the central angle limited to half a circle
+  double halfAngle = std::min(static_cast<double>(distanceMeter) / EARTH_RADIUS_METER, PI) / 2.;
+  double chord = 2. * std::sin(halfAngle);
+
+  // Add a small epsilon to avoid losing points exactly at the border due to float precision
+  return static_cast<float>(chord * chord) * 1.0001f + 1e-14f;
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_NEARESTINDEX_H
+#define LNM_NEARESTINDEX_H
+
+#include <QString>
+#include <QVector>
+
+#include <limits>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * In-memory kd-tree over the positions of database objects like airports or navaids.
+ *
+ * Positions are stored as unit vectors on the sphere which avoids problems at the anti-meridian and the poles.
+ * The straight distance between unit vectors grows with the great circle distance, so the tree can answer
+ * k-nearest and radius queries without further projection.
+ *
+ * Built once after loading a database. Only ids are stored. Objects have to be fetched by id.
+ */
+class NearestIndex
+{
+public:
+  /* Fill index from query and build the tree. The query has to return id, lonx and laty in this order. */
+  void fill(atools::sql::SqlDatabase *db, const QString& queryStr);
+
+  /* Add a point. Call build() after adding all points. */
+  void add(int id, const atools::geo::Pos& pos);
+
+  /* Sort points into the tree */
+  void build();
+
+  void clear();
+
+  /* Get ids of up to maxNum nearest points within maxDistanceMeter sorted by distance from near to far */
+  void getNearest(QVector<int>& ids, const atools::geo::Pos& pos, int maxNum,
+                  float maxDistanceMeter = std::numeric_limits<float>::max()) const;
+
+  /* Get ids of all points within distanceMeter sorted by distance from near to far */
+  void getRadius(QVector<int>& ids, const atools::geo::Pos& pos, float distanceMeter) const;
+
+  /* Get id of the nearest point or -1 if index is empty or nothing is within maxDistanceMeter */
+  int getNearestId(const atools::geo::Pos& pos, float maxDistanceMeter = std::numeric_limits<float>::max()) const;
+
+  bool isEmpty() const
+  {
+    return points.isEmpty();
+  }
+
+  int size() const
+  {
+    return points.size();
+  }
+
+private:
+  struct Point
+  {
+    float coords[3];
+    int id;
+  };
+
+  /* Candidate for search result. Ordered by squared chord distance for the heap. */
+  struct Candidate
+  {
+    float distSq;
+    int id;
+
+    bool operator<(const Candidate& other) const
+    {
+      return distSq < other.distSq;
+    }
+
+  };
+
+  /* Recursively sort points so that the median of each range is in the middle and splits by axis depth % 3 */
+  void buildRecursive(int begin, int end, int depth);
+  void searchRecursive(int begin, int end, int depth, const float query[3], int maxNum, float& maxDistSq,
+                       QVector<Candidate>& heap) const;
+
+  static void toCartesian(const atools::geo::Pos& pos, float coords[3]);
+
+  /* Squared chord length for a great circle distance on the unit sphere */
+  static float chordSqForDistance(float distanceMeter);
+
+  QVector<Point> points;
+};
+
+#endif // LNM_NEARESTINDEX_H
@@ -626,7 +626,8 @@ proc::MapProcedureLegs *ProcedureQuery::fetchApproachLegs(const map::MapAirport&
   else
 #endif
   {
-    qDebug() << "buildApproachEntries" << airport.ident << "approachId" << approachId;
+    if(verbose)
+      qDebug() << "buildApproachEntries" << airport.ident << "approachId" << approachId;
 
     MapProcedureLegs *legs = buildApproachLegs(airport, approachId);
     postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
@@ -650,8 +651,9 @@ proc::MapProcedureLegs *ProcedureQuery::fetchTransitionLegs(const map::MapAirpor
   else
 #endif
   {
-    qDebug() << "buildApproachEntries" << airport.ident << "approachId" << approachId
-             << "transitionId" << transitionId;
+    if(verbose)
+      qDebug() << "buildApproachEntries" << airport.ident << "approachId" << approachId
+               << "transitionId" << transitionId;
 
     transitionLegQuery->bindValue(":id", transitionId);
     transitionLegQuery->exec();
@@ -94,6 +94,12 @@ public:
   /* Flush the cache to update units */
   void clearCache();
 
+  /* Disable logging of each built procedure. Used for batch processing. */
+  void setVerbose(bool value)
+  {
+    verbose = value;
+  }
+
   /* Create all queries */
   void initQueries();
 
@@ -198,6 +204,7 @@ private:
 
   MapQuery *mapQuery = nullptr;
   AirportQuery *airportQueryNav = nullptr;
+  bool verbose = true;
 
   /* Dummy used for custom approaches. */
   Q_DECL_CONSTEXPR static int CUSTOM_APPROACH_ID = 1000000000;
@@ -0,0 +1,183 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/procedurevalidation.h"
+
+#include "navapp.h"
+#include "query/procedurequery.h"
+#include "query/airportquery.h"
+#include "sql/sqlquery.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+
+using atools::sql::SqlQuery;
+
+/* Time slice in the event loop for building procedures */
+static const qint64 TIME_SLICE_MS = 20;
+
+/* Flush the internal caches of the query after this number of approaches to keep memory usage low */
+static const int CLEAR_CACHE_APPROACHES = 500;
+
+ProcedureValidation::ProcedureValidation(QObject *parent)
+  : QObject(parent)
+{
+}
+
+ProcedureValidation::~ProcedureValidation()
+{
+  cancel();
+}
+
+void ProcedureValidation::start(const QString& reportFilename)
+{
+  cancel();
+
+  atools::sql::SqlDatabase *dbNav = NavApp::getDatabaseNav();
+  if(dbNav == nullptr || !dbNav->isOpen() || dbNav->record("approach").isEmpty())
+  {
+    qWarning() << Q_FUNC_INFO << "No procedures in database";
+    return;
+  }
+
+  reportFile = new QFile(reportFilename);
+  if(!reportFile->open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << reportFilename << reportFile->errorString();
+    delete reportFile;
+    reportFile = nullptr;
+    return;
+  }
+  report = new QTextStream(reportFile);
+  report->setCodec("UTF-8");
+  *report << "Airport;Procedure Type;Procedure;Transition;Leg Type;Fix;Recommended Fix;Approach ID;Transition ID"
+          << endl;
+
+  // Load all ids first to avoid keeping a query open across event loop iterations
+  SqlQuery query(dbNav);
+  query.exec("select approach_id, airport_id from approach order by airport_id, approach_id");
+  while(query.next())
+    procedures.append(std::make_pair(query.valueInt("approach_id"), query.valueInt("airport_id")));
+
+  qInfo() << Q_FUNC_INFO << "Validating" << procedures.size() << "procedures. Report" << reportFilename;
+
+  procQuery = new ProcedureQuery(dbNav);
+  procQuery->setVerbose(false);
+  procQuery->initQueries();
+
+  processingTimeMs = 0;
+  QTimer::singleShot(0, this, &ProcedureValidation::processNext);
+}
+
+void ProcedureValidation::cancel()
+{
+  if(procQuery != nullptr && index < procedures.size())
+    qInfo() << Q_FUNC_INFO << "Validation cancelled at" << index << "of" << procedures.size();
+
+  delete procQuery;
+  procQuery = nullptr;
+
+  delete report;
+  report = nullptr;
+  delete reportFile;
+  reportFile = nullptr;
+
+  procedures.clear();
+  index = numApproaches = numTransitions = numLegs = numErrors = 0;
+}
+
+void ProcedureValidation::processNext()
+{
+  // Cancelled in the meantime
+  if(procQuery == nullptr)
+    return;
+
+  AirportQuery *airportQuery = NavApp::getAirportQueryNav();
+
+  timer.start();
+  while(index < procedures.size() && !timer.hasExpired(TIME_SLICE_MS))
+  {
+    int approachId = procedures.at(index).first;
+    map::MapAirport airport = airportQuery->getAirportById(procedures.at(index).second);
+    index++;
+
+    if(!airport.isValid())
+      continue;
+
+    if(numApproaches > 0 && numApproaches % CLEAR_CACHE_APPROACHES == 0)
+      procQuery->clearCache();
+
+    processLegs(airport.ident, procQuery->getApproachLegs(airport, approachId), false /* transition */);
+    numApproaches++;
+
+    for(int transitionId : procQuery->getTransitionIdsForApproach(approachId))
+    {
+      processLegs(airport.ident, procQuery->getTransitionLegs(airport, transitionId), true /* transition */);
+      numTransitions++;
+    }
+  }
+  processingTimeMs += timer.elapsed();
+
+  if(index < procedures.size())
+    QTimer::singleShot(0, this, &ProcedureValidation::processNext);
+  else
+    finish();
+}
+
+void ProcedureValidation::processLegs(const QString& airportIdent, const proc::MapProcedureLegs *legs, bool transition)
+{
+  if(legs == nullptr)
+    return;
+
+  numLegs += transition ? legs->transitionLegs.size() : legs->approachLegs.size();
+
+  if(!legs->hasError)
+    return;
+
+  // Transition legs include the approach - report only legs of the transition to avoid duplicate entries
+  const QVector<proc::MapProcedureLeg>& legList = transition ? legs->transitionLegs : legs->approachLegs;
+  for(const proc::MapProcedureLeg& leg : legList)
+  {
+    if(leg.hasErrorRef())
+    {
+      *report << airportIdent << ";"
+              << legs->approachType << ";"
+              << (legs->approachArincName.isEmpty() ? legs->approachFixIdent : legs->approachArincName) << ";"
+              << (transition ? legs->transitionFixIdent : QString()) << ";"
+              << proc::procedureLegTypeStr(leg.type) << ";"
+              << leg.fixIdent << ";"
+              << leg.recFixIdent << ";"
+              << legs->ref.approachId << ";"
+              << (transition ? legs->ref.transitionId : -1) << endl;
+      numErrors++;
+    }
+  }
+}
+
+void ProcedureValidation::finish()
+{
+  qInfo() << Q_FUNC_INFO << "Validation done."
+          << "Approaches" << numApproaches << "transitions" << numTransitions << "legs" << numLegs
+          << "legs with errors" << numErrors << "processing time" << processingTimeMs << "ms";
+
+  report->flush();
+  cancel();
+}
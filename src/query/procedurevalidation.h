@@ -0,0 +1,77 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_PROCEDUREVALIDATION_H
+#define LNM_PROCEDUREVALIDATION_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+
+class ProcedureQuery;
+class QTextStream;
+class QFile;
+
+namespace proc {
+struct MapProcedureLegs;
+}
+
+/*
+ * Batch job which builds all procedures and transitions of the navigation database and writes a validation
+ * report containing all procedures having unresolved fixes or recommended fixes.
+ *
+ * Uses a separate ProcedureQuery instance to avoid flushing the caches used by the GUI. Procedures are built
+ * in small time slices in the event loop since the queries are bound to the main thread.
+ */
+class ProcedureValidation :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ProcedureValidation(QObject *parent = nullptr);
+  virtual ~ProcedureValidation() override;
+
+  /* Start validation and write report to the given file. Stops a running validation first. */
+  void start(const QString& reportFilename);
+
+  /* Stop validation and close report. Has to be called before the database is closed. */
+  void cancel();
+
+  bool isRunning() const
+  {
+    return procQuery != nullptr;
+  }
+
+private:
+  /* Process procedures until the time slice is used up and reschedule itself */
+  void processNext();
+  void processLegs(const QString& airportIdent, const proc::MapProcedureLegs *legs, bool transition);
+  void finish();
+
+  /* Approach id and airport id for all procedures */
+  QVector<std::pair<int, int> > procedures;
+  int index = 0, numApproaches = 0, numTransitions = 0, numLegs = 0, numErrors = 0;
+
+  ProcedureQuery *procQuery = nullptr;
+  QFile *reportFile = nullptr;
+  QTextStream *report = nullptr;
+  QElapsedTimer timer;
+  qint64 processingTimeMs = 0;
+};
+
+#endif // LNM_PROCEDUREVALIDATION_H
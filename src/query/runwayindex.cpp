@@ -0,0 +1,135 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/runwayindex.h"
+
+#include "geo/calculations.h"
+#include "geo/line.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ageo = atools::geo;
+
+void RunwayIndex::fill(atools::sql::SqlDatabase *db)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  clear();
+
+  // Get both end headings with the runway to avoid loading the ends on each search
+  atools::sql::SqlQuery query(db);
+  query.exec("select r.airport_id, r.primary_end_id, r.secondary_end_id, r.width, r.lonx, r.laty, "
+             "r.primary_lonx, r.primary_laty, r.secondary_lonx, r.secondary_laty, "
+             "p.heading as primary_heading, s.heading as secondary_heading "
+             "from runway r "
+             "join runway_end p on r.primary_end_id = p.runway_end_id "
+             "join runway_end s on r.secondary_end_id = s.runway_end_id");
+
+  while(query.next())
+  {
+    Runway runway;
+    runway.airportId = query.value("airport_id").toInt();
+    runway.primaryEndId = query.value("primary_end_id").toInt();
+    runway.secondaryEndId = query.value("secondary_end_id").toInt();
+    runway.widthMeter = ageo::feetToMeter(query.value("width").toFloat());
+    runway.primaryHeading = query.value("primary_heading").toFloat();
+    runway.secondaryHeading = query.value("secondary_heading").toFloat();
+    runway.primaryPosition = ageo::Pos(query.value("primary_lonx").toFloat(), query.value("primary_laty").toFloat());
+    runway.secondaryPosition = ageo::Pos(query.value("secondary_lonx").toFloat(),
+                                         query.value("secondary_laty").toFloat());
+
+    index.add(runways.size(), ageo::Pos(query.value("lonx").toFloat(), query.value("laty").toFloat()));
+    runways.append(runway);
+  }
+  index.build();
+
+  qDebug() << Q_FUNC_INFO << "Loaded" << runways.size() << "runways in" << timer.elapsed() << "ms";
+}
+
+void RunwayIndex::clear()
+{
+  runways.clear();
+  index.clear();
+}
+
+void RunwayIndex::getRunways(QVector<int>& indexes, const ageo::Pos& pos, float radiusMeter) const
+{
+  index.getRadius(indexes, pos, radiusMeter);
+
+  // Calculate distances only once for sorting
+  QVector<std::pair<float, int> > distances;
+  distances.reserve(indexes.size());
+  for(int idx : indexes)
+  {
+    const Runway& runway = runways.at(idx);
+    ageo::LineDistance result;
+    ageo::Line(runway.primaryPosition, runway.secondaryPosition).distanceMeterToLine(pos, result);
+    distances.append(std::make_pair(std::abs(result.distance), idx));
+  }
+
+  // Put the runway with the closest centerline at the beginning of the list
+  std::stable_sort(distances.begin(), distances.end(),
+                   [](const std::pair<float, int>& d1, const std::pair<float, int>& d2) -> bool
+  {
+    return d1.first < d2.first;
+  });
+
+  indexes.clear();
+  for(const std::pair<float, int>& dist : distances)
+    indexes.append(dist.second);
+}
+
+int RunwayIndex::getRunwayEndId(int& airportId, const QVector<int>& indexes, const ageo::Pos& pos, float courseTrue,
+                                float maxRwDistanceMeter, float maxHeadingDeviation, bool alongTrackOnly) const
+{
+  for(int idx : indexes)
+  {
+    const Runway& runway = runways.at(idx);
+
+    ageo::LineDistance result;
+    ageo::Line(runway.primaryPosition, runway.secondaryPosition).distanceMeterToLine(pos, result);
+    if(std::abs(result.distance) > maxRwDistanceMeter)
+      // List is sorted by distance - all following are farther away
+      break;
+
+    if(alongTrackOnly && result.status != ageo::ALONG_TRACK)
+      continue;
+
+    // Check if either primary or secondary end matches by heading
+    if(ageo::angleInRange(courseTrue,
+                          ageo::normalizeCourse(runway.primaryHeading - maxHeadingDeviation),
+                          ageo::normalizeCourse(runway.primaryHeading + maxHeadingDeviation)))
+    {
+      airportId = runway.airportId;
+      return runway.primaryEndId;
+    }
+    else if(ageo::angleInRange(courseTrue,
+                               ageo::normalizeCourse(runway.secondaryHeading - maxHeadingDeviation),
+                               ageo::normalizeCourse(runway.secondaryHeading + maxHeadingDeviation)))
+    {
+      airportId = runway.airportId;
+      return runway.secondaryEndId;
+    }
+  }
+  return -1;
+}
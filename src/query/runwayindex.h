@@ -0,0 +1,84 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_RUNWAYINDEX_H
+#define LNM_RUNWAYINDEX_H
+
+#include "query/nearestindex.h"
+#include "geo/pos.h"
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * In-memory list of all runways with threshold positions and end headings plus a spatial index on the
+ * runway centers.
+ *
+ * Allows to find the runway end matching an aircraft position and course without any database access.
+ * Used to detect takeoff and landing runways and to detect the aircraft lining up on a runway.
+ */
+class RunwayIndex
+{
+public:
+  struct Runway
+  {
+    int airportId, primaryEndId, secondaryEndId;
+    float primaryHeading, secondaryHeading, widthMeter;
+    atools::geo::Pos primaryPosition, secondaryPosition;
+  };
+
+  /* Load all runways from the database and build the index */
+  void fill(atools::sql::SqlDatabase *db);
+
+  void clear();
+
+  /* Get indexes of all runways having their center within radiusMeter. Result is sorted by
+   * lateral distance between pos and runway centerline from near to far. */
+  void getRunways(QVector<int>& indexes, const atools::geo::Pos& pos, float radiusMeter) const;
+
+  /* Get runway end id of the first runway in indexes as returned by getRunways() which has pos within
+   * maxRwDistanceMeter of its centerline and an end heading matching course. Returns -1 if nothing was found.
+   * Only positions between the thresholds are accepted if alongTrackOnly is true. */
+  int getRunwayEndId(int& airportId, const QVector<int>& indexes, const atools::geo::Pos& pos, float courseTrue,
+                     float maxRwDistanceMeter, float maxHeadingDeviation, bool alongTrackOnly = false) const;
+
+  const Runway& at(int index) const
+  {
+    return runways.at(index);
+  }
+
+  bool isEmpty() const
+  {
+    return runways.isEmpty();
+  }
+
+  int size() const
+  {
+    return runways.size();
+  }
+
+private:
+  QVector<Runway> runways;
+
+  /* Ids in the index are indexes into runways */
+  NearestIndex index;
+};
+
+#endif // LNM_RUNWAYINDEX_H
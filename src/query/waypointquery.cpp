@@ -83,12 +83,23 @@ void WaypointQuery::getWaypointByByIdent(QList<map::MapWaypoint>& waypoints, con
 
 void WaypointQuery::getWaypointNearest(map::MapWaypoint& waypoint, const Pos& pos)
 {
-  waypointNearestQuery->bindValue(":lonx", pos.getLonX());
-  waypointNearestQuery->bindValue(":laty", pos.getLatY());
-  waypointNearestQuery->exec();
-  if(waypointNearestQuery->next())
-    mapTypesFactory->fillWaypoint(waypointNearestQuery->record(), waypoint, trackDatabase);
-  waypointNearestQuery->finish();
+  updateNearestIndex();
+  int id = nearestIndex.getNearestId(pos);
+  if(id != -1)
+    waypoint = getWaypointById(id);
+}
+
+void WaypointQuery::updateNearestIndex()
+{
+  if(!nearestIndexValid)
+  {
+    QString table = trackDatabase ? "trackpoint" : "waypoint";
+    QString id = trackDatabase ? "trackpoint_id" : "waypoint_id";
+
+    if(atools::sql::SqlUtil(dbNav).hasTable(table))
+      nearestIndex.fill(dbNav, "select " + id + ", lonx, laty from " + table);
+    nearestIndexValid = true;
+  }
 }
 
 void WaypointQuery::getWaypointsRect(QVector<map::MapWaypoint>& waypoints, const Pos& pos, float distanceNm)
@@ -110,10 +121,10 @@ void WaypointQuery::getWaypointsRect(QVector<map::MapWaypoint>& waypoints, const
 
 void WaypointQuery::getWaypointRectNearest(map::MapWaypoint& waypoint, const Pos& pos, float distanceNm)
 {
-  QVector<map::MapWaypoint> waypoints;
-  getWaypointsRect(waypoints, pos, distanceNm);
-  if(!waypoints.isEmpty())
-    waypoint = waypoints.first();
+  updateNearestIndex();
+  int id = nearestIndex.getNearestId(pos, nmToMeter(distanceNm));
+  if(id != -1)
+    waypoint = getWaypointById(id);
 }
 
 const QList<map::MapWaypoint> *WaypointQuery::getWaypoints(const GeoDataLatLonBox& rect,
@@ -206,11 +217,6 @@ void WaypointQuery::initQueries()
   waypointByIdentQuery = new SqlQuery(dbNav);
   waypointByIdentQuery->prepare("select " + waypointQueryBase + " from " + table + " where " + whereIdentRegion);
 
-  // Get nearest Waypoint
-  waypointNearestQuery = new SqlQuery(dbNav);
-  waypointNearestQuery->prepare(
-    "select " + waypointQueryBase + " from " + table + " order by (abs(lonx - :lonx) + abs(laty - :laty)) limit 1");
-
   waypointByIdQuery = new SqlQuery(dbNav);
   waypointByIdQuery->prepare("select " + waypointQueryBase + " from " + table + " where " + id + " = :id");
 
@@ -244,9 +250,6 @@ void WaypointQuery::deInitQueries()
   delete waypointByIdentQuery;
   waypointByIdentQuery = nullptr;
 
-  delete waypointNearestQuery;
-  waypointNearestQuery = nullptr;
-
   delete waypointRectQuery;
   waypointRectQuery = nullptr;
 
@@ -261,4 +264,8 @@ void WaypointQuery::clearCache()
 {
   waypointCache.clear();
   waypointInfoCache.clear();
+
+  // Rebuild on next use
+  nearestIndex.clear();
+  nearestIndexValid = false;
 }
@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_WAYPOINTQUERY_H
 
 #include "query/querytypes.h"
+#include "query/nearestindex.h"
 
 #include <QCache>
 
@@ -55,12 +56,14 @@ public:
   void getNearestScreenObjects(const CoordinateConverter& conv, const MapLayer *mapLayer, map::MapTypes types,
                                int xs, int ys, int screenDistance, map::MapResult& result);
 
-  /* Get nearest waypoint - slow */
+  /* Get nearest waypoint */
   void getWaypointNearest(map::MapWaypoint& waypoint, const atools::geo::Pos& pos);
 
   /* Get waypoints in rectangle by point and radius for maximum distance. Results are sorted by distance closest first.
    * Does not interfere with the cache. */
   void getWaypointsRect(QVector<map::MapWaypoint>& waypoints, const atools::geo::Pos& pos, float distanceNm);
+
+  /* Get nearest waypoint within distanceNm. Waypoint is not changed if nothing was found. */
   void getWaypointRectNearest(map::MapWaypoint& waypoint, const atools::geo::Pos& pos, float distanceNm);
 
   /* Similar to getAirports */
@@ -84,6 +87,9 @@ public:
   void clearCache();
 
 private:
+  /* Build kd-tree if not done yet after loading the database or tracks */
+  void updateNearestIndex();
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbNav;
 
@@ -91,12 +97,16 @@ private:
   query::SimpleRectCache<map::MapWaypoint> waypointCache;
   QCache<int, atools::sql::SqlRecord> waypointInfoCache;
 
+  /* Positions of all waypoints for nearest queries */
+  NearestIndex nearestIndex;
+  bool nearestIndexValid = false;
+
   static int queryMaxRows;
 
   bool trackDatabase;
 
   /* Database queries */
-  atools::sql::SqlQuery *waypointByIdQuery = nullptr, *waypointNearestQuery = nullptr, *waypointRectQuery = nullptr,
+  atools::sql::SqlQuery *waypointByIdQuery = nullptr, *waypointRectQuery = nullptr,
                         *waypointByIdentQuery = nullptr, *waypointsByRectQuery = nullptr, *waypointInfoQuery = nullptr;
 };
 
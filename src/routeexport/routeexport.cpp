@@ -40,27 +40,101 @@
 
 #include <QBitArray>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
 
 using atools::fs::pln::FlightplanIO;
 
+/* One file write for a format. Runs in a thread of the global pool. */
+struct ExportStep
+{
+  rexp::RouteExportFormatType type = rexp::NO_TYPE;
+  std::function<void(const QString& filename)> writeFunc;
+  bool rotate = false; /* Create backups before writing */
+  QString errorHeader, errorMessage; /* Error message is filled by the thread */
+  qint64 writeTimeMs = 0L;
+};
+
+/* All writes to one file. Formats sharing the same file are written sequentially in one job. */
+struct ExportJob
+{
+  QString filename;
+  QVector<ExportStep> steps;
+};
+
+struct RouteExport::MultiExportBatch
+{
+  /* Adjusted routes for each set of rf::RouteAdjustOptions. Built once on first use and not modified afterwards. */
+  QHash<int, Route> routes;
+
+  /* Files which have to be rotated before writing */
+  QSet<QString> rotateFiles;
+
+  QVector<ExportJob> jobs;
+
+  /* Time needed for preparation in the main thread and export result by format */
+  QMap<rexp::RouteExportFormatType, qint64> prepareTimeMs;
+  QMap<rexp::RouteExportFormatType, bool> exported;
+
+  /* Format currently prepared in main thread */
+  rexp::RouteExportFormatType currentType = rexp::NO_TYPE;
+  bool collecting = true;
+  QElapsedTimer timer;
+};
+
+/* Write all files of a job - called from thread pool */
+static void runExportJob(ExportJob& job)
+{
+  for(ExportStep& step : job.steps)
+  {
+    QElapsedTimer timer;
+    timer.start();
+    try
+    {
+      if(step.rotate)
+        RouteExport::rotateFile(job.filename);
+      step.writeFunc(job.filename);
+    }
+    catch(atools::Exception& e)
+    {
+      step.errorMessage = e.what();
+    }
+    catch(std::exception& e)
+    {
+      step.errorMessage = e.what();
+    }
+    catch(...)
+    {
+      step.errorMessage = QObject::tr("Unknown error while writing \"%1\".").arg(job.filename);
+    }
+    step.writeTimeMs = timer.elapsed();
+  }
+}
+
 RouteExport::RouteExport(MainWindow *parent)
   : mainWindow(parent)
 {
   exportFormatMap = new RouteExportFormatMap;
-  flightplanIO = new FlightplanIO;
   dialog = new atools::gui::Dialog(mainWindow);
   exportAllDialog = new RouteMultiExportDialog(mainWindow, exportFormatMap);
 
   // Save now button in list
   connect(exportAllDialog, &RouteMultiExportDialog::saveNowButtonClicked, this, &RouteExport::exportType);
+
+  // Report results once all background writes are done
+  connect(&multiExportWatcher, &QFutureWatcher<void>::finished, this, &RouteExport::multiExportFinished);
 }
 
 RouteExport::~RouteExport()
 {
+  // Let pending writes finish but do not report anything
+  multiExportWatcher.waitForFinished();
+  delete multiExportBatch;
+  multiExportBatch = nullptr;
+
   delete exportAllDialog;
   delete dialog;
-  delete flightplanIO;
   delete exportFormatMap;
 }
 
@@ -93,20 +167,176 @@ void RouteExport::exportType(RouteExportFormat format)
 
 void RouteExport::routeMultiExport()
 {
+  if(multiExportBatch != nullptr)
+  {
+    // Previous export is still writing files - finish this first to avoid concurrent writes to the same files
+    multiExportWatcher.waitForFinished();
+    multiExportFinished();
+  }
+
   // First check constraints
   if(routeValidate(true /* validate parking */, true /* validate departure and destination */, true /* multi */))
   {
+    QVector<RouteExportFormat> formats = exportFormatMap->getSelected();
+
+    multiExportBatch = new MultiExportBatch;
+    multiExportBatch->timer.start();
+
+    // Regions are required for the GNS export - update before flight plan variants are built
+    for(const RouteExportFormat& fmt : formats)
+    {
+      if(fmt.getType() == rexp::RXPGNS)
+        NavApp::getRoute().updateAirportRegions();
+    }
+
     // Export all button or menu item
-    int numExported = 0;
-    for(const RouteExportFormat& fmt : exportFormatMap->getSelected())
+    // Build file contents in main thread and queue file writes in multiExportBatch
+    for(const RouteExportFormat& fmt : formats)
     {
       if(fmt.isSelected() && fmt.isPathValid())
-        numExported += fmt.callExport();
+      {
+        QElapsedTimer timer;
+        timer.start();
+        multiExportBatch->currentType = fmt.getType();
+        multiExportBatch->exported.insert(fmt.getType(), fmt.callExport());
+        multiExportBatch->prepareTimeMs.insert(fmt.getType(), timer.elapsed());
+      }
     }
-    mainWindow->setStatusMessage(tr("Exported %1 flight plans.").arg(numExported));
+    multiExportBatch->currentType = rexp::NO_TYPE;
+    multiExportBatch->collecting = false;
+
+    qDebug() << Q_FUNC_INFO << "Prepared" << multiExportBatch->exported.size() << "formats with"
+             << multiExportBatch->routes.size() << "route variants in" << multiExportBatch->timer.elapsed() << "ms";
+
+    // Write all files in parallel - multiExportFinished() is called when done
+    multiExportWatcher.setFuture(QtConcurrent::map(multiExportBatch->jobs, runExportJob));
   }
 }
 
+void RouteExport::multiExportFinished()
+{
+  if(multiExportBatch == nullptr)
+    // Already reported by routeMultiExport()
+    return;
+
+  // Collect write time and errors by format
+  QMap<rexp::RouteExportFormatType, qint64> writeTimeMs;
+  QMap<rexp::RouteExportFormatType, QString> errors;
+  for(const ExportJob& job : multiExportBatch->jobs)
+  {
+    for(const ExportStep& step : job.steps)
+    {
+      writeTimeMs[step.type] += step.writeTimeMs;
+
+      if(!step.errorMessage.isEmpty())
+      {
+        errors.insert(step.type, step.errorMessage);
+        atools::Exception exception(step.errorMessage);
+        atools::gui::ErrorHandler(mainWindow).handleException(exception, step.errorHeader);
+      }
+    }
+  }
+
+  // Build per format result text for the multiexport dialog
+  int numExported = 0;
+  QMap<rexp::RouteExportFormatType, QString> results;
+  for(auto it = multiExportBatch->exported.constBegin(); it != multiExportBatch->exported.constEnd(); ++it)
+  {
+    rexp::RouteExportFormatType type = it.key();
+    qint64 prepareMs = multiExportBatch->prepareTimeMs.value(type), writeMs = writeTimeMs.value(type);
+
+    if(errors.contains(type))
+      results.insert(type, tr("Error: %1").arg(errors.value(type)));
+    else if(!it.value())
+      results.insert(type, tr("Not exported"));
+    else
+    {
+      numExported++;
+      results.insert(type, tr("%1 ms (prepare %2 ms, write %3 ms)").
+                     arg(prepareMs + writeMs).arg(prepareMs).arg(writeMs));
+    }
+
+    qDebug() << Q_FUNC_INFO << "Format" << type << "prepare" << prepareMs << "ms write" << writeMs << "ms"
+             << "exported" << it.value() << errors.value(type);
+  }
+  exportAllDialog->setExportResults(results);
+
+  qDebug() << Q_FUNC_INFO << "Multiexport done in" << multiExportBatch->timer.elapsed() << "ms";
+  mainWindow->setStatusMessage(tr("Exported %1 flight plans.").arg(numExported));
+
+  delete multiExportBatch;
+  multiExportBatch = nullptr;
+}
+
+bool RouteExport::isMultiExportCollecting() const
+{
+  return multiExportBatch != nullptr && multiExportBatch->collecting;
+}
+
+bool RouteExport::writeExportFile(const QString& filename, const QString& errorHeader,
+                                  std::function<void(const QString&)> writeFunc)
+{
+  if(isMultiExportCollecting())
+  {
+    // Queue for thread pool ========================================
+    ExportStep step;
+    step.type = multiExportBatch->currentType;
+    step.writeFunc = writeFunc;
+    step.rotate = multiExportBatch->rotateFiles.contains(filename);
+    step.errorHeader = errorHeader;
+
+    // Add to job writing the same file if any to avoid concurrent writes
+    for(ExportJob& job : multiExportBatch->jobs)
+    {
+      if(job.filename == filename)
+      {
+        job.steps.append(step);
+        return true;
+      }
+    }
+
+    ExportJob job;
+    job.filename = filename;
+    job.steps.append(step);
+    multiExportBatch->jobs.append(job);
+    return true;
+  }
+  else
+  {
+    // Write now for manual export ========================================
+    try
+    {
+      writeFunc(filename);
+    }
+    catch(atools::Exception& e)
+    {
+      atools::gui::ErrorHandler(mainWindow).handleException(e, errorHeader);
+      return false;
+    }
+    catch(...)
+    {
+      atools::gui::ErrorHandler(mainWindow).handleUnknownException(errorHeader);
+      return false;
+    }
+    return true;
+  }
+}
+
+void RouteExport::writeBytes(const QString& filename, const QByteArray& bytes)
+{
+  QFile file(filename);
+  if(file.open(QFile::WriteOnly | QIODevice::Text))
+  {
+    qint64 written = file.write(bytes);
+    file.close();
+
+    if(written != bytes.size())
+      throw atools::Exception(tr("Error writing file \"%1\": %2").arg(filename).arg(file.errorString()));
+  }
+  else
+    throw atools::Exception(tr("Cannot open file \"%1\" for writing: %2").arg(filename).arg(file.errorString()));
+}
+
 void RouteExport::routeMulitExportOptions()
 {
   int result = exportAllDialog->exec();
@@ -168,7 +398,13 @@ QString RouteExport::exportFile(const RouteExportFormat& format, const QString&
       case RouteMultiExportDialog::RENAME_EXISTING:
         // Rotate for new files - otherwise keep it since appending is desired
         if(!format.isExportToFile())
-          rotateFile(name);
+        {
+          if(isMultiExportCollecting())
+            // Rotate in background thread right before writing
+            multiExportBatch->rotateFiles.insert(name);
+          else
+            rotateFile(name);
+        }
         routeFile = name;
         break;
 
@@ -225,8 +461,8 @@ bool RouteExport::routeExportInternalPln(bool annotated, const RouteExportFormat
     {
       using namespace std::placeholders;
       auto func = annotated ?
-                  std::bind(&FlightplanIO::savePlnAnnotated, flightplanIO, _1, _2) :
-                  std::bind(&FlightplanIO::savePln, flightplanIO, _1, _2);
+                  std::bind(&FlightplanIO::savePlnAnnotated, _1, _2, _3) :
+                  std::bind(&FlightplanIO::savePln, _1, _2, _3);
 
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, func))
       {
@@ -248,7 +484,7 @@ bool RouteExport::routeExportFms3Multi(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS3, std::bind(&FlightplanIO::saveFms3, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS3, std::bind(&FlightplanIO::saveFms3, _1, _2, _3)))
         return true;
     }
   }
@@ -282,7 +518,7 @@ bool RouteExport::routeExportFms11(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS11, std::bind(&FlightplanIO::saveFms11, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS11, std::bind(&FlightplanIO::saveFms11, _1, _2, _3)))
       {
         mainWindow->setStatusMessage(tr("Flight plan saved as FMS."));
         return true;
@@ -314,8 +550,8 @@ bool RouteExport::routeExportInternalFlp(const RouteExportFormat& format, bool c
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS,
                          crj ?
-                         std::bind(&FlightplanIO::saveCrjFlp, flightplanIO, _1, _2) :
-                         std::bind(&FlightplanIO::saveFlp, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveCrjFlp, _1, _2, _3) :
+                         std::bind(&FlightplanIO::saveFlp, _1, _2, _3)))
         return true;
     }
   }
@@ -339,7 +575,7 @@ bool RouteExport::routeExportFlightgear(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFlightGear, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFlightGear, _1, _2, _3)))
         return true;
     }
   }
@@ -456,7 +692,7 @@ bool RouteExport::routeExportRteMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveRte, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveRte, _1, _2, _3)))
         return true;
     }
   }
@@ -475,7 +711,7 @@ bool RouteExport::routeExportFprMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFpr, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFpr, _1, _2, _3)))
         return true;
     }
   }
@@ -529,7 +765,7 @@ bool RouteExport::routeExportFltplanMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFltplan, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFltplan, _1, _2, _3)))
         return true;
     }
   }
@@ -602,7 +838,7 @@ bool RouteExport::routeExportBbsMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveBbsPln, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveBbsPln, _1, _2, _3)))
         return true;
     }
   }
@@ -623,7 +859,7 @@ bool RouteExport::routeExportFeelthereFplMulti(const RouteExportFormat& format)
 
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS,
-                         std::bind(&FlightplanIO::saveFeelthereFpl, flightplanIO, _1, _2, groundSpeed)))
+                         std::bind(&FlightplanIO::saveFeelthereFpl, _1, _2, _3, groundSpeed)))
         return true;
     }
   }
@@ -639,7 +875,7 @@ bool RouteExport::routeExportLeveldRteMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveLeveldRte, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveLeveldRte, _1, _2, _3)))
         return true;
     }
   }
@@ -658,7 +894,7 @@ bool RouteExport::routeExportEfbrMulti(const RouteExportFormat& format)
       QString cycle = NavApp::getDatabaseAiracCycleNav();
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS,
-                         std::bind(&FlightplanIO::saveEfbr, flightplanIO, _1, _2, route, cycle, QString(), QString())))
+                         std::bind(&FlightplanIO::saveEfbr, _1, _2, _3, route, cycle, QString(), QString())))
         return true;
     }
   }
@@ -674,7 +910,7 @@ bool RouteExport::routeExportQwRteMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveQwRte, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveQwRte, _1, _2, _3)))
         return true;
     }
   }
@@ -690,7 +926,7 @@ bool RouteExport::routeExportMdrMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveMdr, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveMdr, _1, _2, _3)))
         return true;
     }
   }
@@ -707,23 +943,13 @@ bool RouteExport::routeExportTfdiMulti(const RouteExportFormat& format)
     QString routeFile = exportFileMulti(format, buildDefaultFilenameShort(QString(), ".xml"));
     if(!routeFile.isEmpty())
     {
-      try
-      {
-        Route route = buildAdjustedRoute(rf::DEFAULT_OPTS);
-        flightplanIO->saveTfdi(route.getFlightplan(), routeFile, route.getJetAirwayFlags());
-      }
-      catch(atools::Exception& e)
-      {
-        atools::gui::ErrorHandler(mainWindow).handleException(e);
-        return false;
-      }
-      catch(...)
-      {
-        atools::gui::ErrorHandler(mainWindow).handleUnknownException();
-        return false;
-      }
+      Route route = buildAdjustedRoute(rf::DEFAULT_OPTS);
+      atools::fs::pln::Flightplan flightplan = route.getFlightplan();
+      QBitArray jetAirwayFlags = route.getJetAirwayFlags();
 
-      return true;
+      return writeExportFile(routeFile, QString(), [flightplan, jetAirwayFlags](const QString& filename) {
+        FlightplanIO().saveTfdi(flightplan, filename, jetAirwayFlags);
+      });
     }
   }
   return false;
@@ -745,10 +971,7 @@ bool RouteExport::routeExportVfp(const RouteExportFormat& format)
       QString routeFile = exportFileMulti(format, buildDefaultFilenameShort(QString(), ".vfp"));
 
       if(!routeFile.isEmpty())
-      {
-        if(exportFlighplanAsVfp(exportData, routeFile))
-          return true;
-      }
+        return exportFlighplanAsVfp(exportData, routeFile);
     }
   }
   return false;
@@ -786,10 +1009,7 @@ bool RouteExport::routeExportIvapInternal(re::RouteExportType type, const RouteE
       QString typeStr = RouteExportDialog::getRouteTypeAsDisplayString(type);
       QString routeFile = exportFileMulti(format, buildDefaultFilenameShort(QString(), ".fpl"));
       if(!routeFile.isEmpty())
-      {
-        if(exportFlighplanAsIvap(exportData, routeFile, type))
-          return true;
-      }
+        return exportFlighplanAsIvap(exportData, routeFile, type);
     }
   }
   return false;
@@ -894,6 +1114,7 @@ bool RouteExport::routeExportHtmlMan()
 bool RouteExport::routeExportHtml(const RouteExportFormat& format)
 {
   qDebug() << Q_FUNC_INFO;
+  using namespace std::placeholders;
 
   QString routeFile = exportFile(format, "Route/Html", atools::documentsDir(),
                                  buildDefaultFilename(".html"),
@@ -901,17 +1122,12 @@ bool RouteExport::routeExportHtml(const RouteExportFormat& format)
 
   if(!routeFile.isEmpty())
   {
-    QFile file(routeFile);
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+    QByteArray html = NavApp::getRouteController()->getFlightplanTableAsHtmlDoc(24 /* iconSizePixel */).toUtf8();
+    if(writeExportFile(routeFile, tr("While saving HTML file:"), std::bind(&RouteExport::writeBytes, _1, html)))
     {
-      QTextStream stream(&file);
-      stream.setCodec("UTF-8");
-      stream << NavApp::getRouteController()->getFlightplanTableAsHtmlDoc(24 /* iconSizePixel */);
       mainWindow->setStatusMessage(tr("Flight plan saved as HTML."));
       return true;
     }
-    else
-      atools::gui::ErrorHandler(mainWindow).handleIOError(file);
   }
   return false;
 }
@@ -1028,19 +1244,8 @@ bool RouteExport::exportFlighplanAsGfp(const QString& filename)
     buildAdjustedRoute(rf::DEFAULT_OPTS), false /* procedures */,
     OptionData::instance().getFlags() & opts::ROUTE_GARMIN_USER_WPT);
 
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = gfp.toUtf8();
-    file.write(utf8.data(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving GFP file:"));
-    return false;
-  }
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving GFP file:"), std::bind(&RouteExport::writeBytes, _1, gfp.toUtf8()));
 }
 
 bool RouteExport::exportFlighplanAsTxt(const QString& filename)
@@ -1049,19 +1254,9 @@ bool RouteExport::exportFlighplanAsTxt(const QString& filename)
   QString txt = RouteStringWriter().createStringForRoute(
     buildAdjustedRoute(rf::DEFAULT_OPTS), 0.f, rs::DCT | rs::START_AND_DEST | rs::SID_STAR_GENERIC);
 
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = txt.toUtf8();
-    file.write(utf8.data(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving TXT or FPL file:"));
-    return false;
-  }
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving TXT or FPL file:"),
+                         std::bind(&RouteExport::writeBytes, _1, txt.toUtf8()));
 }
 
 bool RouteExport::exportFlighplanAsUFmc(const QString& filename)
@@ -1083,56 +1278,38 @@ bool RouteExport::exportFlighplanAsUFmc(const QString& filename)
   // Q818
   // WOZEE
   // 99
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QTextStream stream(&file);
-    // Save start and destination
-    stream << list.first() << endl << list.last() << endl;
+  QByteArray bytes;
+  QTextStream stream(&bytes, QIODevice::WriteOnly);
+  // Save start and destination
+  stream << list.first() << endl << list.last() << endl;
 
-    // Waypoints and airways
-    for(int i = 1; i < list.size() - 1; i++)
-      stream << list.at(i) << endl;
+  // Waypoints and airways
+  for(int i = 1; i < list.size() - 1; i++)
+    stream << list.at(i) << endl;
 
-    // File end
-    stream << "99" << endl;
+  // File end
+  stream << "99" << endl;
+  stream.flush();
 
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving UFMC file:"));
-    return false;
-  }
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving UFMC file:"), std::bind(&RouteExport::writeBytes, _1, bytes));
 }
 
 bool RouteExport::exportFlighplanAsRxpGns(const QString& filename)
 {
   qDebug() << Q_FUNC_INFO << filename;
 
-  try
-  {
-    atools::fs::pln::SaveOptions options = atools::fs::pln::SAVE_NO_OPTIONS;
+  atools::fs::pln::SaveOptions options = atools::fs::pln::SAVE_NO_OPTIONS;
 
-    if(OptionData::instance().getFlags() & opts::ROUTE_GARMIN_USER_WPT)
-      options |= atools::fs::pln::SAVE_GNS_USER_WAYPOINTS;
+  if(OptionData::instance().getFlags() & opts::ROUTE_GARMIN_USER_WPT)
+    options |= atools::fs::pln::SAVE_GNS_USER_WAYPOINTS;
 
-    // Regions are required for the export
+  // Regions are required for the export - already updated before building routes in multiexport
+  if(!isMultiExportCollecting())
     NavApp::getRoute().updateAirportRegions();
-    FlightplanIO().saveGarminFpl(buildAdjustedRoute(rf::DEFAULT_OPTS).getFlightplan(), filename, options);
-  }
-  catch(atools::Exception& e)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleException(e);
-    return false;
-  }
-  catch(...)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleUnknownException();
-    return false;
-  }
-  return true;
+
+  using namespace std::placeholders;
+  return exportFlighplan(filename, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveGarminFpl, _1, _2, _3, options));
 }
 
 bool RouteExport::exportFlighplanAsRxpGtn(const QString& filename)
@@ -1142,245 +1319,225 @@ bool RouteExport::exportFlighplanAsRxpGtn(const QString& filename)
     buildAdjustedRoute(rf::DEFAULT_OPTS), true /* procedures */,
     OptionData::instance().getFlags() & opts::ROUTE_GARMIN_USER_WPT);
 
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = gfp.toUtf8();
-    file.write(utf8.data(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving GFP file:"));
-    return false;
-  }
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving GFP file:"), std::bind(&RouteExport::writeBytes, _1, gfp.toUtf8()));
 }
 
 bool RouteExport::exportFlighplanAsVfp(const RouteExportData& exportData, const QString& filename)
 {
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    // <?xml version="1.0" encoding="utf-8"?>
-    // <FlightPlan xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:xsd="http://www.w3.org/2001/XMLSchema"
-    // FlightType="IFR"
-    // Equipment="/L"
-    // CruiseAltitude="23000"
-    // CruiseSpeed="275"
-    // DepartureAirport="KBZN"
-    // DestinationAirport="KJAC"
-    // AlternateAirport="KSLC"
-    // Route="DCT 4529N11116W 4527N11114W 4524N11112W 4522N11110W DCT 4520N11110W 4519N11111W/N0276F220 4517N11113W 4516N11115W 4514N11115W/N0275F230 4509N11114W 4505N11113W 4504N11111W 4502N11107W 4500N11105W 4458N11104W 4452N11103W 4450N11105W/N0276F220 4449N11108W 4449N11111W 4449N11113W 4450N11116W 4451N11119W 4450N11119W/N0275F230 4448N11117W 4446N11116W DCT KWYS DCT 4440N11104W 4440N11059W 4439N11055W 4439N11052W 4435N11050W 4430N11050W 4428N11050W 4426N11044W 4427N11041W 4425N11035W 4429N11032W 4428N11031W 4429N11027W 4429N11025W 4432N11024W 4432N11022W 4432N11018W 4428N11017W 4424N11017W 4415N11027W/N0276F220 DCT 4409N11040W 4403N11043W DCT 4352N11039W DCT"
-    // Remarks="PBN/D2 DOF/181102 REG/N012SB PER/B RMK/TCAS SIMBRIEF"
-    // IsHeavy="false"
-    // EquipmentPrefix=""
-    // EquipmentSuffix="L"
-    // DepartureTime="2035"
-    // DepartureTimeAct="0"
-    // EnrouteHours="0"
-    // EnrouteMinutes="53"
-    // FuelHours="2"
-    // FuelMinutes="44"
-    // VoiceType="Full" />
-    QXmlStreamWriter writer(&file);
-    writer.setCodec("UTF-8");
-    writer.setAutoFormatting(true);
-    writer.setAutoFormattingIndent(2);
-
-    writer.writeStartDocument("1.0");
-    writer.writeStartElement("FlightPlan");
-
-    writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
-    writer.writeAttribute("xmlns:xsd", "http://www.w3.org/2001/XMLSchema");
-
-    writer.writeAttribute("FlightType", exportData.getFlightRules());
-    writer.writeAttribute("Equipment", exportData.getEquipment());
-    writer.writeAttribute("CruiseAltitude", QString::number(exportData.getCruiseAltitude()));
-    writer.writeAttribute("CruiseSpeed", QString::number(exportData.getSpeed()));
-    writer.writeAttribute("DepartureAirport", exportData.getDeparture());
-    writer.writeAttribute("DestinationAirport", exportData.getDestination());
-    writer.writeAttribute("AlternateAirport", exportData.getAlternate());
-    writer.writeAttribute("Route", exportData.getRoute());
-    writer.writeAttribute("Remarks", exportData.getRemarks());
-    writer.writeAttribute("IsHeavy", exportData.isHeavy() ? "true" : "false");
-    writer.writeAttribute("EquipmentPrefix", exportData.getEquipmentPrefix());
-    writer.writeAttribute("EquipmentSuffix", exportData.getEquipmentSuffix());
-
-    writer.writeAttribute("DepartureTime", exportData.getDepartureTime().toString("HHmm"));
-    writer.writeAttribute("DepartureTimeAct", exportData.getDepartureTimeActual().isNull() ?
-                          "0" : exportData.getDepartureTimeActual().toString("HHmm"));
-    int enrouteHours = exportData.getEnrouteMinutes() / 60;
-    writer.writeAttribute("EnrouteHours", QString::number(enrouteHours));
-    writer.writeAttribute("EnrouteMinutes", QString::number(exportData.getEnrouteMinutes() - enrouteHours * 60));
-    int enduranceHours = exportData.getEnduranceMinutes() / 60;
-    writer.writeAttribute("FuelHours", QString::number(enduranceHours));
-    writer.writeAttribute("FuelMinutes", QString::number(exportData.getEnduranceMinutes() - enduranceHours * 60));
-    writer.writeAttribute("VoiceType", exportData.getVoiceType());
-
-    writer.writeEndElement(); // FlightPlan
-    writer.writeEndDocument();
-
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving VFP file:"));
-    return false;
-  }
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving VFP file:"),
+                         std::bind(&RouteExport::writeBytes, _1, flighplanAsVfp(exportData)));
+}
+
+QByteArray RouteExport::flighplanAsVfp(const RouteExportData& exportData)
+{
+  QByteArray bytes;
+  // <?xml version="1.0" encoding="utf-8"?>
+  // <FlightPlan xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xmlns:xsd="http://www.w3.org/2001/XMLSchema"
+  // FlightType="IFR"
+  // Equipment="/L"
+  // CruiseAltitude="23000"
+  // CruiseSpeed="275"
+  // DepartureAirport="KBZN"
+  // DestinationAirport="KJAC"
+  // AlternateAirport="KSLC"
+  // Route="DCT 4529N11116W 4527N11114W 4524N11112W 4522N11110W DCT 4520N11110W 4519N11111W/N0276F220 4517N11113W 4516N11115W 4514N11115W/N0275F230 4509N11114W 4505N11113W 4504N11111W 4502N11107W 4500N11105W 4458N11104W 4452N11103W 4450N11105W/N0276F220 4449N11108W 4449N11111W 4449N11113W 4450N11116W 4451N11119W 4450N11119W/N0275F230 4448N11117W 4446N11116W DCT KWYS DCT 4440N11104W 4440N11059W 4439N11055W 4439N11052W 4435N11050W 4430N11050W 4428N11050W 4426N11044W 4427N11041W 4425N11035W 4429N11032W 4428N11031W 4429N11027W 4429N11025W 4432N11024W 4432N11022W 4432N11018W 4428N11017W 4424N11017W 4415N11027W/N0276F220 DCT 4409N11040W 4403N11043W DCT 4352N11039W DCT"
+  // Remarks="PBN/D2 DOF/181102 REG/N012SB PER/B RMK/TCAS SIMBRIEF"
+  // IsHeavy="false"
+  // EquipmentPrefix=""
+  // EquipmentSuffix="L"
+  // DepartureTime="2035"
+  // DepartureTimeAct="0"
+  // EnrouteHours="0"
+  // EnrouteMinutes="53"
+  // FuelHours="2"
+  // FuelMinutes="44"
+  // VoiceType="Full" />
+  QXmlStreamWriter writer(&bytes);
+  writer.setCodec("UTF-8");
+  writer.setAutoFormatting(true);
+  writer.setAutoFormattingIndent(2);
+
+  writer.writeStartDocument("1.0");
+  writer.writeStartElement("FlightPlan");
+
+  writer.writeAttribute("xmlns:xsi", "http://www.w3.org/2001/XMLSchema-instance");
+  writer.writeAttribute("xmlns:xsd", "http://www.w3.org/2001/XMLSchema");
+
+  writer.writeAttribute("FlightType", exportData.getFlightRules());
+  writer.writeAttribute("Equipment", exportData.getEquipment());
+  writer.writeAttribute("CruiseAltitude", QString::number(exportData.getCruiseAltitude()));
+  writer.writeAttribute("CruiseSpeed", QString::number(exportData.getSpeed()));
+  writer.writeAttribute("DepartureAirport", exportData.getDeparture());
+  writer.writeAttribute("DestinationAirport", exportData.getDestination());
+  writer.writeAttribute("AlternateAirport", exportData.getAlternate());
+  writer.writeAttribute("Route", exportData.getRoute());
+  writer.writeAttribute("Remarks", exportData.getRemarks());
+  writer.writeAttribute("IsHeavy", exportData.isHeavy() ? "true" : "false");
+  writer.writeAttribute("EquipmentPrefix", exportData.getEquipmentPrefix());
+  writer.writeAttribute("EquipmentSuffix", exportData.getEquipmentSuffix());
+
+  writer.writeAttribute("DepartureTime", exportData.getDepartureTime().toString("HHmm"));
+  writer.writeAttribute("DepartureTimeAct", exportData.getDepartureTimeActual().isNull() ?
+                        "0" : exportData.getDepartureTimeActual().toString("HHmm"));
+  int enrouteHours = exportData.getEnrouteMinutes() / 60;
+  writer.writeAttribute("EnrouteHours", QString::number(enrouteHours));
+  writer.writeAttribute("EnrouteMinutes", QString::number(exportData.getEnrouteMinutes() - enrouteHours * 60));
+  int enduranceHours = exportData.getEnduranceMinutes() / 60;
+  writer.writeAttribute("FuelHours", QString::number(enduranceHours));
+  writer.writeAttribute("FuelMinutes", QString::number(exportData.getEnduranceMinutes() - enduranceHours * 60));
+  writer.writeAttribute("VoiceType", exportData.getVoiceType());
+
+  writer.writeEndElement(); // FlightPlan
+  writer.writeEndDocument();
+
+  return bytes;
 }
 
 bool RouteExport::exportFlighplanAsIvap(const RouteExportData& exportData, const QString& filename,
                                         re::RouteExportType type)
 {
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
+  using namespace std::placeholders;
+  return writeExportFile(filename, tr("While saving FPL file:"),
+                         std::bind(&RouteExport::writeBytes, _1, flighplanAsIvap(exportData, type)));
+}
+
+QByteArray RouteExport::flighplanAsIvap(const RouteExportData& exportData, re::RouteExportType type)
+{
+  QByteArray bytes;
+  // IvAp ===================================================
+  // [FLIGHTPLAN]
+  // ID=LU965
+  // RULES=I
+  // FLIGHTTYPE=S
+  // NUMBER=1
+  // ACTYPE=A306
+  // WAKECAT=H
+  // EQUIPMENT=SDE3FGHIRWY
+  // TRANSPONDER=LB1
+  // DEPICAO=KMFR
+  // DEPTIME=1400
+  // SPEEDTYPE=N
+  // SPEED=0477
+  // LEVELTYPE=F
+  // LEVEL=310
+  // ROUTE=BRUTE7 BRUTE V122 ACLOB DCT LEIFF DCT OLEBY DCT LMT DCT BIDDS DCT 4218N12112W DCT LKV V122 REO V113 BOI V4 LAR V118 CYS V138 SNY V6 IOW V8 BENKY BENKY5
+  // DESTICAO=KORD
+  // EET=0336
+  // ALTICAO=KDTW
+  // ALTICAO2=
+  // OTHER=PBN/A1B1C1D1L1O1S1 DOF/200723 REG/N306SB EET/KZLC0026 KZDV0133 KZMP0222 KZAU0252 OPR/LU PER/C RMK/TCAS
+  // ENDURANCE=0517
+  // POB=275
+
+  // X-IvAp ===================================================
+  // [FLIGHTPLAN]
+  // CALLSIGN=N9999
+  // PIC=Pilot
+  // FMCROUTE=
+  // LIVERY=
+  // AIRLINE=
+  // SPEEDTYPE=N
+  // POB=150
+  // ENDURANCE=0531
+  // OTHER=PBN/A1B1C1D1O1S1 DOF/200721 REG/N319SB OPR/LU PER/C RMK/TCAS
+  // ALT2ICAO=
+  // ALTICAO=KDTW
+  // EET=0346
+  // DESTICAO=KORD
+  // ROUTE=BRUTE7 BRUTE V122 ACLOB DCT LEIFF DCT OLEBY DCT LMT DCT BIDDS DCT 4218N12112W DCT LKV V122 REO V113 BOI V4 LAR V118 CYS V138 SNY V6 IOW V8 BENKY BENKY5
+  // LEVEL=350
+  // LEVELTYPE=F
+  // SPEED=0460
+  // DEPTIME=1400
+  // DEPICAO=KMFR
+  // TRANSPONDER=LB1
+  // EQUIPMENT=SDE3FGHIRWY
+  // WAKECAT=M
+  // ACTYPE=A319
+  // NUMBER=1
+  // FLIGHTTYPE=S
+  // RULES=I
+
+  QTextStream stream(&bytes, QIODevice::WriteOnly);
+  writeIvapLine(stream, "[FLIGHTPLAN]", type);
+
+  // X-IvAp and IvAp idiotically use a slightly different format
+  if(type == re::XIVAP)
   {
-    // IvAp ===================================================
-    // [FLIGHTPLAN]
-    // ID=LU965
-    // RULES=I
-    // FLIGHTTYPE=S
-    // NUMBER=1
-    // ACTYPE=A306
-    // WAKECAT=H
-    // EQUIPMENT=SDE3FGHIRWY
-    // TRANSPONDER=LB1
-    // DEPICAO=KMFR
-    // DEPTIME=1400
-    // SPEEDTYPE=N
-    // SPEED=0477
-    // LEVELTYPE=F
-    // LEVEL=310
-    // ROUTE=BRUTE7 BRUTE V122 ACLOB DCT LEIFF DCT OLEBY DCT LMT DCT BIDDS DCT 4218N12112W DCT LKV V122 REO V113 BOI V4 LAR V118 CYS V138 SNY V6 IOW V8 BENKY BENKY5
-    // DESTICAO=KORD
-    // EET=0336
-    // ALTICAO=KDTW
-    // ALTICAO2=
-    // OTHER=PBN/A1B1C1D1L1O1S1 DOF/200723 REG/N306SB EET/KZLC0026 KZDV0133 KZMP0222 KZAU0252 OPR/LU PER/C RMK/TCAS
-    // ENDURANCE=0517
-    // POB=275
-
-    // X-IvAp ===================================================
-    // [FLIGHTPLAN]
-    // CALLSIGN=N9999
-    // PIC=Pilot
-    // FMCROUTE=
-    // LIVERY=
-    // AIRLINE=
-    // SPEEDTYPE=N
-    // POB=150
-    // ENDURANCE=0531
-    // OTHER=PBN/A1B1C1D1O1S1 DOF/200721 REG/N319SB OPR/LU PER/C RMK/TCAS
-    // ALT2ICAO=
-    // ALTICAO=KDTW
-    // EET=0346
-    // DESTICAO=KORD
-    // ROUTE=BRUTE7 BRUTE V122 ACLOB DCT LEIFF DCT OLEBY DCT LMT DCT BIDDS DCT 4218N12112W DCT LKV V122 REO V113 BOI V4 LAR V118 CYS V138 SNY V6 IOW V8 BENKY BENKY5
-    // LEVEL=350
-    // LEVELTYPE=F
-    // SPEED=0460
-    // DEPTIME=1400
-    // DEPICAO=KMFR
-    // TRANSPONDER=LB1
-    // EQUIPMENT=SDE3FGHIRWY
-    // WAKECAT=M
-    // ACTYPE=A319
-    // NUMBER=1
-    // FLIGHTTYPE=S
-    // RULES=I
-
-    QTextStream stream(&file);
-    writeIvapLine(stream, "[FLIGHTPLAN]", type);
-
-    // X-IvAp and IvAp idiotically use a slightly different format
-    if(type == re::XIVAP)
-    {
-      writeIvapLine(stream, "CALLSIGN", exportData.getCallsign(), type);
-      writeIvapLine(stream, "PIC", exportData.getPilotInCommand(), type);
-      writeIvapLine(stream, "FMCROUTE", QString(), type);
-      writeIvapLine(stream, "LIVERY", exportData.getLivery(), type);
-      writeIvapLine(stream, "AIRLINE", exportData.getAirline(), type);
-      writeIvapLine(stream, "SPEEDTYPE", "N", type);
-      writeIvapLine(stream, "POB", exportData.getPassengers(), type);
-      writeIvapLine(stream, "ENDURANCE", minToHourMinStr(exportData.getEnduranceMinutes()), type);
-      writeIvapLine(stream, "OTHER", exportData.getRemarks(), type);
-      writeIvapLine(stream, "ALT2ICAO", exportData.getAlternate2(), type);
-      writeIvapLine(stream, "ALTICAO", exportData.getAlternate(), type);
-      writeIvapLine(stream, "EET", minToHourMinStr(exportData.getEnrouteMinutes()), type);
-      writeIvapLine(stream, "DESTICAO", exportData.getDestination(), type);
-      writeIvapLine(stream, "ROUTE", exportData.getRoute(), type);
-      writeIvapLine(stream, "LEVEL", exportData.getCruiseAltitude() / 100, type);
-      writeIvapLine(stream, "LEVELTYPE", "F", type);
-      writeIvapLine(stream, "SPEED", exportData.getSpeed(), type);
-      writeIvapLine(stream, "DEPTIME", exportData.getDepartureTime().toString("HHmm"), type);
-      writeIvapLine(stream, "DEPICAO", exportData.getDeparture(), type);
-      writeIvapLine(stream, "TRANSPONDER", exportData.getTransponder(), type);
-      writeIvapLine(stream, "EQUIPMENT", exportData.getEquipment(), type);
-      writeIvapLine(stream, "WAKECAT", exportData.getWakeCategory(), type);
-      writeIvapLine(stream, "ACTYPE", exportData.getAircraftType(), type);
-      writeIvapLine(stream, "NUMBER", "1", type);
-      writeIvapLine(stream, "FLIGHTTYPE", exportData.getFlightType(), type);
-      writeIvapLine(stream, "RULES", exportData.getFlightRules(), type);
-    }
-    else
-    {
-      writeIvapLine(stream, "ID", exportData.getCallsign(), type);
-      writeIvapLine(stream, "RULES", exportData.getFlightRules(), type);
-      writeIvapLine(stream, "FLIGHTTYPE", exportData.getFlightType(), type);
-      writeIvapLine(stream, "NUMBER", "1", type);
-      writeIvapLine(stream, "ACTYPE", exportData.getAircraftType(), type);
-      writeIvapLine(stream, "WAKECAT", exportData.getWakeCategory(), type);
-      writeIvapLine(stream, "EQUIPMENT", exportData.getEquipment(), type);
-      writeIvapLine(stream, "TRANSPONDER", exportData.getTransponder(), type);
-      writeIvapLine(stream, "DEPICAO", exportData.getDeparture(), type);
-      writeIvapLine(stream, "DEPTIME", exportData.getDepartureTime().toString("HHmm"), type);
-      writeIvapLine(stream, "SPEEDTYPE", "N", type);
-      writeIvapLine(stream, "SPEED", exportData.getSpeed(), type);
-      writeIvapLine(stream, "LEVELTYPE", "F", type);
-      writeIvapLine(stream, "LEVEL", exportData.getCruiseAltitude() / 100, type);
-      writeIvapLine(stream, "ROUTE", exportData.getRoute(), type);
-      writeIvapLine(stream, "DESTICAO", exportData.getDestination(), type);
-      writeIvapLine(stream, "EET", minToHourMinStr(exportData.getEnrouteMinutes()), type);
-      writeIvapLine(stream, "ALTICAO", exportData.getAlternate(), type);
-      writeIvapLine(stream, "ALTICAO2", exportData.getAlternate2(), type);
-      writeIvapLine(stream, "OTHER", exportData.getRemarks(), type);
-      writeIvapLine(stream, "ENDURANCE", minToHourMinStr(exportData.getEnduranceMinutes()), type);
-      writeIvapLine(stream, "POB", exportData.getPassengers(), type);
-    }
-
-    file.close();
-    return true;
+    writeIvapLine(stream, "CALLSIGN", exportData.getCallsign(), type);
+    writeIvapLine(stream, "PIC", exportData.getPilotInCommand(), type);
+    writeIvapLine(stream, "FMCROUTE", QString(), type);
+    writeIvapLine(stream, "LIVERY", exportData.getLivery(), type);
+    writeIvapLine(stream, "AIRLINE", exportData.getAirline(), type);
+    writeIvapLine(stream, "SPEEDTYPE", "N", type);
+    writeIvapLine(stream, "POB", exportData.getPassengers(), type);
+    writeIvapLine(stream, "ENDURANCE", minToHourMinStr(exportData.getEnduranceMinutes()), type);
+    writeIvapLine(stream, "OTHER", exportData.getRemarks(), type);
+    writeIvapLine(stream, "ALT2ICAO", exportData.getAlternate2(), type);
+    writeIvapLine(stream, "ALTICAO", exportData.getAlternate(), type);
+    writeIvapLine(stream, "EET", minToHourMinStr(exportData.getEnrouteMinutes()), type);
+    writeIvapLine(stream, "DESTICAO", exportData.getDestination(), type);
+    writeIvapLine(stream, "ROUTE", exportData.getRoute(), type);
+    writeIvapLine(stream, "LEVEL", exportData.getCruiseAltitude() / 100, type);
+    writeIvapLine(stream, "LEVELTYPE", "F", type);
+    writeIvapLine(stream, "SPEED", exportData.getSpeed(), type);
+    writeIvapLine(stream, "DEPTIME", exportData.getDepartureTime().toString("HHmm"), type);
+    writeIvapLine(stream, "DEPICAO", exportData.getDeparture(), type);
+    writeIvapLine(stream, "TRANSPONDER", exportData.getTransponder(), type);
+    writeIvapLine(stream, "EQUIPMENT", exportData.getEquipment(), type);
+    writeIvapLine(stream, "WAKECAT", exportData.getWakeCategory(), type);
+    writeIvapLine(stream, "ACTYPE", exportData.getAircraftType(), type);
+    writeIvapLine(stream, "NUMBER", "1", type);
+    writeIvapLine(stream, "FLIGHTTYPE", exportData.getFlightType(), type);
+    writeIvapLine(stream, "RULES", exportData.getFlightRules(), type);
   }
   else
   {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving FPL file:"));
-    return false;
-  }
+    writeIvapLine(stream, "ID", exportData.getCallsign(), type);
+    writeIvapLine(stream, "RULES", exportData.getFlightRules(), type);
+    writeIvapLine(stream, "FLIGHTTYPE", exportData.getFlightType(), type);
+    writeIvapLine(stream, "NUMBER", "1", type);
+    writeIvapLine(stream, "ACTYPE", exportData.getAircraftType(), type);
+    writeIvapLine(stream, "WAKECAT", exportData.getWakeCategory(), type);
+    writeIvapLine(stream, "EQUIPMENT", exportData.getEquipment(), type);
+    writeIvapLine(stream, "TRANSPONDER", exportData.getTransponder(), type);
+    writeIvapLine(stream, "DEPICAO", exportData.getDeparture(), type);
+    writeIvapLine(stream, "DEPTIME", exportData.getDepartureTime().toString("HHmm"), type);
+    writeIvapLine(stream, "SPEEDTYPE", "N", type);
+    writeIvapLine(stream, "SPEED", exportData.getSpeed(), type);
+    writeIvapLine(stream, "LEVELTYPE", "F", type);
+    writeIvapLine(stream, "LEVEL", exportData.getCruiseAltitude() / 100, type);
+    writeIvapLine(stream, "ROUTE", exportData.getRoute(), type);
+    writeIvapLine(stream, "DESTICAO", exportData.getDestination(), type);
+    writeIvapLine(stream, "EET", minToHourMinStr(exportData.getEnrouteMinutes()), type);
+    writeIvapLine(stream, "ALTICAO", exportData.getAlternate(), type);
+    writeIvapLine(stream, "ALTICAO2", exportData.getAlternate2(), type);
+    writeIvapLine(stream, "OTHER", exportData.getRemarks(), type);
+    writeIvapLine(stream, "ENDURANCE", minToHourMinStr(exportData.getEnduranceMinutes()), type);
+    writeIvapLine(stream, "POB", exportData.getPassengers(), type);
+  }
+
+  stream.flush();
+  return bytes;
 }
 
 bool RouteExport::exportFlighplan(const QString& filename, rf::RouteAdjustOptions options,
-                                  std::function<void(const atools::fs::pln::Flightplan& plan,
+                                  std::function<void(FlightplanIO& flightplanIO,
+                                                     const atools::fs::pln::Flightplan& plan,
                                                      const QString& file)> exportFunc)
 {
   qDebug() << Q_FUNC_INFO << filename;
 
-  try
-  {
-    exportFunc(buildAdjustedRoute(options).getFlightplan(), filename);
-  }
-  catch(atools::Exception& e)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleException(e);
-    return false;
-  }
-  catch(...)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleUnknownException();
-    return false;
-  }
-  return true;
+  // Pass a copy to the writer which might run in a background thread
+  atools::fs::pln::Flightplan flightplan = buildAdjustedRoute(options).getFlightplan();
+
+  return writeExportFile(filename, QString(), [flightplan, exportFunc](const QString& file) {
+    // Use own instance for each call since FlightplanIO is not thread safe
+    FlightplanIO flightplanIO;
+    exportFunc(flightplanIO, flightplan, file);
+  });
 }
 
 bool RouteExport::exportFlighplanAsCorteIn(const QString& filename)
@@ -1551,30 +1708,28 @@ bool RouteExport::exportFlightplanAsGpx(const QString& filename)
 {
   qDebug() << Q_FUNC_INFO << filename;
 
-  try
-  {
-    atools::geo::LineString track;
-    QVector<quint32> timestamps;
-    NavApp::getAircraftTrack().convert(&track, &timestamps);
-    FlightplanIO().saveGpx(buildAdjustedRoute(rf::DEFAULT_OPTS_GPX).getFlightplan(), filename, track, timestamps,
-                           static_cast<int>(NavApp::getRouteConst().getCruisingAltitudeFeet()));
-  }
-  catch(atools::Exception& e)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleException(e);
-    return false;
-  }
-  catch(...)
-  {
-    atools::gui::ErrorHandler(mainWindow).handleUnknownException();
-    return false;
-  }
-  return true;
+  atools::geo::LineString track;
+  QVector<quint32> timestamps;
+  NavApp::getAircraftTrack().convert(&track, &timestamps);
+  int cruiseAltFt = static_cast<int>(NavApp::getRouteConst().getCruisingAltitudeFeet());
+
+  using namespace std::placeholders;
+  return exportFlighplan(filename, rf::DEFAULT_OPTS_GPX,
+                         std::bind(&FlightplanIO::saveGpx, _1, _2, _3, track, timestamps, cruiseAltFt));
 }
 
 Route RouteExport::buildAdjustedRoute(rf::RouteAdjustOptions options)
 {
-  return buildAdjustedRoute(NavApp::getRoute(), options);
+  if(isMultiExportCollecting())
+  {
+    // Build each variant only once for all formats in a multiexport
+    int key = static_cast<int>(options);
+    if(!multiExportBatch->routes.contains(key))
+      multiExportBatch->routes.insert(key, buildAdjustedRoute(NavApp::getRoute(), options));
+    return multiExportBatch->routes.value(key);
+  }
+  else
+    return buildAdjustedRoute(NavApp::getRoute(), options);
 }
 
 Route RouteExport::buildAdjustedRoute(const Route& route, rf::RouteAdjustOptions options)
@@ -21,6 +21,7 @@
 #include "route/routeflags.h"
 #include "routeexport/routeexportflags.h"
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <functional>
 
@@ -69,7 +70,8 @@ public:
   /* Update simulator dependent default paths. */
   void postDatabaseLoad();
 
-  /* Run export to all selected formats. */
+  /* Run export to all selected formats. Flight plan variants are built once and files are written in
+   * background threads. Status message and errors are shown once all files are written. */
   void routeMultiExport();
 
   /* Open multiexport dialog */
@@ -210,6 +212,9 @@ public:
     return selected;
   }
 
+  /* Create a list of backups. Thread safe. */
+  static void rotateFile(const QString& filename);
+
 signals:
   /* Show airport on map to allow parking selection */
   void showRect(const atools::geo::Rect& rect, bool doubleClick);
@@ -236,7 +241,23 @@ private:
 
   /* Generic export using callback and also doing exception handling. */
   bool exportFlighplan(const QString& filename, rf::RouteAdjustOptions options,
-                       std::function<void(const atools::fs::pln::Flightplan&, const QString&)> exportFunc);
+                       std::function<void(atools::fs::pln::FlightplanIO&, const atools::fs::pln::Flightplan&,
+                                          const QString&)> exportFunc);
+
+  /* Calls writeFunc with the filename. Queues the call for the thread pool if a multiexport is running.
+   * writeFunc has to throw an exception on error and must not access any global state. Always returns true
+   * in multiexport since errors are reported later. */
+  bool writeExportFile(const QString& filename, const QString& errorHeader,
+                       std::function<void(const QString& filename)> writeFunc);
+
+  /* Write text or binary data to file. Throws exception on error. */
+  static void writeBytes(const QString& filename, const QByteArray& bytes);
+
+  /* Called when all files of a multiexport are written. Reports errors and timing. */
+  void multiExportFinished();
+
+  /* true while routeMultiExport() calls the export functions */
+  bool isMultiExportCollecting() const;
 
   /* Shows dialog for IVAP data before exporting */
   bool routeExportIvapInternal(re::RouteExportType type, const RouteExportFormat& format);
@@ -252,9 +273,11 @@ private:
 
   /* Export vRoute */
   bool exportFlighplanAsVfp(const RouteExportData& exportData, const QString& filename);
+  QByteArray flighplanAsVfp(const RouteExportData& exportData);
 
   /* Export IVAP or X-IVAP */
   bool exportFlighplanAsIvap(const RouteExportData& exportData, const QString& filename, re::RouteExportType type);
+  QByteArray flighplanAsIvap(const RouteExportData& exportData, re::RouteExportType type);
   QString minToHourMinStr(int minutes);
 
   void writeIvapLine(QTextStream& stream, const QString& key, const QString& value, re::RouteExportType type);
@@ -272,14 +295,18 @@ private:
   QString exportFile(const RouteExportFormat& format, const QString& settingsPrefix, const QString& path,
                      const QString& filename, bool dontComfirmOverwrite = false);
 
-  /* Create a list of backups */
-  void rotateFile(const QString& filename);
 
   MainWindow *mainWindow;
   atools::gui::Dialog *dialog;
   RouteMultiExportDialog *exportAllDialog;
   RouteExportFormatMap *exportFormatMap;
-  atools::fs::pln::FlightplanIO *flightplanIO;
+
+  /* Adjusted routes, file jobs and timing of the currently running multiexport. null if none is running. */
+  struct MultiExportBatch;
+  MultiExportBatch *multiExportBatch = nullptr;
+
+  /* Signals when all files of multiExportBatch are written */
+  QFutureWatcher<void> multiExportWatcher;
 
   /* true if any formats are selected for multiexport */
   bool selected = false;
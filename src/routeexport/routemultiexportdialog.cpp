@@ -55,7 +55,8 @@ enum Columns
   DESCRIPTION,
   EXTENSION,
   PATH,
-  LAST_COL = PATH
+  LAST_EXPORT, /* Appended to keep saved header state of older versions valid */
+  LAST_COL = LAST_EXPORT
 };
 
 // TableSortProxyModel  ==================================================================================================
@@ -304,6 +305,7 @@ void RouteMultiExportDialog::updateModel()
   itemModel->setHeaderData(EXTENSION, Qt::Horizontal, tr("Extension\nor Filename"));
   itemModel->setHeaderData(PATH, Qt::Horizontal,
                            tr("Default Export Path - can depend on currently selected Simulator"));
+  itemModel->setHeaderData(LAST_EXPORT, Qt::Horizontal, tr("Last Export"));
 
   QList<RouteExportFormat> values = formatMap->values();
 
@@ -401,6 +403,13 @@ void RouteMultiExportDialog::updateModel()
     item->setToolTip(tr("Double click to edit"));
     itemModel->setItem(row, PATH, item);
 
+    // Time needed or error from last multiexport =============================================================
+    item = new QStandardItem(exportResults.value(format.getType()));
+    item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
+    item->setData(userdata, FORMAT_TYPE_ROLE);
+    item->setToolTip(tr("Time needed to prepare and write the file or error message of the last export"));
+    itemModel->setItem(row, LAST_EXPORT, item);
+
     row++;
   }
 
@@ -655,7 +664,7 @@ void RouteMultiExportDialog::tableContextMenu(const QPoint& pos)
     // Reset column widths
     ui->tableViewRouteExport->resizeColumnsToContents();
 
-    // Workaround for Qt but which results in huge colum width for the last one
+    // Workaround for Qt but which results in huge colum width for the long path
     ui->tableViewRouteExport->setColumnWidth(PATH, 100);
 
     // Reset sorting back to category
@@ -21,6 +21,7 @@
 #include "routeexport/routeexportflags.h"
 
 #include <QDialog>
+#include <QMap>
 #include <functional>
 
 namespace Ui {
@@ -68,6 +69,13 @@ public:
   /* Get combo box selection */
   ExportOptions getExportOptions()const;
 
+  /* Set result like time needed or error message for each format of the last multiexport.
+   * Shown in the table the next time the dialog is opened. */
+  void setExportResults(const QMap<rexp::RouteExportFormatType, QString>& results)
+  {
+    exportResults = results;
+  }
+
 signals:
   /* Save now button list is clicked */
   void saveNowButtonClicked(const RouteExportFormat& format);
@@ -129,6 +137,9 @@ private:
   /* Combox box status */
   ExportOptions exportOptions = FILEDIALOG;
 
+  /* Result text for each format of the last multiexport */
+  QMap<rexp::RouteExportFormatType, QString> exportResults;
+
   Ui::RouteMultiExportDialog *ui;
 
 };
@@ -277,6 +277,8 @@ void SearchBaseTable::optionsChanged()
 
 void SearchBaseTable::styleChanged()
 {
+  // Background colors are cached by the model
+  controller->getSqlModel()->clearFormattedDataCache();
   view->update();
 }
 
@@ -40,6 +40,8 @@ using atools::sql::SqlRecord;
 SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, const ColumnList *columnList)
   : QSqlQueryModel(parent), db(sqlDb), columns(columnList), parentWidget(parent)
 {
+  formattedDataCache.setMaxCost(FORMATTED_DATA_CACHE_SIZE);
+
   // Set default handler
   setDataCallback(nullptr, QSet<Qt::ItemDataRole>());
 
@@ -284,6 +286,8 @@ void SqlModel::setSort(const QString& colname, Qt::SortOrder order)
 
 void SqlModel::setDataCallback(const DataFunctionType& func, const QSet<Qt::ItemDataRole>& roles)
 {
+  clearFormattedDataCache();
+
   if(func == nullptr)
   {
     // Set all back to default
@@ -350,7 +354,10 @@ const Column *SqlModel::getColumnModel(const QString& colName) const
 
 const Column *SqlModel::getColumnModel(int colIndex) const
 {
-  return columns->getColumn(getSqlRecord().fieldName(colIndex));
+  if(colIndex >= 0 && colIndex < columnDescriptors.size())
+    return columnDescriptors.at(colIndex);
+  else
+    return columns->getColumn(getSqlRecord().fieldName(colIndex));
 }
 
 QString SqlModel::sortOrderToSql(Qt::SortOrder order)
@@ -418,6 +425,9 @@ QString SqlModel::buildColumnList(const atools::sql::SqlRecord& tableCols)
 /* Create SQL query and set it into the model */
 void SqlModel::buildQuery()
 {
+  // Sort column might have changed which is used for background colors
+  clearFormattedDataCache();
+
   atools::sql::SqlRecord tableCols = db->record(columns->getTablename());
   QString queryCols = buildColumnList(tableCols);
 
@@ -660,10 +670,46 @@ void SqlModel::refreshData()
 
 void SqlModel::resetSqlQuery()
 {
+  clearFormattedDataCache();
+
   QSqlQueryModel::setQuery(currentSqlQuery, db->getQSqlDatabase());
 
   if(lastError().isValid())
     atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
+
+  updateColumnDescriptors();
+}
+
+void SqlModel::clear()
+{
+  clearFormattedDataCache();
+  QSqlQueryModel::clear();
+  updateColumnDescriptors();
+}
+
+void SqlModel::clearFormattedDataCache()
+{
+#ifdef DEBUG_INFORMATION
+  if(formattedDataCacheHits + formattedDataCacheMisses > 0)
+    qDebug() << Q_FUNC_INFO << columns->getTablename() << "hits" << formattedDataCacheHits
+             << "misses" << formattedDataCacheMisses;
+#endif
+
+  formattedDataCache.clear();
+  formattedDataCacheHits = formattedDataCacheMisses = 0;
+}
+
+void SqlModel::updateColumnDescriptors()
+{
+  columnDescriptors.clear();
+  columnNames.clear();
+
+  SqlRecord rec = getSqlRecord();
+  for(int i = 0; i < rec.count(); i++)
+  {
+    columnNames.append(rec.fieldName(i));
+    columnDescriptors.append(columns->getColumn(columnNames.last()));
+  }
 }
 
 Qt::SortOrder SqlModel::getSortOrder() const
@@ -692,17 +738,31 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 
   Qt::ItemDataRole dataRole = static_cast<Qt::ItemDataRole>(role);
 
-  // Get the default value for this role. Can be a font, color, etc.
-  QVariant roleValue = QSqlQueryModel::data(index, role);
-
   if(handlerRoles.contains(dataRole))
   {
-    // Callback wants to be called for this role
+    // Fonts are derived from the view font which changes with zoom and options - do not cache these
+    bool useCache = dataRole != Qt::FontRole;
+
+    // Callback wants to be called for this role - look for already formatted value first
+    quint64 key = (static_cast<quint64>(index.row()) << 32) | (static_cast<quint64>(index.column()) << 16) |
+                  static_cast<quint64>(role & 0xffff);
+    if(useCache)
+    {
+      QVariant *cached = formattedDataCache.object(key);
+      if(cached != nullptr)
+      {
+        formattedDataCacheHits++;
+        return *cached;
+      }
+      formattedDataCacheMisses++;
+    }
+
+    // Get the default value for this role. Can be a font, color, etc.
+    QVariant roleValue = QSqlQueryModel::data(index, role);
 
     // Get data to display
     QVariant dataValue = QSqlQueryModel::data(index, Qt::DisplayRole);
-    QString col = getSqlRecord().fieldName(index.column());
-    const Column *column = columns->getColumn(col);
+    const Column *column = getColumnModel(index.column());
 
     int row = -1;
     if(!boundingRect.isValid())
@@ -710,10 +770,16 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
       row = index.row();
 
     QVariant retval = dataFunction(index.column(), row, column, roleValue, dataValue, dataRole);
-    if(retval.isValid())
-      return retval;
+    if(!retval.isValid())
+      retval = roleValue;
+
+    if(useCache)
+      formattedDataCache.insert(key, new QVariant(retval));
+    return retval;
   }
-  return roleValue;
+
+  // Get the default value for this role. Can be a font, color, etc.
+  return QSqlQueryModel::data(index, role);
 }
 
 void SqlModel::fetchMore(const QModelIndex& parent)
@@ -739,7 +805,10 @@ QVariant SqlModel::getRawData(int row, int col) const
 
 QString SqlModel::getColumnName(int col) const
 {
-  return getSqlRecord().fieldName(col);
+  if(col >= 0 && col < columnNames.size())
+    return columnNames.at(col);
+  else
+    return getSqlRecord().fieldName(col);
 }
 
 QVariant SqlModel::getFormattedFieldData(const QModelIndex& index) const
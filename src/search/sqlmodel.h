@@ -22,6 +22,7 @@
 
 #include "search/querybuilder.h"
 
+#include <QCache>
 #include <QSqlQueryModel>
 
 namespace atools {
@@ -166,6 +167,12 @@ public:
   /* Update model after data change */
   void refreshData();
 
+  /* Clear cached formatted values. Needed if the data callback output changes without a query update. */
+  void clearFormattedDataCache();
+
+  /* Also clears caches */
+  virtual void clear() override;
+
 signals:
   /* Emitted when more data was fetched */
   void fetchedMore();
@@ -201,6 +208,9 @@ private:
   void buildSqlWhereValue(QVariant& whereValue) const;
   void buildSqlWhereValue(QString& whereValue) const;
 
+  /* Resolve column descriptors for the current query once */
+  void updateColumnDescriptors();
+
   /* Default - all conditions are combined using "and" */
   const QString WHERE_OPERATOR = "and";
 
@@ -233,6 +243,14 @@ private:
   /* Set by buildWhere. Will ignore all other filter options */
   bool overrideModeActive = false;
 
+  /* Column descriptors and names by column index for the current query. Updated in resetSqlQuery. */
+  QVector<const Column *> columnDescriptors;
+  QStringList columnNames;
+
+  /* Key is row, column and role. Holds results of dataFunction for the handler roles except Qt::FontRole. */
+  static Q_DECL_CONSTEXPR int FORMATTED_DATA_CACHE_SIZE = 50000;
+  mutable QCache<quint64, QVariant> formattedDataCache;
+  mutable int formattedDataCacheHits = 0, formattedDataCacheMisses = 0;
 };
 
 #endif // LITTLENAVMAP_SQLMODEL_H
@@ -334,6 +334,7 @@ void UserdataController::moveUserpointFromMap(const map::MapUserpoint& userpoint
   // Change coordinate columns for id
   manager->updateByRecord(rec, {userpoint.id});
   transaction.commit();
+  dataModified();
 
   // No need to update search
   emit userdataChanged();
@@ -348,6 +349,7 @@ void UserdataController::backup()
 void UserdataController::clearTemporary()
 {
   manager->clearTemporary();
+  dataModified();
 }
 
 map::MapUserpoint UserdataController::getUserpointById(int id)
@@ -425,6 +427,7 @@ void UserdataController::addUserpointInternal(int id, const atools::geo::Pos& po
     SqlTransaction transaction(manager->getDatabase());
     manager->insertByRecord(*lastAddedRecord);
     transaction.commit();
+    dataModified();
     emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
     emit userdataChanged();
     mainWindow->setStatusMessage(tr("Userpoint added."));
@@ -450,6 +453,7 @@ void UserdataController::editUserpoints(const QVector<int>& ids)
       SqlTransaction transaction(manager->getDatabase());
       manager->updateByRecord(dlg.getRecord(), ids);
       transaction.commit();
+      dataModified();
 
       emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
       emit userdataChanged();
@@ -475,6 +479,7 @@ void UserdataController::deleteUserpoints(const QVector<int>& ids)
     SqlTransaction transaction(manager->getDatabase());
     manager->removeRows(ids);
     transaction.commit();
+    dataModified();
 
     emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
     emit userdataChanged();
@@ -514,6 +519,9 @@ void UserdataController::importCsv()
   {
     atools::gui::ErrorHandler(mainWindow).handleUnknownException();
   }
+
+  // Also update if import failed since parts might be already loaded
+  dataModified();
 }
 
 void UserdataController::importXplaneUserFixDat()
@@ -543,6 +551,9 @@ void UserdataController::importXplaneUserFixDat()
   {
     atools::gui::ErrorHandler(mainWindow).handleUnknownException();
   }
+
+  // Also update if import failed since parts might be already loaded
+  dataModified();
 }
 
 void UserdataController::importGarmin()
@@ -571,6 +582,9 @@ void UserdataController::importGarmin()
   {
     atools::gui::ErrorHandler(mainWindow).handleUnknownException();
   }
+
+  // Also update if import failed since parts might be already loaded
+  dataModified();
 }
 
 void UserdataController::exportCsv()
@@ -734,6 +748,7 @@ void UserdataController::clearDatabase()
   if(retval == QMessageBox::Yes)
   {
     manager->clearData();
+    dataModified();
     emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
   }
 }
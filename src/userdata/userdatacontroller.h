@@ -153,6 +153,13 @@ public:
   /* Fill structure for user point id */
   map::MapUserpoint getUserpointById(int id);
 
+  /* Incremented on each modification of the userpoint table like edit, move, delete or import.
+   * Used to invalidate caches. */
+  quint32 getDataVersion() const
+  {
+    return dataVersion;
+  }
+
 signals:
   /* Sent after database modification to update the search result table */
   void refreshUserdataSearch(bool loadAll, bool keepSelection);
@@ -176,6 +183,12 @@ private:
   /* Get default Garmin GTN export path */
   QString garminGtnUserWptPath();
 
+  /* Increment version after any change to the userpoint table */
+  void dataModified()
+  {
+    dataVersion++;
+  }
+
   /* Currently in actions selected types */
   QStringList selectedTypes;
   bool selectedUnknownType = false;
@@ -191,6 +204,7 @@ private:
   QVector<QAction *> actions;
   atools::sql::SqlRecord *lastAddedRecord = nullptr;
 
+  quint32 dataVersion = 0;
 };
 
 #endif // USERDATACONTROLLER_H
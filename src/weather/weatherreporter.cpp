@@ -47,12 +47,16 @@
 #include <QEventLoop>
 #include <functional>
 #include <QProcess>
+#include <QtConcurrent/QtConcurrentRun>
 
 // Checks the first line of an ASN file if it has valid content
 static const QRegularExpression ASN_VALIDATE_REGEXP("^[A-Z0-9]{3,4}::[A-Z0-9]{3,4} .+$");
 static const QRegularExpression ASN_VALIDATE_FLIGHTPLAN_REGEXP("^DepartureMETAR=.+$");
 static const QRegularExpression ASN_FLIGHTPLAN_REGEXP("^(DepartureMETAR|DestinationMETAR)=([A-Z0-9]{3,4})?(.*)$");
 
+// Clear parsed METAR cache if it grows beyond this number of stations
+static const int MAX_METAR_CACHE_SIZE = 20000;
+
 using atools::fs::FsPaths;
 using atools::fs::weather::NoaaWeatherDownloader;
 using atools::fs::weather::WeatherNetDownload;
@@ -116,10 +120,16 @@ WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::
           this, &WeatherReporter::weatherDownloadSslErrors);
   connect(ivaoWeather, &WeatherNetDownload::weatherDownloadSslErrors,
           this, &WeatherReporter::weatherDownloadSslErrors);
+
+  connect(&metarDecodeWatcher, &QFutureWatcher<QVector<MetarCacheEntry> >::finished,
+          this, &WeatherReporter::metarDecodeFinished);
 }
 
 WeatherReporter::~WeatherReporter()
 {
+  metarDecodePending.clear();
+  metarDecodeWatcher.waitForFinished();
+
   deleteFsWatcher();
   delete noaaWeather;
   delete vatsimWeather;
@@ -131,19 +141,83 @@ WeatherReporter::~WeatherReporter()
 void WeatherReporter::noaaWeatherUpdated()
 {
   mainWindow->setStatusMessage(tr("NOAA weather downloaded."), true /* addToLog */);
-  emit weatherUpdated();
+  decodeMetarsBackground(map::WEATHER_SOURCE_NOAA);
 }
 
 void WeatherReporter::ivaoWeatherUpdated()
 {
   mainWindow->setStatusMessage(tr("IVAO weather downloaded."), true /* addToLog */);
-  emit weatherUpdated();
+  decodeMetarsBackground(map::WEATHER_SOURCE_IVAO);
 }
 
 void WeatherReporter::vatsimWeatherUpdated()
 {
   mainWindow->setStatusMessage(tr("VATSIM weather downloaded."), true /* addToLog */);
+  decodeMetarsBackground(map::WEATHER_SOURCE_VATSIM);
+}
+
+void WeatherReporter::decodeMetarsBackground(map::MapWeatherSource source)
+{
+  if(metarDecodeWatcher.isRunning())
+  {
+    // Decode again when the running thread is done
+    if(!metarDecodePending.contains(source))
+      metarDecodePending.append(source);
+    return;
+  }
+
+  // Collect changed raw reports of all cached stations for this source - fetching raw reports is fast
+  QVector<MetarCacheEntry> entries;
+  for(const MetarCacheEntry& entry : metarCache)
+  {
+    if(entry.source == source)
+    {
+      QString raw = onlineMetar(source, entry.ident);
+      if(raw != entry.raw && !raw.isEmpty())
+      {
+        MetarCacheEntry newEntry = entry;
+        newEntry.raw = raw;
+        entries.append(newEntry);
+      }
+    }
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "source" << source << "changed reports" << entries.size();
+
+  if(entries.isEmpty())
+    // Nothing to decode - notify at once
+    emit weatherUpdated();
+  else
+    metarDecodeWatcher.setFuture(QtConcurrent::run(&WeatherReporter::decodeMetarsThread, entries));
+}
+
+QVector<WeatherReporter::MetarCacheEntry> WeatherReporter::decodeMetarsThread(QVector<MetarCacheEntry> entries)
+{
+  for(MetarCacheEntry& entry : entries)
+    entry.metar = Metar(entry.raw);
+  return entries;
+}
+
+void WeatherReporter::metarDecodeFinished()
+{
+  const QVector<MetarCacheEntry> entries = metarDecodeWatcher.result();
+
+  for(const MetarCacheEntry& entry : entries)
+  {
+    // Keep entries which were updated on demand in the meantime
+    QPair<int, QString> key(entry.source, entry.ident);
+    if(onlineMetar(entry.source, entry.ident) == entry.raw)
+      metarCache.insert(key, entry);
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "decoded" << entries.size() << "cache size" << metarCache.size();
+
   emit weatherUpdated();
+
+  if(!metarDecodePending.isEmpty())
+    decodeMetarsBackground(metarDecodePending.takeFirst());
 }
 
 atools::geo::Pos WeatherReporter::fetchAirportCoordinates(const QString& airportIdent)
@@ -650,7 +724,7 @@ atools::fs::weather::Metar WeatherReporter::getAirportWeather(const QString& air
     case map::WEATHER_SOURCE_SIMULATOR:
       if(NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11)
         // X-Plane weather file
-        return Metar(getXplaneMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation);
+        return cachedMetar(source, airportIcao, getXplaneMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation);
       else if(NavApp::getConnectClient()->isConnected() /*&& !NavApp::getConnectClient()->isConnectedNetwork()*/)
       {
         atools::fs::weather::MetarResult res =
@@ -658,23 +732,74 @@ atools::fs::weather::Metar WeatherReporter::getAirportWeather(const QString& air
 
         if(res.isValid() && !res.metarForStation.isEmpty())
           // FSX/P3D - Flight simulator fetched weather or network connection
-          return Metar(res.metarForStation, res.requestIdent, res.timestamp, true);
+          return cachedMetar(source, airportIcao, res.metarForStation, res.requestIdent, res.timestamp, true);
       }
       return Metar();
 
     case map::WEATHER_SOURCE_ACTIVE_SKY:
-      return Metar(getActiveSkyMetar(airportIcao));
+      return cachedMetar(source, airportIcao, getActiveSkyMetar(airportIcao));
+
+    case map::WEATHER_SOURCE_NOAA:
+    case map::WEATHER_SOURCE_VATSIM:
+    case map::WEATHER_SOURCE_IVAO:
+      return cachedMetar(source, airportIcao, onlineMetar(source, airportIcao));
+  }
+  return Metar();
+}
 
+QString WeatherReporter::onlineMetar(map::MapWeatherSource source, const QString& airportIcao)
+{
+  switch(source)
+  {
     case map::WEATHER_SOURCE_NOAA:
-      return Metar(getNoaaMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation);
+      return getNoaaMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation;
 
     case map::WEATHER_SOURCE_VATSIM:
-      return Metar(getVatsimMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation);
+      return getVatsimMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation;
 
     case map::WEATHER_SOURCE_IVAO:
-      return Metar(getIvaoMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation);
+      return getIvaoMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation;
+
+    case map::WEATHER_SOURCE_SIMULATOR:
+    case map::WEATHER_SOURCE_ACTIVE_SKY:
+      break;
   }
-  return Metar();
+  return QString();
+}
+
+const atools::fs::weather::Metar& WeatherReporter::cachedMetar(map::MapWeatherSource source, const QString& ident,
+                                                               const QString& raw, const QString& requestIdent,
+                                                               const QDateTime& timestamp, bool simFormat)
+{
+  if(raw.isEmpty())
+    return emptyMetar;
+
+  QPair<int, QString> key(source, ident);
+  auto it = metarCache.find(key);
+  if(it != metarCache.end() && it->raw == raw && it->requestIdent == requestIdent && it->timestamp == timestamp &&
+     it->simFormat == simFormat)
+    // Report not changed - use parsed object
+    return it->metar;
+
+  if(metarCache.size() > MAX_METAR_CACHE_SIZE)
+  {
+    qDebug() << Q_FUNC_INFO << "clearing METAR cache" << metarCache.size();
+    metarCache.clear();
+  }
+
+  MetarCacheEntry entry;
+  entry.source = source;
+  entry.ident = ident;
+  entry.raw = raw;
+  entry.requestIdent = requestIdent;
+  entry.timestamp = timestamp;
+  entry.simFormat = simFormat;
+  if(simFormat)
+    entry.metar = Metar(raw, requestIdent, timestamp, true);
+  else
+    entry.metar = Metar(raw);
+
+  return metarCache.insert(key, entry)->metar;
 }
 
 void WeatherReporter::preDatabaseLoad()
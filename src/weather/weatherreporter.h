@@ -19,8 +19,11 @@
 #define LITTLENAVMAP_WEATHERREPORTER_H
 
 #include "fs/fspaths.h"
+#include "fs/weather/metar.h"
 #include "common/mapflags.h"
 
+#include <QDateTime>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QObject>
 
@@ -36,8 +39,6 @@ namespace fs {
 namespace weather {
 struct MetarResult;
 
-class Metar;
-
 class WeatherNetSingle;
 class WeatherNetDownload;
 class XpWeatherReader;
@@ -56,6 +57,10 @@ class MainWindow;
  *
  * Uses hashmaps to cache online requests. Cache entries will timeout after 15 minutes.
  *
+ * Parsed METAR objects for map display are cached by source and station and reused as long as the raw
+ * report is unchanged. Reports of already displayed stations are decoded again in a background thread
+ * after an online weather download.
+ *
  * Only one request is done. If a request is already waiting a new one will cancel the old one.
  */
 // TODO better support for mutliple simulators
@@ -97,7 +102,8 @@ public:
    */
   atools::fs::weather::MetarResult getIvaoMetar(const QString& airportIcao, const atools::geo::Pos& pos);
 
-  /* For display. Source depends on settings and parsed objects are cached. */
+  /* For display. Source depends on settings and parsed objects are cached.
+   * Only the raw report is fetched and compared if the station is already in the cache. */
   atools::fs::weather::Metar getAirportWeather(const QString& airportIcao, const atools::geo::Pos& airportPos,
                                                map::MapWeatherSource source);
 
@@ -187,6 +193,31 @@ private:
 
   atools::geo::Pos fetchAirportCoordinates(const QString& airportIdent);
 
+  /* Parsed METAR with all values which were used to create it */
+  struct MetarCacheEntry
+  {
+    map::MapWeatherSource source;
+    QString ident, raw, requestIdent;
+    QDateTime timestamp;
+    bool simFormat;
+    atools::fs::weather::Metar metar;
+  };
+
+  /* Get parsed METAR from cache or parse and add it if the raw report differs */
+  const atools::fs::weather::Metar& cachedMetar(map::MapWeatherSource source, const QString& ident,
+                                                const QString& raw, const QString& requestIdent = QString(),
+                                                const QDateTime& timestamp = QDateTime(), bool simFormat = false);
+
+  /* Get the raw report for the online sources */
+  QString onlineMetar(map::MapWeatherSource source, const QString& airportIcao);
+
+  /* Decode new reports of all cached stations for the online source in a background thread */
+  void decodeMetarsBackground(map::MapWeatherSource source);
+  void metarDecodeFinished();
+
+  /* Called in background thread */
+  static QVector<MetarCacheEntry> decodeMetarsThread(QVector<MetarCacheEntry> entries);
+
   /* Update IVAO and NOAA timeout periods - timeout is disable if weather services are not used */
   void updateTimeouts();
 
@@ -215,6 +246,14 @@ private:
 
   bool errorReported = false;
 
+  /* Parsed reports by source and station ident */
+  QHash<QPair<int, QString>, MetarCacheEntry> metarCache;
+  atools::fs::weather::Metar emptyMetar;
+
+  /* Background decoding after download and sources waiting for it */
+  QFutureWatcher<QVector<MetarCacheEntry> > metarDecodeWatcher;
+  QVector<map::MapWeatherSource> metarDecodePending;
+
   bool verbose = false;
 };
 
@@ -28,6 +28,7 @@
 #include "web/webmapcontroller.h"
 #include "web/webtools.h"
 #include "web/webapp.h"
+#include "web/webapicache.h"
 #include "common/mapcolors.h"
 #include "geo/calculations.h"
 #include "common/htmlinfobuilder.h"
@@ -38,14 +39,17 @@
 #include <QBuffer>
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QPainter>
 #include <QtWidgets/QApplication>
 
 using namespace stefanfrings;
 
 RequestHandler::RequestHandler(QObject *parent, WebMapController *webMapController,
-                               HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam)
-  : HttpRequestHandler(parent), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
+                               QWidget *parentWidgetParam, WebApiCache *apiCacheParam,
+                               bool verboseParam)
+  : HttpRequestHandler(parent), parentWidget(parentWidgetParam), apiCache(apiCacheParam),
+  verbose(verboseParam)
 {
   qDebug() << Q_FUNC_INFO;
 
@@ -99,6 +103,14 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
     // ===========================================================================
     // Requests for map images only - either with or without session
     handleMapImage(request, response);
+  else if(path == "/api/events")
+    // ===========================================================================
+    // Server-sent event stream pushing JSON documents - no session
+    handleApiEvents(request, response);
+  else if(path.startsWith("/api/"))
+    // ===========================================================================
+    // JSON documents - no session
+    handleApi(request, response, path);
   else
   {
     HttpSession session = getSession(request, response);
@@ -205,6 +217,7 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
             if(t.contains("{aircraftText}"))
             {
               html.clear();
+              HtmlInfoBuilder *htmlInfoBuilder = getHtmlInfoBuilder();
               htmlInfoBuilder->aircraftText(userAircraft, html);
               htmlInfoBuilder->aircraftTextWeightAndFuel(userAircraft, html);
               t.setVariable("aircraftText", html.getHtml());
@@ -216,8 +229,8 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
             {
               Route route = emit getRoute();
               html.clear();
-              htmlInfoBuilder->aircraftProgressText(userAircraft, html, route,
-                                                    false /* show more/less switch */, false /* less */);
+              getHtmlInfoBuilder()->aircraftProgressText(userAircraft, html, route,
+                                                         false /* show more/less switch */, false /* less */);
               t.setVariable("aircraftProgressText", html.getHtml());
             }
 
@@ -420,6 +433,140 @@ void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& response
     showErrorPixmap(response, width, height, 404, mapPixmap.error);
 }
 
+namespace apikeys {
+static const QHash<QString, web::ApiDocument> DOCUMENTS(
+{
+  {"aircraft", web::API_AIRCRAFT},
+  {"progress", web::API_PROGRESS},
+  {"route", web::API_ROUTE}
+});
+
+/* Upper limit for long-polling requests */
+static const int MAX_WAIT_SECONDS = 30;
+
+/* Event streams are closed after this time. Browsers reconnect automatically. */
+static const qint64 MAX_EVENT_STREAM_MS = 300000;
+
+/* Send a comment line if nothing has changed to detect closed connections */
+static const unsigned long EVENT_KEEPALIVE_MS = 15000;
+}
+
+void RequestHandler::handleApi(HttpRequest& request, HttpResponse& response, const QString& path)
+{
+  Parameter params(request);
+  QString name = path.mid(5); // Remove "/api/"
+  if(!apikeys::DOCUMENTS.contains(name))
+  {
+    response.setHeader("Content-Type", "application/json; charset=UTF-8");
+    response.setStatus(404, "Not found");
+    response.write("{\"error\":\"Not found.\"}", true);
+    return;
+  }
+  web::ApiDocument document = apikeys::DOCUMENTS.value(name);
+
+  // Client sends last ETag - compare with current sequence
+  quint64 clientSequence = WebApiCache::sequenceForEtag(request.getHeader("If-None-Match"));
+
+  if(params.has("wait") && clientSequence > 0 && clientSequence == apiCache->getSequence(document))
+  {
+    // Long-polling - block this thread until document changes or timeout
+    int waitSeconds = std::max(1, std::min(params.asInt("wait", apikeys::MAX_WAIT_SECONDS),
+                                           apikeys::MAX_WAIT_SECONDS));
+    apiCache->waitForChange(document, clientSequence, static_cast<unsigned long>(waitSeconds) * 1000UL);
+  }
+
+  QByteArray etag;
+  QByteArray json = apiCache->getJson(document, &etag);
+
+  response.setHeader("Cache-Control", "no-cache");
+  response.setHeader("ETag", etag);
+
+  if(clientSequence > 0 && WebApiCache::etagForSequence(clientSequence) == etag)
+  {
+    // Not changed
+    response.setStatus(304, "Not Modified");
+    response.write(QByteArray(), true);
+  }
+  else
+  {
+    response.setHeader("Content-Type", "application/json; charset=UTF-8");
+    response.write(json.isEmpty() ? QByteArray("{}") : json, true);
+  }
+}
+
+void RequestHandler::handleApiEvents(HttpRequest& request, HttpResponse& response)
+{
+  Parameter params(request);
+
+  // Get requested documents from a comma separated list - all if not given
+  QVector<web::ApiDocument> documents;
+  QStringList names = params.asStr("documents").split(',', QString::SkipEmptyParts);
+  if(names.isEmpty())
+    names = apikeys::DOCUMENTS.keys();
+
+  for(const QString& name : names)
+  {
+    if(apikeys::DOCUMENTS.contains(name.trimmed()))
+      documents.append(apikeys::DOCUMENTS.value(name.trimmed()));
+  }
+
+  if(documents.isEmpty())
+  {
+    response.setStatus(404, "Not found");
+    response.write(QByteArray(), true);
+    return;
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Event stream started for" << names;
+
+  response.setHeader("Content-Type", "text/event-stream; charset=UTF-8");
+  response.setHeader("Cache-Control", "no-cache");
+
+  // Reconnect delay for browser after closing stream
+  response.write("retry: 1000\n\n", false);
+
+  QVector<quint64> lastSequences(web::API_NUM_DOCUMENTS, 0);
+  QElapsedTimer timer;
+  timer.start();
+
+  while(response.isConnected() && timer.elapsed() < apikeys::MAX_EVENT_STREAM_MS && !apiCache->isShutdown())
+  {
+    // Remember total before sending to avoid missing updates while writing
+    quint64 totalSequence = apiCache->getTotalSequence();
+
+    for(web::ApiDocument document : documents)
+    {
+      quint64 sequence;
+      bool isDelta;
+      QByteArray json = apiCache->getJsonSince(document, lastSequences.at(document), sequence, isDelta);
+
+      if(!json.isEmpty())
+      {
+        // Event type is document name for full documents and document name plus "delta" for changes
+        QByteArray event = apikeys::DOCUMENTS.key(document).toUtf8();
+        if(isDelta)
+          event.append("delta");
+
+        response.write("event: " + event + "\nid: " + QByteArray::number(sequence) +
+                       "\ndata: " + json + "\n\n", false);
+        lastSequences[document] = sequence;
+      }
+    }
+
+    if(!apiCache->waitForAnyChange(totalSequence, apikeys::EVENT_KEEPALIVE_MS) && response.isConnected() &&
+       !apiCache->isShutdown())
+      // Nothing happened - send a comment line as keepalive
+      response.write(": keepalive\n\n", false);
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Event stream closed after" << timer.elapsed() << "ms";
+
+  if(response.isConnected())
+    response.write(QByteArray(), true);
+}
+
 void RequestHandler::showErrorPixmap(HttpResponse& response, int width, int height, int status, const QString& text)
 {
   qWarning() << Q_FUNC_INFO << "Error" << status << text;
@@ -489,6 +636,13 @@ stefanfrings::HttpSession RequestHandler::getSession(HttpRequest& request, HttpR
   return session;
 }
 
+HtmlInfoBuilder *RequestHandler::getHtmlInfoBuilder()
+{
+  if(!htmlInfoBuilders.hasLocalData())
+    htmlInfoBuilders.setLocalData(new HtmlInfoBuilder(parentWidget, true /*info*/, true /*print*/));
+  return htmlInfoBuilders.localData();
+}
+
 QString RequestHandler::buildRefreshSelect(int defaultValue)
 {
   // Build the dowp down box to insert into the form.
@@ -496,6 +650,7 @@ QString RequestHandler::buildRefreshSelect(int defaultValue)
   static const QVector<std::pair<int, QString> > rates(
   {
     {0, tr("Manual Reload")},
+    {web::REFRESH_LIVE, tr("Live Updates")},
     {1, tr("1 Second")},
     {2, tr("2 Seconds")},
     {5, tr("5 Seconds")},
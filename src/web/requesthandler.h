@@ -24,6 +24,7 @@
 #include "web/webmapcontroller.h"
 
 #include <QPixmap>
+#include <QThreadStorage>
 
 #include "geo/pos.h"
 #include "geo/rect.h"
@@ -36,6 +37,8 @@ class HttpSession;
 }
 
 class HtmlInfoBuilder;
+class WebApiCache;
+class QWidget;
 
 /*
  * Handles all HTTP server requests including stateless and stateful. Maintains a session for the stateful page.
@@ -51,8 +54,8 @@ class RequestHandler :
 
 public:
   /* Prepare connections to other objects. Handler is ready to accept connections when instantiated. */
-  RequestHandler(QObject *parent, WebMapController *webMapController, HtmlInfoBuilder *htmlInfoBuilderParam,
-                 bool verboseParam);
+  RequestHandler(QObject *parent, WebMapController *webMapController, QWidget *parentWidgetParam,
+                 WebApiCache *apiCacheParam, bool verboseParam);
   virtual ~RequestHandler() override;
 
   /* Doing all the work right here. */
@@ -87,13 +90,27 @@ private:
   /* Handle stateful and stateless map image requests. */
   void handleMapImage(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
+  /* Handle JSON API requests for /api/aircraft, /api/progress and /api/route. Serves the pre-serialized
+   * documents from the cache, supports ETag/If-None-Match and long-polling with parameter "wait". */
+  void handleApi(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response, const QString& path);
+
+  /* Server-sent event stream for /api/events. Sends full documents first and deltas afterwards.
+   * Blocks the handler thread until the client disconnects or the maximum stream duration is reached. */
+  void handleApiEvents(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
+
   /* Build the select dropdown box HTML code with the default value pre-selected. */
   QString buildRefreshSelect(int defaultValue);
 
   /* Create and prepare a session and set the cookie or return current session */
   stefanfrings::HttpSession getSession(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
-  HtmlInfoBuilder *htmlInfoBuilder;
+  /* Get the HTML builder for the calling request thread. Created on first use. */
+  HtmlInfoBuilder *getHtmlInfoBuilder();
+
+  /* One builder per request thread since builders are not thread safe. Deleted when the thread exits. */
+  QThreadStorage<HtmlInfoBuilder *> htmlInfoBuilders;
+  QWidget *parentWidget;
+  WebApiCache *apiCache;
 
   bool verbose = false;
 };
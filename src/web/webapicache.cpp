@@ -0,0 +1,204 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webapicache.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+
+WebApiCache::WebApiCache()
+{
+  qDebug() << Q_FUNC_INFO;
+}
+
+WebApiCache::~WebApiCache()
+{
+  qDebug() << Q_FUNC_INFO;
+}
+
+void WebApiCache::update(web::ApiDocument document, const QJsonObject& object)
+{
+  QMutexLocker locker(&mutex);
+
+  Document& doc = documents[document];
+  if(doc.sequence > 0 && doc.object == object)
+    // Nothing changed - keep ETag and do not wake clients
+    return;
+
+  // Collect changed or added top level keys for the delta ============================
+  QJsonObject delta;
+  for(auto it = object.constBegin(); it != object.constEnd(); ++it)
+  {
+    if(doc.object.value(it.key()) != it.value())
+      delta.insert(it.key(), it.value());
+  }
+
+  // Removed keys are sent as null
+  for(auto it = doc.object.constBegin(); it != doc.object.constEnd(); ++it)
+  {
+    if(!object.contains(it.key()))
+      delta.insert(it.key(), QJsonValue::Null);
+  }
+
+  doc.object = object;
+  doc.json = QJsonDocument(object).toJson(QJsonDocument::Compact);
+  doc.delta = QJsonDocument(delta).toJson(QJsonDocument::Compact);
+  doc.sequence++;
+
+  changed.wakeAll();
+}
+
+void WebApiCache::clear()
+{
+  QMutexLocker locker(&mutex);
+
+  for(Document& doc : documents)
+  {
+    if(!doc.object.isEmpty())
+    {
+      doc.object = QJsonObject();
+      doc.json = QJsonDocument(doc.object).toJson(QJsonDocument::Compact);
+      doc.delta.clear();
+      doc.sequence++;
+    }
+  }
+  changed.wakeAll();
+}
+
+void WebApiCache::setShutdown(bool value)
+{
+  QMutexLocker locker(&mutex);
+  shutdown = value;
+  changed.wakeAll();
+}
+
+bool WebApiCache::isShutdown() const
+{
+  QMutexLocker locker(&mutex);
+  return shutdown;
+}
+
+QByteArray WebApiCache::getJson(web::ApiDocument document, QByteArray *etag) const
+{
+  QMutexLocker locker(&mutex);
+
+  const Document& doc = documents[document];
+  if(etag != nullptr)
+    *etag = etagForSequence(doc.sequence);
+  return doc.json;
+}
+
+QByteArray WebApiCache::getJsonSince(web::ApiDocument document, quint64 lastSequence, quint64& sequence,
+                                     bool& isDelta) const
+{
+  QMutexLocker locker(&mutex);
+
+  const Document& doc = documents[document];
+  sequence = doc.sequence;
+  isDelta = false;
+
+  if(doc.sequence == lastSequence)
+    return QByteArray();
+  else if(lastSequence > 0 && doc.sequence == lastSequence + 1 && !doc.delta.isEmpty())
+  {
+    // Client has seen the previous version - send only changes
+    isDelta = true;
+    return doc.delta;
+  }
+  else
+    // Client missed more than one update or is new
+    return doc.json;
+}
+
+quint64 WebApiCache::getSequence(web::ApiDocument document) const
+{
+  QMutexLocker locker(&mutex);
+  return documents[document].sequence;
+}
+
+quint64 WebApiCache::getTotalSequence() const
+{
+  QMutexLocker locker(&mutex);
+  return totalSequenceInternal();
+}
+
+bool WebApiCache::waitForChange(web::ApiDocument document, quint64 sequence, unsigned long timeoutMs) const
+{
+  QElapsedTimer timer;
+  timer.start();
+  QMutexLocker locker(&mutex);
+
+  while(documents[document].sequence == sequence && !shutdown)
+  {
+    qint64 remaining = static_cast<qint64>(timeoutMs) - timer.elapsed();
+    if(remaining <= 0)
+      return false;
+
+    // Wait is woken up by any document update
+    changed.wait(&mutex, static_cast<unsigned long>(remaining));
+  }
+  return true;
+}
+
+bool WebApiCache::waitForAnyChange(quint64 totalSequence, unsigned long timeoutMs) const
+{
+  QElapsedTimer timer;
+  timer.start();
+  QMutexLocker locker(&mutex);
+
+  while(totalSequenceInternal() == totalSequence && !shutdown)
+  {
+    qint64 remaining = static_cast<qint64>(timeoutMs) - timer.elapsed();
+    if(remaining <= 0)
+      return false;
+
+    changed.wait(&mutex, static_cast<unsigned long>(remaining));
+  }
+  return true;
+}
+
+QByteArray WebApiCache::etagForSequence(quint64 sequence)
+{
+  return "\"lnm-" + QByteArray::number(sequence) + "\"";
+}
+
+quint64 WebApiCache::sequenceForEtag(const QByteArray& etag)
+{
+  QByteArray str = etag.trimmed();
+
+  // Remove weak prefix and quotes
+  if(str.startsWith("W/"))
+    str = str.mid(2);
+  if(str.startsWith('"') && str.endsWith('"') && str.size() >= 2)
+    str = str.mid(1, str.size() - 2);
+
+  if(!str.startsWith("lnm-"))
+    return 0;
+
+  bool ok;
+  quint64 sequence = str.mid(4).toULongLong(&ok);
+  return ok ? sequence : 0;
+}
+
+quint64 WebApiCache::totalSequenceInternal() const
+{
+  quint64 total = 0;
+  for(const Document& doc : documents)
+    total += doc.sequence;
+  return total;
+}
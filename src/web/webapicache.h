@@ -0,0 +1,101 @@
+/*****************************************************************************
+* Copyright 2015-2020 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBAPICACHE_H
+#define LNM_WEBAPICACHE_H
+
+#include "web/webflags.h"
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+/*
+ * Thread safe store for the JSON documents served by the web API (/api/aircraft, /api/progress and /api/route).
+ *
+ * Documents are filled from the main thread once per update and serialized once. Request handler threads
+ * only copy the serialized bytes. Each update increments a sequence number which is used as ETag and
+ * for long-polling as well as for the server-sent event stream.
+ *
+ * A delta containing only the changed top level keys is kept for the last update of each document.
+ */
+class WebApiCache
+{
+public:
+  WebApiCache();
+  ~WebApiCache();
+
+  /* Update document and wake all waiting request threads. Does nothing if the document is unchanged.
+   * Called from the main thread. */
+  void update(web::ApiDocument document, const QJsonObject& object);
+
+  /* Clear all documents and wake waiting threads. Sequence numbers are kept to avoid stale ETags. */
+  void clear();
+
+  /* Set shutdown status and wake all waiting threads. Waits return immediately while shutting down.
+   * Has to be called before the listener is deleted since deleting waits for all request threads. */
+  void setShutdown(bool value);
+
+  /* True if the server is being stopped. Long running request loops have to terminate. */
+  bool isShutdown() const;
+
+  /* Get serialized document and its ETag. Returns empty array if there is no document yet. */
+  QByteArray getJson(web::ApiDocument document, QByteArray *etag = nullptr) const;
+
+  /* Get the serialized document or the delta if the document was changed only once since lastSequence.
+   * sequence is set to the current sequence of the document and isDelta is set to true if a delta is returned.
+   * Returns empty array if nothing has changed since lastSequence. */
+  QByteArray getJsonSince(web::ApiDocument document, quint64 lastSequence, quint64& sequence, bool& isDelta) const;
+
+  /* Current sequence number of a document. 0 if never updated. */
+  quint64 getSequence(web::ApiDocument document) const;
+
+  /* Sum of all document sequences. Changes with any update. */
+  quint64 getTotalSequence() const;
+
+  /* Block the calling thread until the document sequence differs from sequence or the timeout is reached.
+   * Returns true if the document has changed. Returns immediately on shutdown.
+   * Has to be called from a request handler thread. */
+  bool waitForChange(web::ApiDocument document, quint64 sequence, unsigned long timeoutMs) const;
+
+  /* Same as above but waits for a change of any document. */
+  bool waitForAnyChange(quint64 totalSequence, unsigned long timeoutMs) const;
+
+  /* Build the quoted ETag string from a sequence number */
+  static QByteArray etagForSequence(quint64 sequence);
+
+  /* Parse sequence number from an ETag as sent in the If-None-Match header. Returns 0 if invalid. */
+  static quint64 sequenceForEtag(const QByteArray& etag);
+
+private:
+  struct Document
+  {
+    QJsonObject object;
+    QByteArray json, delta;
+    quint64 sequence = 0;
+  };
+
+  quint64 totalSequenceInternal() const;
+
+  Document documents[web::API_NUM_DOCUMENTS];
+  bool shutdown = false;
+
+  mutable QMutex mutex;
+  mutable QWaitCondition changed;
+};
+
+#endif // LNM_WEBAPICACHE_H
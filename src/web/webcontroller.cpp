@@ -20,8 +20,15 @@
 #include "settings/settings.h"
 #include "web/requesthandler.h"
 #include "web/webmapcontroller.h"
+#include "web/webapicache.h"
 #include "web/webapp.h"
 #include "gui/helphandler.h"
+#include "navapp.h"
+#include "route/route.h"
+#include "route/routecontroller.h"
+#include "common/mapcolors.h"
+#include "util/htmlbuilder.h"
+#include "fs/sc/simconnectdata.h"
 
 #include "templateengine/templatecache.h"
 #include "httpserver/httplistener.h"
@@ -37,6 +44,7 @@
 #include <QWidget>
 #include <QHostInfo>
 #include <QNetworkInterface>
+#include <QJsonArray>
 
 #include <options/optiondata.h>
 
@@ -65,6 +73,11 @@ WebController::WebController(QWidget *parent) :
 
   mapController = new WebMapController(parentWidget, verbose);
   htmlInfoBuilder = new HtmlInfoBuilder(parent, true /*info*/, true /*print*/);
+  apiCache = new WebApiCache;
+
+  simUpdateTimer.setSingleShot(true);
+  connect(&simUpdateTimer, &QTimer::timeout, this, &WebController::simUpdateTimeout);
+
   updateSettings();
 }
 
@@ -76,6 +89,7 @@ WebController::~WebController()
 
   delete mapController;
   delete htmlInfoBuilder;
+  delete apiCache;
 }
 
 void WebController::startServer()
@@ -104,7 +118,11 @@ void WebController::startServer()
   // Start map
   mapController->init();
 
-  requestHandler = new RequestHandler(this, mapController, htmlInfoBuilder, verbose);
+  apiCache->setShutdown(false);
+  requestHandler = new RequestHandler(this, mapController, parentWidget, apiCache, verbose);
+
+  // Fill flight plan document for first requests
+  updateApiRoute();
 
   // Set port - always override configuration file
   listenerSettings.insert("port", port);
@@ -199,6 +217,10 @@ void WebController::stopServer()
     return;
 
   mapController->deInit();
+  simUpdateTimer.stop();
+
+  // Terminate long-polling and event stream threads - deleting the listener waits for them
+  apiCache->setShutdown(true);
 
   if(listener != nullptr)
     listener->close();
@@ -206,6 +228,8 @@ void WebController::stopServer()
   delete listener;
   listener = nullptr;
 
+  apiCache->clear();
+
   delete requestHandler;
   requestHandler = nullptr;
 
@@ -296,3 +320,151 @@ QString WebController::getDefaultDocumentRoot() const
 {
   return QFileInfo(QCoreApplication::applicationDirPath() + QDir::separator() + "web").canonicalFilePath();
 }
+
+void WebController::simDataChanged(const atools::fs::sc::SimConnectData& simConnectData)
+{
+  if(!isRunning())
+    return;
+
+  pendingSimData = simConnectData;
+  if(!lastSimUpdate.isValid() || lastSimUpdate.hasExpired(MIN_SIM_UPDATE_TIME_MS))
+  {
+    // Last update was more than 500 ms ago
+    simUpdateTimer.stop();
+    simUpdateTimeout();
+  }
+  else if(!simUpdateTimer.isActive())
+    // Send the latest data once the interval is over
+    simUpdateTimer.start(static_cast<int>(MIN_SIM_UPDATE_TIME_MS - lastSimUpdate.elapsed()));
+}
+
+void WebController::simUpdateTimeout()
+{
+  if(!isRunning())
+    return;
+
+  updateApiAircraftAndProgress(pendingSimData);
+
+  // Flight plan table highlights the active leg - update only if changed
+  int activeLegIndex = NavApp::getRouteConst().getActiveLegIndex();
+  if(activeLegIndex != lastActiveLegIndex)
+    updateApiRoute();
+
+  lastSimUpdate.start();
+}
+
+void WebController::routeChanged()
+{
+  if(isRunning())
+    updateApiRoute();
+}
+
+void WebController::disconnectedFromSimulator()
+{
+  if(isRunning())
+  {
+    // Do not send data of the previous connection later
+    simUpdateTimer.stop();
+    apiCache->update(web::API_AIRCRAFT, QJsonObject({{"valid", false}}));
+    apiCache->update(web::API_PROGRESS, QJsonObject({{"valid", false}}));
+  }
+}
+
+void WebController::updateApiAircraftAndProgress(const atools::fs::sc::SimConnectData& simConnectData)
+{
+  const atools::fs::sc::SimConnectUserAircraft& userAircraft = simConnectData.getUserAircraftConst();
+  atools::util::HtmlBuilder html(mapcolors::webTableBackgroundColor, mapcolors::webTableAltBackgroundColor);
+
+  // Aircraft ========================================================
+  QJsonObject aircraft;
+  aircraft.insert("valid", userAircraft.isValid());
+  if(userAircraft.isValid())
+  {
+    // Same HTML as used by the aircraft page - rendered once for all clients
+    htmlInfoBuilder->aircraftText(userAircraft, html);
+    htmlInfoBuilder->aircraftTextWeightAndFuel(userAircraft, html);
+    aircraft.insert("html", html.getHtml());
+
+    const atools::geo::Pos& pos = userAircraft.getPosition();
+    aircraft.insert("position", QJsonObject({
+      {"lon", static_cast<double>(pos.getLonX())},
+      {"lat", static_cast<double>(pos.getLatY())},
+      {"altitudeFt", static_cast<double>(pos.getAltitude())}
+    }));
+    aircraft.insert("title", userAircraft.getAirplaneTitle());
+    aircraft.insert("model", userAircraft.getAirplaneModel());
+    aircraft.insert("registration", userAircraft.getAirplaneRegistration());
+    aircraft.insert("headingDegMag", static_cast<double>(userAircraft.getHeadingDegMag()));
+    aircraft.insert("headingDegTrue", static_cast<double>(userAircraft.getHeadingDegTrue()));
+    aircraft.insert("trackDegTrue", static_cast<double>(userAircraft.getTrackDegTrue()));
+    aircraft.insert("groundSpeedKts", static_cast<double>(userAircraft.getGroundSpeedKts()));
+    aircraft.insert("indicatedSpeedKts", static_cast<double>(userAircraft.getIndicatedSpeedKts()));
+    aircraft.insert("trueAirspeedKts", static_cast<double>(userAircraft.getTrueAirspeedKts()));
+    aircraft.insert("verticalSpeedFtMin", static_cast<double>(userAircraft.getVerticalSpeedFeetPerMin()));
+    aircraft.insert("indicatedAltitudeFt", static_cast<double>(userAircraft.getIndicatedAltitudeFt()));
+    aircraft.insert("altitudeAboveGroundFt", static_cast<double>(userAircraft.getAltitudeAboveGroundFt()));
+    aircraft.insert("onGround", userAircraft.isOnGround());
+    aircraft.insert("fuelTotalWeightLbs", static_cast<double>(userAircraft.getFuelTotalWeightLbs()));
+  }
+  apiCache->update(web::API_AIRCRAFT, aircraft);
+
+  // Progress ========================================================
+  const Route& route = NavApp::getRouteConst();
+  QJsonObject progress;
+  progress.insert("valid", userAircraft.isValid());
+  if(userAircraft.isValid())
+  {
+    html.clear();
+    htmlInfoBuilder->aircraftProgressText(userAircraft, html, route,
+                                          false /* show more/less switch */, false /* less */);
+    progress.insert("html", html.getHtml());
+
+    float distFromStart = 0.f, distToDest = 0.f, nextLegDistance = 0.f, crossTrackDistance = 0.f;
+    if(route.getRouteDistances(&distFromStart, &distToDest, &nextLegDistance, &crossTrackDistance))
+    {
+      progress.insert("activeLegIndex", route.getActiveLegIndex());
+      progress.insert("distanceFromStartNm", static_cast<double>(distFromStart));
+      progress.insert("distanceToDestinationNm", static_cast<double>(distToDest));
+      progress.insert("nextLegDistanceNm", static_cast<double>(nextLegDistance));
+      progress.insert("crossTrackDistanceNm", static_cast<double>(crossTrackDistance));
+    }
+  }
+  apiCache->update(web::API_PROGRESS, progress);
+}
+
+void WebController::updateApiRoute()
+{
+  const Route& route = NavApp::getRouteConst();
+  lastActiveLegIndex = route.getActiveLegIndex();
+
+  QJsonObject json;
+  json.insert("valid", !route.isEmpty());
+  json.insert("html", NavApp::getRouteController()->getFlightplanTableAsHtml(20, false));
+
+  if(!route.isEmpty())
+  {
+    json.insert("departure", route.getDepartureAirportLeg().getIdent());
+    json.insert("destination", route.getDestinationAirportLeg().getIdent());
+    json.insert("distanceNm", static_cast<double>(route.getTotalDistance()));
+    json.insert("cruiseAltitudeFt", static_cast<double>(route.getCruisingAltitudeFeet()));
+    json.insert("activeLegIndex", route.getActiveLegIndex());
+
+    QJsonArray legs;
+    for(int i = 0; i < route.size(); i++)
+    {
+      const RouteLeg& leg = route.value(i);
+      const atools::geo::Pos& pos = leg.getPosition();
+      legs.append(QJsonObject({
+        {"ident", leg.getIdent()},
+        {"region", leg.getRegion()},
+        {"type", leg.getMapObjectTypeName()},
+        {"lon", static_cast<double>(pos.getLonX())},
+        {"lat", static_cast<double>(pos.getLatY())},
+        {"distanceNm", static_cast<double>(leg.getDistanceTo())},
+        {"courseDegMag", static_cast<double>(leg.getCourseToMag())}
+      }));
+    }
+    json.insert("legs", legs);
+  }
+  apiCache->update(web::API_ROUTE, json);
+}
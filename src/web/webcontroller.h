@@ -19,8 +19,11 @@
 #define LNM_WEBCONTROLLER_H
 
 #include "io/inireader.h"
+#include "fs/sc/simconnectdata.h"
 
+#include <QElapsedTimer>
 #include <QObject>
+#include <QTimer>
 #include <QUrl>
 #include <QVector>
 
@@ -31,6 +34,7 @@ class HttpListener;
 class RequestHandler;
 class WebMapController;
 class HtmlInfoBuilder;
+class WebApiCache;
 class QSettings;
 
 /*
@@ -101,11 +105,30 @@ public:
     encrypted = value;
   }
 
+  /* Update the aircraft, progress and flight plan JSON API documents. Rate limited.
+   * Documents are built only once per update and shared between all web clients. */
+  void simDataChanged(const atools::fs::sc::SimConnectData& simConnectData);
+
+  /* Update flight plan JSON API document */
+  void routeChanged();
+
+  /* Clear aircraft and progress documents */
+  void disconnectedFromSimulator();
+
 signals:
   /* Send after server is started or before server is shutdown */
   void webserverStatusChanged(bool running);
 
 private:
+  /* Minimum time between JSON API updates from simulator data */
+  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 500;
+
+  void updateApiAircraftAndProgress(const atools::fs::sc::SimConnectData& simConnectData);
+  void updateApiRoute();
+
+  /* Send the last received simulator data */
+  void simUpdateTimeout();
+
   stefanfrings::HttpListener *listener = nullptr;
 
   /* Map painter */
@@ -114,9 +137,20 @@ private:
   /* Handles all HTTP requests using templates or static */
   RequestHandler *requestHandler = nullptr;
 
-  /* Used to build airport and other HTML information texts. */
+  /* Used to build HTML texts for the JSON API documents in the main thread.
+   * Request handler threads use their own instances. */
   HtmlInfoBuilder *htmlInfoBuilder = nullptr;
 
+  /* Serialized JSON documents for the API shared by all request handler threads */
+  WebApiCache *apiCache = nullptr;
+  int lastActiveLegIndex = -1;
+
+  /* Rate limit for simulator updates. The timer sends the last data received in the rate limit interval
+   * to avoid dropping the final update. */
+  QElapsedTimer lastSimUpdate;
+  QTimer simUpdateTimer;
+  atools::fs::sc::SimConnectData pendingSimData;
+
   /* Configuration file and file name. Default is :/littlenavmap/resources/config/webserver.cfg */
   atools::io::IniKeyValues listenerSettings;
   QString configFileName;
@@ -18,6 +18,8 @@
 #ifndef LNM_WEBFLAGS_H
 #define LNM_WEBFLAGS_H
 
+#include <QtGlobal>
+
 namespace web {
 /* Used to identify search object for WebMapController::getPixmapObject() */
 enum ObjectType
@@ -27,6 +29,19 @@ enum ObjectType
   AIRPORT
 };
 
+/* Documents served by the JSON API. Value is used as index in WebApiCache. */
+enum ApiDocument
+{
+  API_AIRCRAFT,
+  API_PROGRESS,
+  API_ROUTE,
+  API_NUM_DOCUMENTS
+};
+
+/* Value for the refresh drop down boxes which makes the pages use the server-sent event stream
+ * instead of periodical reloads. Has to match LIVE_REFRESH in scripts.js. */
+static Q_DECL_CONSTEXPR int REFRESH_LIVE = -2;
+
 }
 
 #endif // LNM_WEBFLAGS_H
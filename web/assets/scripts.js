@@ -23,17 +23,74 @@ function reloadPage() {
   xhttp.send();
 }
 
+/*
+ * Value of the refresh select box for live updates. Has to match web::REFRESH_LIVE in the server.
+ */
+var LIVE_REFRESH = -2;
+
+/*
+ * Server-sent event source for live updates and last received document for merging deltas.
+ */
+var eventSource = null;
+var liveDocument = {};
+
+/*
+ * Replace the content of id="doc" with the HTML of the received JSON document.
+ * The server sends no or a null HTML field after disconnecting from the simulator.
+ */
+function updateLiveDocument() {
+  if (liveDocument.html !== undefined && liveDocument.html !== null) {
+    document.getElementById("doc").innerHTML = "<p>" + liveDocument.html + "</p>";
+  } else {
+    document.getElementById("doc").innerHTML = "<p><b>Not connected to simulator.</b></p>";
+  }
+}
+
+/*
+ * Subscribe to the server-sent event stream for "apiDocument" and update the page on each push.
+ * The server sends the full document first and only changed fields afterwards.
+ */
+function startLiveUpdates() {
+  stopLiveUpdates();
+
+  eventSource = new EventSource("/api/events?documents=" + apiDocument);
+
+  eventSource.addEventListener(apiDocument, function(event) {
+    liveDocument = JSON.parse(event.data);
+    updateLiveDocument();
+  });
+
+  eventSource.addEventListener(apiDocument + "delta", function(event) {
+    var delta = JSON.parse(event.data);
+    for (var key in delta) {
+      liveDocument[key] = delta[key];
+    }
+    updateLiveDocument();
+  });
+}
+
+function stopLiveUpdates() {
+  if (eventSource !== null) {
+    eventSource.close();
+    eventSource = null;
+  }
+}
+
 /*
  * Refresh a page periodically and udpate the interval in the server session by sending a request
  * with "refreshkey=refreshvalue".
  */
 function refreshPage() {
-  reloadPage();
-
   var refreshvalue = document.getElementById('refreshselect').value;
+
+  if (refreshvalue != LIVE_REFRESH) {
+    reloadPage();
+  }
+
   if (refreshvalue != currentInterval) {
     // Value has changed - stop udpates
     clearInterval(timeoutHandle);
+    stopLiveUpdates();
 
     if (currentInterval != -1) {
       // Not the first load - update session on server
@@ -44,7 +101,16 @@ function refreshPage() {
 
     currentInterval = refreshvalue;
 
-    if (currentInterval > 0) {
+    if (currentInterval == LIVE_REFRESH) {
+      if (typeof(EventSource) !== "undefined" && typeof(apiDocument) !== "undefined") {
+        // Server pushes changes
+        startLiveUpdates();
+      } else {
+        // Fall back to polling if not supported by browser
+        reloadPage();
+        timeoutHandle = setInterval(reloadPage, 1000);
+      }
+    } else if (currentInterval > 0) {
       // Set interval timer if no manual refresh is desired
       timeoutHandle = setInterval(reloadPage, currentInterval * 1000);
     }